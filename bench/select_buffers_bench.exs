@@ -0,0 +1,130 @@
+# SELECT Receive-Path Allocation Benchmark
+#
+# Counts C/C++ heap allocator calls (malloc, calloc, realloc; operator new
+# goes through malloc) made by the VM process per MB of SELECT payload, once
+# the per-thread term buffer pools have warmed up. The count is taken from
+# outside the VM with a bpftrace uprobe on libc, so it covers every buffer
+# on the receive path: clickhouse-cpp's socket and decompression buffers and
+# column storage as well as Natch's pooled term buffers.
+#
+# Usage (bpftrace attaches to this VM, so run as root):
+#   sudo mix run bench/select_buffers_bench.exs
+#
+# Requires ClickHouse running:
+#   docker-compose up -d
+
+Code.require_file("helpers.ex", __DIR__)
+
+alias Bench.Helpers
+
+defmodule SelectBuffersBench do
+  @moduledoc """
+  Measures heap allocator calls per MB of SELECT payload.
+  """
+
+  @rows 1_000_000
+  @iterations 20
+  # UInt64 + Int64 + Float64 columns, 8 bytes each
+  @row_bytes 24
+
+  def run do
+    IO.puts("\n=== SELECT Allocation Benchmark ===\n")
+
+    bpftrace =
+      System.find_executable("bpftrace") ||
+        raise "bpftrace not found; it counts allocator calls from outside the VM"
+
+    {:ok, conn} = Natch.start_link(host: "localhost", port: 9000, database: "default")
+    table = Helpers.unique_table_name("natch_select_buffers")
+
+    Natch.execute(conn, """
+    CREATE TABLE #{table} (id UInt64, delta Int64, value Float64) ENGINE = Memory
+    """)
+
+    Natch.execute(conn, """
+    INSERT INTO #{table} SELECT number, toInt64(number) - 500000, number / 3 FROM numbers(#{@rows})
+    """)
+
+    payload_mb = @rows * @row_bytes / 1_048_576
+
+    for {label, select} <- [
+          {"columnar", &Natch.select_cols/2},
+          {"row-major", &Natch.select_rows/2}
+        ] do
+      # Warm the pools, then measure steady state
+      {:ok, _} = select.(conn, "SELECT * FROM #{table}")
+
+      {{micros, _}, %{calls: calls, bytes: bytes}} =
+        count_allocations(bpftrace, fn ->
+          :timer.tc(fn ->
+            for _ <- 1..@iterations do
+              {:ok, _} = select.(conn, "SELECT * FROM #{table}")
+            end
+          end)
+        end)
+
+      total_mb = payload_mb * @iterations
+
+      IO.puts("#{label}:")
+      IO.puts("  payload:             #{Float.round(total_mb, 1)} MB")
+      IO.puts("  allocator calls:     #{calls} (#{Float.round(calls / total_mb, 1)} per MB)")
+      IO.puts("  bytes allocated:     #{Float.round(bytes / total_mb / 1_048_576, 2)} MB per MB")
+      IO.puts("  throughput:          #{Float.round(total_mb / (micros / 1_000_000), 1)} MB/s\n")
+    end
+
+    Natch.execute(conn, Helpers.drop_test_table(table))
+    GenServer.stop(conn)
+  end
+
+  # Run `fun` while bpftrace counts this OS process's allocator calls
+  defp count_allocations(bpftrace, fun) do
+    pid = :os.getpid()
+
+    script = """
+    uprobe:libc:malloc /pid == #{pid}/ { @calls = count(); @bytes = sum(arg0); }
+    uprobe:libc:calloc /pid == #{pid}/ { @calls = count(); @bytes = sum(arg0 * arg1); }
+    uprobe:libc:realloc /pid == #{pid}/ { @calls = count(); @bytes = sum(arg1); }
+    """
+
+    port =
+      Port.open({:spawn_executable, bpftrace}, [
+        :binary,
+        :exit_status,
+        :stderr_to_stdout,
+        args: ["-e", script]
+      ])
+
+    await_output(port, "Attaching")
+    result = fun.()
+    {:os_pid, os_pid} = Port.info(port, :os_pid)
+    System.cmd("kill", ["-INT", Integer.to_string(os_pid)])
+
+    output = collect_output(port, "")
+    {result, %{calls: map_value(output, "calls"), bytes: map_value(output, "bytes")}}
+  end
+
+  defp await_output(port, marker) do
+    receive do
+      {^port, {:data, data}} -> if data =~ marker, do: :ok, else: await_output(port, marker)
+      {^port, {:exit_status, status}} -> raise "bpftrace exited with status #{status}"
+    after
+      30_000 -> raise "bpftrace did not attach"
+    end
+  end
+
+  defp collect_output(port, acc) do
+    receive do
+      {^port, {:data, data}} -> collect_output(port, acc <> data)
+      {^port, {:exit_status, _}} -> acc
+    end
+  end
+
+  defp map_value(output, name) do
+    case Regex.run(~r/@#{name}: (\d+)/, output) do
+      [_, value] -> String.to_integer(value)
+      nil -> 0
+    end
+  end
+end
+
+SelectBuffersBench.run()
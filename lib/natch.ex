@@ -43,6 +43,11 @@ defmodule Natch do
   - `:user` - Username (default: "default")
   - `:password` - Password (default: "")
   - `:compression` - Enable LZ4 compression (default: true)
+  - `:circuit_breaker` - Per-endpoint circuit breaker: `true`, `false`, or
+    options for `Natch.CircuitBreaker` (default: true). While the circuit
+    of `{host, port}` is open, calls return `{:error, :circuit_open}`
+    right away and starting a connection raises `Natch.ConnectionError`
+    with reason `:circuit_open`.
   - `:name` - Process name for registration (optional)
 
   ## Supported Types
@@ -139,6 +144,11 @@ defmodule Natch do
   - `:user` - Username (default: "default")
   - `:password` - Password (default: "")
   - `:compression` - Enable LZ4 compression (default: true)
+  - `:circuit_breaker` - Per-endpoint circuit breaker: `true`, `false`, or
+    options for `Natch.CircuitBreaker` (default: true). While the circuit
+    of `{host, port}` is open, calls return `{:error, :circuit_open}`
+    right away and starting a connection raises `Natch.ConnectionError`
+    with reason `:circuit_open`.
   - `:name` - Process name for registration (optional)
 
   ## Examples
@@ -232,9 +242,50 @@ defmodule Natch do
       |> Natch.Query.bind(:id, 42)
       |> Natch.Query.bind(:status, "active", :string)
       {:ok, rows} = Natch.select_rows(conn, query)
+
+      # Decode options go after the params (or after a Query)
+      {:ok, rows} = Natch.select_rows(conn, "SELECT path FROM hits", [], intern_strings: true)
+
+  ## Options
+
+    * `:intern_strings` - Decode repeated `String` values within a block to a
+      single shared binary. Saves allocations and heap for repetitive columns
+      that aren't LowCardinality (default: `false`)
+    * `:intern_threshold` - Share of distinct values, measured over the first
+      1024 rows of a block, above which interning is abandoned for that block
+      and strings decode normally (default: `0.5`)
+    * `:decode_stats` - Also return this query's decode cost per ClickHouse
+      type, as `{:ok, rows, %{decode_stats: stats}}`. `stats` maps type names
+      (`"Map"`, `"UUID"`, ...) to `%{values: n, nanoseconds: n, binary_bytes: n}`.
+      Time and bytes are exclusive of nested types, so an `Array(UUID)` column
+      reports the array slicing under `"Array"` and the formatting under
+      `"UUID"` (default: `false`)
+    * `:filter` - Predicates evaluated natively on each block before any
+      terms are built, so rows that fail them are never decoded. All
+      predicates must hold (AND). Each is one of `{column, op, value}` with
+      `op` in `:==`, `:!=`, `:<`, `:<=`, `:>`, `:>=`; `{column, :in, values}`;
+      `{column, :not_in, values}`; `{column, :is_nil}`; `{column, :not_nil}`.
+      Works on numeric, `String`, `Enum`, `Date`, `DateTime`,
+      `LowCardinality(String)` and `Nullable` result columns; as in SQL,
+      NULL only matches `:is_nil`. A `WHERE` clause is still cheaper when
+      the server can apply it (default: `[]`)
+    * `:sample` - Return a sample of the result, chosen natively as blocks
+      stream past so that only sampled rows are decoded. `{:every, n}`
+      keeps every nth row; `{:reservoir, k}` keeps a uniform random sample
+      of `k` rows, in result order, holding at most `k` rows in memory
+      whatever the result size. `{:reservoir, k, seed}` makes the sample
+      repeatable for the same result order. Applies after `:filter`
+      (default: none)
+
+  Queries that don't ask for `:decode_stats` are not measured. The counts of
+  those that do also add up in `decode_stats/0`.
   """
   @spec select_rows(conn(), String.t() | Natch.Query.t()) :: {:ok, [row()]} | {:error, term()}
   @spec select_rows(conn(), String.t(), keyword() | map()) :: {:ok, [row()]} | {:error, term()}
+  @spec select_rows(conn(), Natch.Query.t(), keyword()) ::
+          {:ok, [row()]} | {:ok, [row()], map()} | {:error, term()}
+  @spec select_rows(conn(), String.t(), keyword() | map(), keyword()) ::
+          {:ok, [row()]} | {:ok, [row()], map()} | {:error, term()}
   def select_rows(conn, %Natch.Query{} = query) do
     Connection.select_rows_parameterized(conn, query)
   end
@@ -243,18 +294,20 @@ defmodule Natch do
     Connection.select_rows(conn, sql)
   end
 
-  def select_rows(conn, sql, params) when is_binary(sql) and is_list(params) do
-    # Infer types for untyped placeholders like {id}
-    sql_with_types = add_parameter_types(sql, params)
-    query = Natch.Query.new(sql_with_types) |> Natch.Query.bind_all(params)
-    select_rows(conn, query)
+  def select_rows(conn, %Natch.Query{} = query, opts) when is_list(opts) do
+    Connection.select_rows_parameterized(conn, query, opts)
   end
 
-  def select_rows(conn, sql, params) when is_binary(sql) and is_map(params) do
+  def select_rows(conn, sql, params) when is_binary(sql) do
+    select_rows(conn, sql, params, [])
+  end
+
+  def select_rows(conn, sql, params, opts)
+      when is_binary(sql) and (is_list(params) or is_map(params)) and is_list(opts) do
     # Infer types for untyped placeholders like {id}
     sql_with_types = add_parameter_types(sql, params)
     query = Natch.Query.new(sql_with_types) |> Natch.Query.bind_all(params)
-    select_rows(conn, query)
+    select_rows(conn, query, opts)
   end
 
   @doc """
@@ -328,9 +381,15 @@ defmodule Natch do
         uid: 42
       )
       total = Enum.sum(revenues)
+
+  Accepts the same options as `select_rows/4`.
   """
   @spec select_cols(conn(), String.t() | Natch.Query.t()) :: {:ok, map()} | {:error, term()}
   @spec select_cols(conn(), String.t(), keyword() | map()) :: {:ok, map()} | {:error, term()}
+  @spec select_cols(conn(), Natch.Query.t(), keyword()) ::
+          {:ok, map()} | {:ok, map(), map()} | {:error, term()}
+  @spec select_cols(conn(), String.t(), keyword() | map(), keyword()) ::
+          {:ok, map()} | {:ok, map(), map()} | {:error, term()}
   def select_cols(conn, %Natch.Query{} = query) do
     Connection.select_cols_parameterized(conn, query)
   end
@@ -339,18 +398,20 @@ defmodule Natch do
     Connection.select_cols(conn, sql)
   end
 
-  def select_cols(conn, sql, params) when is_binary(sql) and is_list(params) do
-    # Infer types for untyped placeholders like {id}
-    sql_with_types = add_parameter_types(sql, params)
-    query = Natch.Query.new(sql_with_types) |> Natch.Query.bind_all(params)
-    select_cols(conn, query)
+  def select_cols(conn, %Natch.Query{} = query, opts) when is_list(opts) do
+    Connection.select_cols_parameterized(conn, query, opts)
+  end
+
+  def select_cols(conn, sql, params) when is_binary(sql) do
+    select_cols(conn, sql, params, [])
   end
 
-  def select_cols(conn, sql, params) when is_binary(sql) and is_map(params) do
+  def select_cols(conn, sql, params, opts)
+      when is_binary(sql) and (is_list(params) or is_map(params)) and is_list(opts) do
     # Infer types for untyped placeholders like {id}
     sql_with_types = add_parameter_types(sql, params)
     query = Natch.Query.new(sql_with_types) |> Natch.Query.bind_all(params)
-    select_cols(conn, query)
+    select_cols(conn, query, opts)
   end
 
   @doc """
@@ -375,6 +436,95 @@ defmodule Natch do
     end
   end
 
+  @doc """
+  Decodes ClickHouse Native-format data (one or more blocks, e.g. the body of
+  a `FORMAT Native` HTTP response) into a list of row maps, without a
+  connection. Values decode exactly as `select_rows/2` returns them.
+
+  Plain columns (numbers, strings, dates, UUIDs and Nullable/Array of those)
+  are read straight from the bytes; other types go through clickhouse-cpp.
+  Raises if the data is truncated or malformed.
+
+  ## Examples
+
+      Natch.decode_native_rows(body)
+      # => [%{id: 1, name: "Alice"}, %{id: 2, name: "Bob"}]
+  """
+  @spec decode_native_rows(binary()) :: [map()]
+  def decode_native_rows(data) when is_binary(data) do
+    Natch.Native.native_decode(data, false)
+  end
+
+  @doc """
+  Decodes ClickHouse Native-format data into columnar format, like
+  `select_cols/2`. See `decode_native_rows/1`.
+
+  ## Examples
+
+      Natch.decode_native_cols(body)
+      # => %{id: [1, 2], name: ["Alice", "Bob"]}
+  """
+  @spec decode_native_cols(binary()) :: map()
+  def decode_native_cols(data) when is_binary(data) do
+    Natch.Native.native_decode(data, true)
+  end
+
+  @doc """
+  Returns cumulative SELECT decode cost per ClickHouse type since load (or
+  the last `reset_decode_stats/0`), across all connections. Only queries
+  run with `decode_stats: true` are counted.
+
+  Keys are type names; time and binary bytes are exclusive of nested types.
+
+  ## Examples
+
+      Natch.decode_stats()
+      # => %{"Map" => %{values: 1000, nanoseconds: 2_400_000, binary_bytes: 0},
+      #      "String" => %{values: 20000, nanoseconds: 9_100_000, binary_bytes: 640_000}}
+  """
+  @spec decode_stats() :: %{String.t() => map()}
+  def decode_stats do
+    Natch.Native.select_decode_stats()
+  end
+
+  @doc """
+  Resets the counters reported by `decode_stats/0`.
+  """
+  @spec reset_decode_stats() :: :ok
+  def reset_decode_stats do
+    Natch.Native.select_decode_stats_reset()
+  end
+
+  @doc """
+  Returns the instruction set the native filter kernels use, and the widest
+  one this CPU supports.
+
+  Levels are `:scalar`, `:sse4_2`, `:avx2` and `:avx512`. The widest
+  supported level is picked when the NIF loads; setting `NATCH_CPU_LEVEL`
+  (e.g. `NATCH_CPU_LEVEL=avx2`) in the environment lowers it.
+
+  ## Examples
+
+      Natch.cpu_level()
+      # => %{level: :avx2, detected: :avx2}
+  """
+  @spec cpu_level() :: %{level: atom(), detected: atom()}
+  def cpu_level do
+    Natch.Native.cpu_level()
+  end
+
+  @doc """
+  Switches the native kernels to `level` for every connection, from their
+  next call on. Meant for tests and benchmarks; results are the same at
+  every level.
+
+  Raises `ArgumentError` for a level above the `:detected` one.
+  """
+  @spec put_cpu_level(:scalar | :sse4_2 | :avx2 | :avx512) :: :ok
+  def put_cpu_level(level) when level in [:scalar, :sse4_2, :avx2, :avx512] do
+    Natch.Native.cpu_level_set(Atom.to_string(level))
+  end
+
   @doc """
   Executes a DDL or DML statement without returning results.
 
@@ -473,7 +623,7 @@ defmodule Natch do
 
   Convenience wrapper that converts rows to columnar format before inserting.
 
-  **Performance Note:** For bulk operations (1000+ rows), prefer `insert_cols/4`
+  **Performance Note:** For bulk operations (1000+ rows), prefer `insert_cols/5`
   which avoids the O(N*M) conversion overhead. The conversion from rows to columns
   requires touching every value, making it less efficient for large datasets.
 
@@ -494,10 +644,10 @@ defmodule Natch do
       ]
       :ok = Natch.insert_rows(conn, "users", rows, schema)
   """
-  @spec insert_rows(conn(), String.t(), [map()], schema()) :: :ok | {:error, term()}
-  def insert_rows(conn, table, rows, schema) when is_list(rows) and is_list(schema) do
+  @spec insert_rows(conn(), String.t(), [map()], schema(), keyword()) :: :ok | {:error, term()}
+  def insert_rows(conn, table, rows, schema, opts \\ []) when is_list(rows) and is_list(schema) do
     columns = Natch.Conversion.rows_to_columns(rows, schema)
-    insert_cols(conn, table, columns, schema)
+    insert_cols(conn, table, columns, schema, opts)
   end
 
   @doc """
@@ -509,9 +659,9 @@ defmodule Natch do
       schema = [id: :uint64, name: :string]
       Natch.insert_rows!(conn, "users", rows, schema)
   """
-  @spec insert_rows!(conn(), String.t(), [map()], schema()) :: :ok
-  def insert_rows!(conn, table, rows, schema) do
-    case insert_rows(conn, table, rows, schema) do
+  @spec insert_rows!(conn(), String.t(), [map()], schema(), keyword()) :: :ok
+  def insert_rows!(conn, table, rows, schema, opts \\ []) do
+    case insert_rows(conn, table, rows, schema, opts) do
       :ok -> :ok
       {:error, reason} -> raise "Insert failed: #{inspect(reason)}"
     end
@@ -571,10 +721,213 @@ defmodule Natch do
         created_at: :datetime
       ]
       :ok = Natch.insert_cols(conn, "events", columns, schema)
+
+      # Skip rows whose key was inserted recently (see Natch.Dedup)
+      dedup = Natch.Dedup.new(keys: [:id])
+      :ok = Natch.insert_cols(conn, "users", columns, schema, dedup: dedup)
+
+  ## Options
+
+    * `:dedup` - A `Natch.Dedup` filter. Rows whose key it has seen within
+      its window are dropped before the block is built; when none are left
+      nothing is sent. The filter remembers the keys once the server
+      acknowledged the INSERT, so a failed insert can be retried as is.
+  """
+  @spec insert_cols(conn(), String.t(), map(), schema(), keyword()) :: :ok | {:error, term()}
+  def insert_cols(conn, table, columns, schema, opts \\ [])
+      when is_map(columns) and is_list(schema) do
+    case dedup_columns(columns, opts) do
+      {_columns, 0, _pending} ->
+        :ok
+
+      {columns, _kept, pending} ->
+        with :ok <- GenServer.call(conn, {:insert, table, columns, schema}, :infinity) do
+          dedup_commit(pending, opts)
+        end
+    end
+  end
+
+  # {columns, kept_rows, pending}; pass pending to dedup_commit/2 once the
+  # server acknowledged the rows. Keys in `in_flight`, the pending of an
+  # insert not yet acknowledged, count as seen. Without a filter the row
+  # count doesn't matter.
+  defp dedup_columns(columns, opts, in_flight \\ <<>>) do
+    case Keyword.validate!(opts, dedup: nil)[:dedup] do
+      nil -> {columns, nil, nil}
+      dedup -> Natch.Dedup.check(dedup, columns, in_flight)
+    end
+  end
+
+  defp dedup_commit(nil, _opts), do: :ok
+  defp dedup_commit(pending, opts), do: Natch.Dedup.commit(opts[:dedup], pending)
+
+  @doc """
+  Inserts a stream of columnar chunks, overlapping block building with I/O.
+
+  Each chunk is a map of column lists, as accepted by `insert_cols/5`, and is
+  sent as its own INSERT. The block for the next chunk is built in the calling
+  process while the connection compresses and sends the previous one on a
+  dirty I/O scheduler, so encoding, LZ4 and the socket write run concurrently.
+
+  Returns `:ok` once every chunk has been acknowledged. On the first error the
+  remaining chunks are not sent and the error is returned; chunks already
+  acknowledged stay inserted.
+
+  Takes the same options as `insert_cols/5`; with `:dedup`, chunks left
+  empty by the filter are skipped.
+
+  ## Examples
+
+      chunks =
+        1..1_000_000
+        |> Stream.chunk_every(100_000)
+        |> Stream.map(fn ids -> %{id: ids, value: Enum.map(ids, &(&1 * 2))} end)
+
+      :ok = Natch.insert_stream(conn, "bulk_table", chunks, id: :uint64, value: :uint64)
+  """
+  @spec insert_stream(conn(), String.t(), Enumerable.t(), schema(), keyword()) ::
+          :ok | {:error, term()}
+  def insert_stream(conn, table, chunks, schema, opts \\ []) when is_list(schema) do
+    result =
+      Enum.reduce_while(chunks, {:in_flight, nil}, fn columns, {:in_flight, request} ->
+        # Build the next block before waiting on the one in flight
+        built = build_insert_block(columns, schema, opts, request)
+
+        case {await_insert(request, opts), built} do
+          {:ok, :empty} ->
+            {:cont, {:in_flight, nil}}
+
+          {:ok, {:ok, block, pending}} ->
+            request = :gen_server.send_request(conn, {:insert_block, table, block})
+            {:cont, {:in_flight, {request, pending}}}
+
+          {:ok, build_error} ->
+            {:halt, {:done, build_error}}
+
+          {insert_error, _} ->
+            {:halt, {:done, insert_error}}
+        end
+      end)
+
+    case result do
+      {:in_flight, request} -> await_insert(request, opts)
+      {:done, error} -> error
+    end
+  end
+
+  # The chunk in flight isn't acknowledged yet, so its keys count as seen
+  defp build_insert_block(columns, schema, opts, in_flight) when is_map(columns) do
+    in_flight_keys =
+      case in_flight do
+        {_request, pending} when is_binary(pending) -> pending
+        _ -> <<>>
+      end
+
+    case dedup_columns(columns, opts, in_flight_keys) do
+      {_columns, 0, _pending} -> :empty
+      {columns, _kept, pending} -> {:ok, Natch.Block.build_block(columns, schema), pending}
+    end
+  rescue
+    e -> Natch.Error.handle_callback_error(e)
+  end
+
+  defp await_insert(nil, _opts), do: :ok
+
+  defp await_insert({request, pending}, opts) do
+    case :gen_server.wait_response(request, :infinity) do
+      {:reply, :ok} -> dedup_commit(pending, opts)
+      {:reply, reply} -> reply
+      {:error, {reason, server}} -> exit({reason, {__MODULE__, :insert_stream, [server]}})
+    end
+  end
+
+  @doc """
+  Executes a SELECT query and returns each result block as a binary in
+  ClickHouse's Native format, without decoding any values.
+
+  The binaries can be cached, sent to other nodes, inserted elsewhere with
+  `insert_native/3`, or decoded later with `decode_native_rows/1` and
+  `decode_native_cols/1`. Concatenated, they are a valid `FORMAT Native`
+  stream.
+
+  An empty result is returned as one block with no rows, so the column
+  names and types are still there.
+
+  ## Options
+
+    * `:cancel_token` - as for `select_rows/3`
+
+  ## Examples
+
+      {:ok, blocks} = Natch.select_native(conn, "SELECT * FROM events")
+      :ok = Natch.insert_native(other_conn, "events", blocks)
+  """
+  @spec select_native(conn(), String.t() | Natch.Query.t(), keyword()) ::
+          {:ok, [binary()]} | {:error, term()}
+  def select_native(conn, query_or_sql, opts \\ []) do
+    Connection.select_native(conn, query_or_sql, opts)
+  end
+
+  @doc """
+  Inserts Native-format blocks, such as those from `select_native/3` or
+  `Natch.Block.encode_native/2`, without building Elixir terms.
+
+  Each block is sent as its own INSERT; column names and types come from
+  the block.
+  """
+  @spec insert_native(conn(), String.t(), [binary()]) :: :ok | {:error, term()}
+  def insert_native(conn, table, blocks) when is_binary(table) and is_list(blocks) do
+    Connection.insert_native(conn, table, blocks)
+  end
+
+  @doc """
+  Copies the result of a SELECT on `src` into `table` on `dst`.
+
+  Blocks go from the source straight into inserts on the destination without
+  becoming Elixir terms. Reading and inserting overlap on native threads,
+  with at most `:max_queued_blocks` blocks waiting between them. A slow
+  destination throttles the source.
+
+  The copy is not one streaming INSERT: source blocks are merged into
+  INSERTs of at least `:min_insert_rows` rows each (the last may be
+  smaller), so a large copy makes one part per INSERT on a MergeTree table
+  rather than one per source block. A failed copy leaves the INSERTs that
+  completed before the failure in `table`; rows still being gathered are
+  not inserted.
+
+  Returns the rows copied, the source blocks they came in and the INSERTs
+  made.
+
+  `src` and `dst` must be different connections. The copy runs in the
+  calling process with both connections checked out, so both are busy until
+  it finishes. Copies in opposite directions between the same two
+  connections may run at once; one waits for the other. An error is charged
+  to the circuit breaker of the side that raised it.
+
+  ## Options
+
+    * `:rename` - `[{source_column, destination_column}]` (keyword or map)
+    * `:cast` - `[{destination_column, type}]` converting numeric columns,
+      or Nullable of them, to another numeric type. `type` is a ClickHouse
+      type name (`"UInt64"`) or a schema type (`:uint64`). Values the target
+      type cannot hold abort the copy.
+    * `:max_queued_blocks` - blocks buffered between the two sides (default: 4)
+    * `:min_insert_rows` - rows gathered into each INSERT
+      (default: 1_048_576, ClickHouse's `min_insert_block_size_rows`)
+
+  ## Examples
+
+      {:ok, %{rows: rows, blocks: blocks, inserts: inserts}} =
+        Natch.copy(src, "SELECT id, total FROM events_daily", dst, "events_rollup",
+          rename: [total: :amount],
+          cast: [amount: :float64]
+        )
   """
-  @spec insert_cols(conn(), String.t(), map(), schema()) :: :ok | {:error, term()}
-  def insert_cols(conn, table, columns, schema) when is_map(columns) and is_list(schema) do
-    GenServer.call(conn, {:insert, table, columns, schema}, :infinity)
+  @spec copy(conn(), String.t(), conn(), String.t(), keyword()) ::
+          {:ok, %{rows: non_neg_integer(), blocks: non_neg_integer(), inserts: non_neg_integer()}}
+          | {:error, term()}
+  def copy(src, sql, dst, table, opts \\ []) when is_binary(sql) and is_binary(table) do
+    Connection.copy(src, sql, dst, table, opts)
   end
 
   @doc """
@@ -586,9 +939,9 @@ defmodule Natch do
       schema = [id: :uint64, name: :string]
       Natch.insert_cols!(conn, "users", columns, schema)
   """
-  @spec insert_cols!(conn(), String.t(), map(), schema()) :: :ok
-  def insert_cols!(conn, table, columns, schema) do
-    case insert_cols(conn, table, columns, schema) do
+  @spec insert_cols!(conn(), String.t(), map(), schema(), keyword()) :: :ok
+  def insert_cols!(conn, table, columns, schema, opts \\ []) do
+    case insert_cols(conn, table, columns, schema, opts) do
       :ok -> :ok
       {:error, reason} -> raise "Insert failed: #{inspect(reason)}"
     end
@@ -7,9 +7,10 @@ defmodule Natch.Application do
 
   @impl true
   def start(_type, _args) do
+    Natch.Hedge.init()
+
     children = [
-      # Starts a worker by calling: Natch.Worker.start_link(arg)
-      # {Natch.Worker, arg}
+      Natch.CircuitBreaker
     ]
 
     # See https://hexdocs.pm/elixir/Supervisor.html
@@ -103,24 +103,122 @@ defmodule Natch.Block do
   @spec build_columns_bulk(map(), keyword()) :: keyword()
   def build_columns_bulk(columns, schema) when is_map(columns) and is_list(schema) do
     for {name, type} <- schema do
-      # Get column values - support both atom and string keys
-      values = Map.get(columns, name) || Map.get(columns, to_string(name))
-
-      cond do
-        values == nil ->
-          raise ArgumentError,
-                "Missing column #{inspect(name)} in columns #{inspect(Map.keys(columns))}"
-
-        not is_list(values) ->
-          raise ArgumentError,
-                "Column #{inspect(name)} must be a list, got: #{inspect(values)}"
-
-        true ->
-          # Create column and append values using appropriate method
-          column = Column.new(type)
-          append_column_values(column, type, values)
-          {name, column.ref}
+      values = column_values!(columns, name)
+
+      # Create column and append values using appropriate method
+      column = Column.new(type)
+      append_column_values(column, type, values)
+      {name, column.ref}
+    end
+  end
+
+  @doc """
+  Encodes columnar data as one block in ClickHouse's Native format.
+
+  Plain columns (integers, floats, strings, dates, UUIDs, decimals, and
+  Nullable/Array of those) are written straight from the Elixir values into
+  the output binary, without building columns first. Other types (Tuple,
+  Map, LowCardinality, Enum) are built with `Natch.Column` and serialized by
+  clickhouse-cpp. Either way the bytes are identical to serializing the block
+  from `build_block/2`.
+
+  Values are validated natively; invalid values raise `ArgumentError`.
+
+  ## Examples
+
+      schema = [id: :uint64, name: :string]
+      columns = %{id: [1, 2], name: ["Alice", "Bob"]}
+      data = Natch.Block.encode_native(columns, schema)
+      Natch.decode_native_cols(data)
+      # => %{id: [1, 2], name: ["Alice", "Bob"]}
+  """
+  @spec encode_native(map(), keyword()) :: binary()
+  def encode_native(columns, schema) when is_map(columns) and is_list(schema) do
+    encoded =
+      for {name, type} <- schema do
+        values = column_values!(columns, name)
+        clickhouse_type = Column.clickhouse_type(type)
+        {to_string(name), clickhouse_type, length(values), encode_column(name, type, values)}
+      end
+
+    rows =
+      case Enum.uniq_by(encoded, &elem(&1, 2)) do
+        [] -> 0
+        [{_, _, rows, _}] -> rows
+        _ -> raise ArgumentError, "All columns must have the same number of values"
+      end
+
+    body =
+      for {name, clickhouse_type, _rows, data} <- encoded do
+        [native_string(name), native_string(clickhouse_type), data]
       end
+
+    IO.iodata_to_binary([native_varint(length(schema)), native_varint(rows) | body])
+  end
+
+  # Types Native.column_encode_native writes directly
+  @native_encode_types [
+    :uint64,
+    :uint32,
+    :uint16,
+    :uint8,
+    :int64,
+    :int32,
+    :int16,
+    :int8,
+    :float64,
+    :float32,
+    :string,
+    :datetime,
+    :datetime64,
+    :date,
+    :bool,
+    :uuid,
+    :decimal,
+    :nullable_uint64,
+    :nullable_int64,
+    :nullable_string,
+    :nullable_float64
+  ]
+
+  defp native_encodable?(type) when type in @native_encode_types, do: true
+  defp native_encodable?({:nullable, inner_type}), do: native_encodable?(inner_type)
+  defp native_encodable?({:array, inner_type}), do: native_encodable?(inner_type)
+  defp native_encodable?(_type), do: false
+
+  defp encode_column(name, type, values) do
+    if native_encodable?(type) do
+      Native.column_encode_native(Column.clickhouse_type(type), values)
+    else
+      column = Column.new(type)
+      append_column_values(column, type, values)
+      Native.column_save_native(column.ref)
+    end
+  rescue
+    e in ArgumentError ->
+      reraise ArgumentError, "column #{name}: #{Exception.message(e)}", __STACKTRACE__
+  end
+
+  defp native_string(value), do: [native_varint(byte_size(value)), value]
+
+  defp native_varint(n) when n < 0x80, do: <<n>>
+  defp native_varint(n), do: <<1::1, n::7, native_varint(Bitwise.bsr(n, 7))::binary>>
+
+  # Get column values - support both atom and string keys
+  defp column_values!(columns, name) do
+    values = Map.get(columns, name) || Map.get(columns, to_string(name))
+
+    cond do
+      values == nil ->
+        raise ArgumentError,
+              "Missing column #{inspect(name)} in columns #{inspect(Map.keys(columns))}"
+
+      not is_list(values) ->
+        raise ArgumentError,
+              "Column #{inspect(name)} must be a list, got: #{inspect(values)}"
+
+      true ->
+        values
     end
   end
 
@@ -139,14 +237,6 @@ defmodule Natch.Block do
     end
   end
 
-  defp append_column_values(column, {:map, _key_type, _value_type}, values) do
-    # Convert list of maps to keys_arrays/values_arrays format
-    # Input: [%{"k1" => 1, "k2" => 2}, %{"k3" => 3}]
-    # Output: keys_arrays = [["k1", "k2"], ["k3"]], values_arrays = [[1, 2], [3]]
-    {keys_arrays, values_arrays} = transpose_maps(values)
-    Column.append_map_arrays(column, keys_arrays, values_arrays)
-  end
-
   defp append_column_values(column, _type, values) do
     # Standard append_bulk for all other types
     Column.append_bulk(column, values)
@@ -159,14 +249,4 @@ defmodule Natch.Block do
       Enum.map(tuples, fn tuple -> elem(tuple, i) end)
     end
   end
-
-  # Transpose list of maps into keys_arrays and values_arrays
-  # [%{"k1" => 1, "k2" => 2}, %{"k3" => 3}] -> {[["k1", "k2"], ["k3"]], [[1, 2], [3]]}
-  defp transpose_maps(maps) do
-    Enum.map(maps, fn map ->
-      # Convert each map to {keys, values} pair
-      {Map.keys(map), Map.values(map)}
-    end)
-    |> Enum.unzip()
-  end
 end
@@ -0,0 +1,326 @@
+defmodule Natch.CircuitBreaker do
+  @moduledoc """
+  Per-endpoint circuit breaker shared by all connections to the same
+  `{host, port}`.
+
+  While a replica is down every call to it would otherwise wait for the
+  full `:connect_timeout` (or `:recv_timeout`) before failing. The breaker
+  watches the connection-level error rate of each endpoint and, once it
+  trips, fails calls immediately with `{:error, :circuit_open}` until a
+  background probe can reach the endpoint again.
+
+  ## States
+
+    * `:closed` - calls go through. When at least `:min_calls` calls have
+      completed within `:window` milliseconds and the share of connection
+      failures reaches `:failure_threshold`, the circuit opens.
+    * `:open` - calls fail fast without touching the network. Every
+      `:open_timeout` milliseconds a background TCP connect probes the
+      endpoint; once it succeeds the circuit becomes half-open.
+    * `:half_open` - a single call goes through as a probe, others still
+      fail fast. Its success closes the circuit, a connection failure opens
+      it again. A probe that times out lets the next call probe.
+
+  Only connection failures count: server errors such as a syntax error
+  prove the endpoint is reachable and are recorded as successes. A call
+  that times out waiting for the server (`:recv_timeout`) counts neither
+  way, as a slow query says nothing about the endpoint.
+
+  Connections register their endpoint on start, see the `:circuit_breaker`
+  option of `Natch.start_link/1`.
+
+  ## Options
+
+    * `:failure_threshold` - Failure rate that opens the circuit
+      (default: `0.5`)
+    * `:min_calls` - Calls in the current window before the rate is
+      considered (default: `3`)
+    * `:window` - Length of the counting window in milliseconds
+      (default: `10_000`)
+    * `:open_timeout` - Milliseconds between probes while open
+      (default: `5_000`)
+    * `:probe_timeout` - Connect timeout of a probe in milliseconds
+      (default: `2_000`)
+  """
+
+  use GenServer
+
+  @table __MODULE__
+
+  # ETS row: {endpoint, state, calls, failures, window_started_ms, config, probes}
+  @state_pos 2
+  @calls_pos 3
+  @failures_pos 4
+  @window_pos 5
+  @config_pos 6
+  # Calls that asked to probe since the circuit became half-open
+  @probes_pos 7
+
+  @defaults [
+    failure_threshold: 0.5,
+    min_calls: 3,
+    window: 10_000,
+    open_timeout: 5_000,
+    probe_timeout: 2_000
+  ]
+
+  @type endpoint :: {String.t(), non_neg_integer()}
+  @type state :: :closed | :open | :half_open
+
+  @doc false
+  def start_link(opts) do
+    GenServer.start_link(__MODULE__, opts, name: __MODULE__)
+  end
+
+  @doc false
+  def child_spec(opts) do
+    %{id: __MODULE__, start: {__MODULE__, :start_link, [opts]}}
+  end
+
+  @doc """
+  Registers `endpoint` with the given options, replacing earlier options.
+
+  Counters and state of an already registered endpoint are kept.
+  """
+  @spec register(endpoint(), keyword()) :: :ok
+  def register(endpoint, opts \\ []) do
+    config = opts |> Keyword.validate!(@defaults) |> Map.new()
+
+    GenServer.call(__MODULE__, {:register, endpoint, config})
+  end
+
+  @doc """
+  Returns `:ok` if a call to `endpoint` may proceed, or
+  `{:error, :circuit_open}` while its circuit is open.
+
+  While half-open only the first caller gets `:ok`, and must `record/2`
+  the outcome. Works on shared state only, so an open circuit costs
+  microseconds.
+  """
+  @spec allow(endpoint() | nil) :: :ok | {:error, :circuit_open}
+  def allow(nil), do: :ok
+
+  def allow(endpoint) do
+    case :ets.lookup(@table, endpoint) do
+      [{_endpoint, :open, _calls, _failures, _window, _config, _probes}] ->
+        {:error, :circuit_open}
+
+      [{_endpoint, :half_open, _calls, _failures, _window, _config, _probes}] ->
+        if :ets.update_counter(@table, endpoint, {@probes_pos, 1}) == 1,
+          do: :ok,
+          else: {:error, :circuit_open}
+
+      _ ->
+        :ok
+    end
+  end
+
+  @doc """
+  Records the outcome of a call to `endpoint`.
+
+  `:timeout` marks a call the endpoint accepted but did not answer in
+  time. It leaves the counters alone and frees a half-open probe.
+  """
+  @spec record(endpoint() | nil, :success | :failure | :timeout) :: :ok
+  def record(nil, _outcome), do: :ok
+
+  def record(endpoint, :timeout), do: release(endpoint)
+
+  def record(endpoint, :success) do
+    # Successes only move counters unless they can close a half-open circuit
+    :ets.update_counter(@table, endpoint, {@calls_pos, 1}, default_row(endpoint))
+
+    if :ets.lookup_element(@table, endpoint, @state_pos) == :half_open do
+      GenServer.cast(__MODULE__, {:success, endpoint})
+    end
+
+    :ok
+  end
+
+  def record(endpoint, :failure) do
+    :ets.update_counter(
+      @table,
+      endpoint,
+      [{@calls_pos, 1}, {@failures_pos, 1}],
+      default_row(endpoint)
+    )
+
+    GenServer.cast(__MODULE__, {:failure, endpoint})
+  end
+
+  @doc """
+  Gives back the half-open probe `allow/1` granted to a call that was not
+  made after all, so the next call may probe.
+  """
+  @spec release(endpoint() | nil) :: :ok
+  def release(nil), do: :ok
+
+  def release(endpoint) do
+    case :ets.lookup(@table, endpoint) do
+      [{_endpoint, :half_open, _calls, _failures, _window, _config, _probes}] ->
+        :ets.update_element(@table, endpoint, {@probes_pos, 0})
+        :ok
+
+      _ ->
+        :ok
+    end
+  end
+
+  @doc """
+  Returns the circuit state of `endpoint`, or `nil` if it is not registered.
+  """
+  @spec status(endpoint()) :: state() | nil
+  def status(endpoint) do
+    case :ets.lookup(@table, endpoint) do
+      [{_endpoint, state, _calls, _failures, _window, _config, _probes}] -> state
+      [] -> nil
+    end
+  end
+
+  @doc """
+  Closes the circuit of `endpoint` and clears its counters.
+  """
+  @spec reset(endpoint()) :: :ok
+  def reset(endpoint) do
+    GenServer.call(__MODULE__, {:reset, endpoint})
+  end
+
+  # GenServer callbacks
+
+  @impl true
+  def init(_opts) do
+    :ets.new(@table, [:named_table, :public, :set, read_concurrency: true, write_concurrency: true])
+    # Endpoints with a probe scheduled or running
+    {:ok, %{probing: MapSet.new()}}
+  end
+
+  @impl true
+  def handle_call({:register, endpoint, config}, _from, state) do
+    unless :ets.update_element(@table, endpoint, {@config_pos, config}) do
+      :ets.insert(@table, {endpoint, :closed, 0, 0, now(), config, 0})
+    end
+
+    {:reply, :ok, state}
+  end
+
+  def handle_call({:reset, endpoint}, _from, state) do
+    if :ets.member(@table, endpoint), do: close(endpoint)
+    {:reply, :ok, state}
+  end
+
+  @impl true
+  def handle_cast({:success, endpoint}, state) do
+    if status(endpoint) == :half_open, do: close(endpoint)
+    {:noreply, state}
+  end
+
+  def handle_cast({:failure, endpoint}, state) do
+    [{^endpoint, circuit, calls, failures, window_started, config, _probes}] =
+      :ets.lookup(@table, endpoint)
+
+    now = now()
+
+    cond do
+      circuit == :open ->
+        # Calls admitted before the circuit opened
+        {:noreply, state}
+
+      circuit == :half_open ->
+        {:noreply, trip(endpoint, config, state)}
+
+      now - window_started > config.window ->
+        # Stale window: this failure starts a new one
+        :ets.update_element(@table, endpoint, [
+          {@calls_pos, 1},
+          {@failures_pos, 1},
+          {@window_pos, now}
+        ])
+
+        {:noreply, state}
+
+      calls >= config.min_calls and failures / calls >= config.failure_threshold ->
+        {:noreply, trip(endpoint, config, state)}
+
+      true ->
+        {:noreply, state}
+    end
+  end
+
+  @impl true
+  def handle_info({:probe, endpoint}, state) do
+    [{^endpoint, _circuit, _calls, _failures, _window, config, _probes}] =
+      :ets.lookup(@table, endpoint)
+
+    parent = self()
+
+    # Probe outside the GenServer so a slow connect never blocks it
+    spawn(fn -> send(parent, {:probe_result, endpoint, probe(endpoint, config)}) end)
+    {:noreply, state}
+  end
+
+  def handle_info({:probe_result, endpoint, result}, state) do
+    [{^endpoint, circuit, _calls, _failures, _window, config, _probes}] =
+      :ets.lookup(@table, endpoint)
+
+    case {circuit, result} do
+      {:open, :error} ->
+        Process.send_after(self(), {:probe, endpoint}, config.open_timeout)
+        {:noreply, state}
+
+      {:open, :ok} ->
+        :ets.update_element(@table, endpoint, [
+          {@state_pos, :half_open},
+          {@calls_pos, 0},
+          {@failures_pos, 0},
+          {@window_pos, now()},
+          {@probes_pos, 0}
+        ])
+
+        {:noreply, %{state | probing: MapSet.delete(state.probing, endpoint)}}
+
+      _reset_meanwhile ->
+        {:noreply, %{state | probing: MapSet.delete(state.probing, endpoint)}}
+    end
+  end
+
+  # Private functions
+
+  defp trip(endpoint, config, state) do
+    :ets.update_element(@table, endpoint, [{@state_pos, :open}, {@calls_pos, 0}, {@failures_pos, 0}])
+
+    if MapSet.member?(state.probing, endpoint) do
+      # A reset left the previous probe running; it picks this circuit up
+      state
+    else
+      Process.send_after(self(), {:probe, endpoint}, config.open_timeout)
+      %{state | probing: MapSet.put(state.probing, endpoint)}
+    end
+  end
+
+  defp close(endpoint) do
+    :ets.update_element(@table, endpoint, [
+      {@state_pos, :closed},
+      {@calls_pos, 0},
+      {@failures_pos, 0},
+      {@window_pos, now()}
+    ])
+  end
+
+  defp probe({host, port}, config) do
+    case :gen_tcp.connect(String.to_charlist(host), port, [active: false], config.probe_timeout) do
+      {:ok, socket} ->
+        :gen_tcp.close(socket)
+        :ok
+
+      {:error, _reason} ->
+        :error
+    end
+  end
+
+  # Row used when an endpoint records before it registered
+  defp default_row(endpoint) do
+    {endpoint, :closed, 0, 0, now(), Map.new(@defaults), 0}
+  end
+
+  defp now, do: System.monotonic_time(:millisecond)
+end
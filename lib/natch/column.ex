@@ -24,6 +24,7 @@ defmodule Natch.Column do
   - `:uint64` - UInt64
   - `:uint32` - UInt32
   - `:uint16` - UInt16
+  - `:uint8` - UInt8
   - `:int64` - Int64
   - `:int32` - Int32
   - `:int16` - Int16
@@ -37,9 +38,9 @@ defmodule Natch.Column do
   - `:string` - String
 
   **Dates/Times:**
-  - `:datetime` - DateTime (Unix timestamp in seconds)
-  - `:datetime64` - DateTime64(6) (Unix timestamp in microseconds)
-  - `:date` - Date (days since epoch)
+  - `:datetime` - DateTime (`DateTime`, `NaiveDateTime` or Unix timestamp in seconds)
+  - `:datetime64` - DateTime64(6) (`DateTime`, `NaiveDateTime` or Unix timestamp in microseconds)
+  - `:date` - Date (`Date` or days since epoch)
 
   **Boolean:**
   - `:bool` - Bool (stored as UInt8)
@@ -125,55 +126,22 @@ defmodule Natch.Column do
       raise ArgumentError, "All values must be numbers for Float64 column"
     end
 
-    # Convert integers to floats
-    float_values =
-      Enum.map(values, fn
-        val when is_float(val) -> val
-        val when is_integer(val) -> val * 1.0
-      end)
-
-    Native.column_float64_append_bulk(ref, float_values)
+    # Integers are converted to floats natively while filling the column
+    Native.column_float64_append_bulk(ref, values)
   end
 
+  # DateTime/NaiveDateTime structs are decoded natively (fields read with
+  # pre-interned atoms), so values are passed through without a conversion pass
   def append_bulk(%__MODULE__{type: :datetime, ref: ref}, values) when is_list(values) do
-    # Convert all to Unix timestamps
-    timestamps =
-      Enum.map(values, fn
-        %DateTime{} = dt -> DateTime.to_unix(dt)
-        timestamp when is_integer(timestamp) -> timestamp
-        other -> raise ArgumentError, "Invalid datetime value: #{inspect(other)}"
-      end)
-
-    Native.column_datetime_append_bulk(ref, timestamps)
+    Native.column_datetime_append_bulk(ref, values)
   end
 
   def append_bulk(%__MODULE__{type: :datetime64, ref: ref}, values) when is_list(values) do
-    # Convert all to Unix timestamps with microsecond precision
-    ticks =
-      Enum.map(values, fn
-        %DateTime{} = dt -> DateTime.to_unix(dt, :microsecond)
-        ticks when is_integer(ticks) -> ticks
-        other -> raise ArgumentError, "Invalid datetime64 value: #{inspect(other)}"
-      end)
-
-    Native.column_datetime64_append_bulk(ref, ticks)
+    Native.column_datetime64_append_bulk(ref, values)
   end
 
   def append_bulk(%__MODULE__{type: :date, ref: ref}, values) when is_list(values) do
-    # Convert all to days since epoch
-    days =
-      Enum.map(values, fn
-        %Date{} = date ->
-          Date.diff(date, ~D[1970-01-01])
-
-        days when is_integer(days) ->
-          days
-
-        other ->
-          raise ArgumentError, "Invalid date value: #{inspect(other)}"
-      end)
-
-    Native.column_date_append_bulk(ref, days)
+    Native.column_date_append_bulk(ref, values)
   end
 
   def append_bulk(%__MODULE__{type: :bool, ref: ref}, values) when is_list(values) do
@@ -208,6 +176,14 @@ defmodule Natch.Column do
     Native.column_uint16_append_bulk(ref, values)
   end
 
+  def append_bulk(%__MODULE__{type: :uint8, ref: ref}, values) when is_list(values) do
+    unless Enum.all?(values, &(is_integer(&1) and &1 >= 0 and &1 <= 255)) do
+      raise ArgumentError, "All values must be non-negative integers 0..255 for UInt8 column"
+    end
+
+    Native.column_uint8_append_bulk(ref, values)
+  end
+
   def append_bulk(%__MODULE__{type: :int32, ref: ref}, values) when is_list(values) do
     unless Enum.all?(values, &(is_integer(&1) and &1 >= -2_147_483_648 and &1 <= 2_147_483_647)) do
       raise ArgumentError,
@@ -238,14 +214,8 @@ defmodule Natch.Column do
       raise ArgumentError, "All values must be numbers for Float32 column"
     end
 
-    # Convert integers to floats
-    float_values =
-      Enum.map(values, fn
-        val when is_float(val) -> val
-        val when is_integer(val) -> val * 1.0
-      end)
-
-    Native.column_float32_append_bulk(ref, float_values)
+    # Integers are converted to floats natively while filling the column
+    Native.column_float32_append_bulk(ref, values)
   end
 
   def append_bulk(%__MODULE__{type: :uuid, ref: ref}, values) when is_list(values) do
@@ -270,33 +240,10 @@ defmodule Natch.Column do
     Native.column_uuid_append_bulk(ref, highs, lows)
   end
 
+  # Decimal64(9) - accepts %Decimal{} structs (scaled natively, exact or raise),
+  # already-scaled integers, and floats (truncated after scaling)
   def append_bulk(%__MODULE__{type: :decimal, ref: ref}, values) when is_list(values) do
-    # Convert Decimal structs to scaled int64 values
-    # Decimal64(9) means scale=9, so multiply by 10^9
-    scale = 9
-    multiplier = :math.pow(10, scale) |> trunc()
-
-    scaled_values =
-      Enum.map(values, fn
-        %Decimal{} = decimal ->
-          # Convert Decimal to float, multiply by 10^scale, convert to int64
-          decimal
-          |> Decimal.mult(Decimal.new(multiplier))
-          |> Decimal.to_integer()
-
-        value when is_integer(value) ->
-          # Already scaled integer
-          value
-
-        value when is_float(value) ->
-          # Scale the float value
-          trunc(value * multiplier)
-
-        other ->
-          raise ArgumentError, "Invalid decimal value: #{inspect(other)}"
-      end)
-
-    Native.column_decimal_append_bulk(ref, scaled_values)
+    Native.column_decimal_append_bulk(ref, values)
   end
 
   # Nullable type handlers
@@ -363,6 +310,34 @@ defmodule Natch.Column do
     append_array_generic(col, arrays)
   end
 
+  # Map type - accepts a list of Elixir maps
+  # Scalar keys/values are iterated natively straight into the column's
+  # Array(Tuple(K, V)) storage; other types go through the columnar API
+  def append_bulk(%__MODULE__{type: {:map, key_type, value_type}, ref: map_ref} = col, maps)
+      when is_list(maps) do
+    if native_map_type?(key_type) and native_map_type?(value_type) do
+      Native.column_map_append_bulk(map_ref, maps)
+    else
+      {keys_arrays, values_arrays} =
+        maps
+        |> Enum.map(fn map -> {Map.keys(map), Map.values(map)} end)
+        |> Enum.unzip()
+
+      append_map_arrays(col, keys_arrays, values_arrays)
+    end
+  end
+
+  # LowCardinality(String) - values go straight into the column's dictionary
+  # Each string is hashed once natively; repeated batches reuse the same dictionary
+  def append_bulk(%__MODULE__{type: {:low_cardinality, :string}, ref: lc_ref}, values)
+      when is_list(values) do
+    unless Enum.all?(values, &is_binary/1) do
+      raise ArgumentError, "All values must be strings for LowCardinality(String) column"
+    end
+
+    Native.column_lowcardinality_string_append_bulk(lc_ref, values)
+  end
+
   # LowCardinality type - transparent optimization
   # Dictionary encoding is handled automatically by ClickHouse
   def append_bulk(%__MODULE__{type: {:low_cardinality, inner_type}, ref: lc_ref}, values)
@@ -376,69 +351,15 @@ defmodule Natch.Column do
   end
 
   # Enum8 type - stored as Int8 with named values
-  def append_bulk(%__MODULE__{type: {:enum8, items}, ref: ref}, values) when is_list(values) do
-    # Convert string names to integers if needed
-    int_values =
-      if values == [] do
-        # Empty list, no conversion needed
-        []
-      else
-        case hd(values) do
-          val when is_integer(val) ->
-            # Already integers, validate range
-            unless Enum.all?(values, &(is_integer(&1) and &1 >= -128 and &1 <= 127)) do
-              raise ArgumentError, "All values must be integers -128..127 for Enum8 column"
-            end
-
-            values
-
-          val when is_binary(val) ->
-            # String names, look up values from items definition
-            enum_map = Map.new(items)
-
-            Enum.map(values, fn name ->
-              case Map.fetch(enum_map, name) do
-                {:ok, val} -> val
-                :error -> raise ArgumentError, "Unknown enum name: #{name}"
-              end
-            end)
-        end
-      end
-
-    Native.column_int8_append_bulk(ref, int_values)
+  # Names (strings or atoms) and integer codes may be mixed; the NIF resolves
+  # them against the column's Enum8 definition and validates in a single pass
+  def append_bulk(%__MODULE__{type: {:enum8, _items}, ref: ref}, values) when is_list(values) do
+    Native.column_enum8_append_bulk(ref, values)
   end
 
   # Enum16 type - stored as Int16 with named values
-  def append_bulk(%__MODULE__{type: {:enum16, items}, ref: ref}, values) when is_list(values) do
-    # Convert string names to integers if needed
-    int_values =
-      if values == [] do
-        # Empty list, no conversion needed
-        []
-      else
-        case hd(values) do
-          val when is_integer(val) ->
-            # Already integers, validate range
-            unless Enum.all?(values, &(is_integer(&1) and &1 >= -32_768 and &1 <= 32_767)) do
-              raise ArgumentError, "All values must be integers -32768..32767 for Enum16 column"
-            end
-
-            values
-
-          val when is_binary(val) ->
-            # String names, look up values from items definition
-            enum_map = Map.new(items)
-
-            Enum.map(values, fn name ->
-              case Map.fetch(enum_map, name) do
-                {:ok, val} -> val
-                :error -> raise ArgumentError, "Unknown enum name: #{name}"
-              end
-            end)
-        end
-      end
-
-    Native.column_int16_append_bulk(ref, int_values)
+  def append_bulk(%__MODULE__{type: {:enum16, _items}, ref: ref}, values) when is_list(values) do
+    Native.column_enum16_append_bulk(ref, values)
   end
 
   def append_bulk(%__MODULE__{type: type}, values) when is_list(values) do
@@ -607,11 +528,41 @@ defmodule Natch.Column do
     Native.column_size(ref)
   end
 
+  @doc """
+  Returns the ClickHouse type name for a column type.
+
+  ## Examples
+
+      Natch.Column.clickhouse_type({:array, :uint64})
+      # => "Array(UInt64)"
+  """
+  @spec clickhouse_type(atom() | tuple()) :: String.t()
+  def clickhouse_type(type), do: elixir_type_to_clickhouse(type)
+
   # Private functions
 
+  # Key/value types the map NIF can decode directly from terms
+  @native_map_types [
+    :uint8,
+    :uint16,
+    :uint32,
+    :uint64,
+    :int8,
+    :int16,
+    :int32,
+    :int64,
+    :float32,
+    :float64,
+    :string,
+    :bool
+  ]
+
+  defp native_map_type?(type), do: type in @native_map_types
+
   defp elixir_type_to_clickhouse(:uint64), do: "UInt64"
   defp elixir_type_to_clickhouse(:uint32), do: "UInt32"
   defp elixir_type_to_clickhouse(:uint16), do: "UInt16"
+  defp elixir_type_to_clickhouse(:uint8), do: "UInt8"
   defp elixir_type_to_clickhouse(:int64), do: "Int64"
   defp elixir_type_to_clickhouse(:int32), do: "Int32"
   defp elixir_type_to_clickhouse(:int16), do: "Int16"
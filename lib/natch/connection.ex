@@ -4,7 +4,7 @@ defmodule Natch.Connection do
   # Use the public API on the Natch module instead.
 
   use GenServer
-  alias Natch.Native
+  alias Natch.{CircuitBreaker, Native}
 
   @type option ::
           {:host, String.t()}
@@ -17,6 +17,7 @@ defmodule Natch.Connection do
           | {:connect_timeout, non_neg_integer()}
           | {:recv_timeout, non_neg_integer()}
           | {:send_timeout, non_neg_integer()}
+          | {:circuit_breaker, boolean() | keyword()}
           | {:name, atom()}
 
   @doc """
@@ -80,9 +81,10 @@ defmodule Natch.Connection do
       # => {:ok, [%{id: 1, name: "Alice"}, %{id: 2, name: "Bob"}]}
 
   """
-  @spec select_rows(GenServer.server(), String.t()) :: {:ok, [map()]} | {:error, term()}
-  def select_rows(conn, query) do
-    GenServer.call(conn, {:select_rows, query}, :infinity)
+  @spec select_rows(GenServer.server(), String.t(), keyword()) ::
+          {:ok, [map()]} | {:error, term()}
+  def select_rows(conn, query, opts \\ []) do
+    GenServer.call(conn, {:select_rows, query, select_options(opts)}, :infinity)
   end
 
   @doc """
@@ -98,9 +100,10 @@ defmodule Natch.Connection do
       # => {:ok, %{id: [1, 2], name: ["Alice", "Bob"]}}
 
   """
-  @spec select_cols(GenServer.server(), String.t()) :: {:ok, map()} | {:error, term()}
-  def select_cols(conn, query) do
-    GenServer.call(conn, {:select_cols, query}, :infinity)
+  @spec select_cols(GenServer.server(), String.t(), keyword()) ::
+          {:ok, map()} | {:error, term()}
+  def select_cols(conn, query, opts \\ []) do
+    GenServer.call(conn, {:select_cols, query, select_options(opts)}, :infinity)
   end
 
   # Phase 6C - Parameterized Query API
@@ -116,27 +119,169 @@ defmodule Natch.Connection do
   @doc """
   Executes a parameterized SELECT query and returns results in row-major format.
   """
-  @spec select_rows_parameterized(GenServer.server(), Natch.Query.t()) ::
+  @spec select_rows_parameterized(GenServer.server(), Natch.Query.t(), keyword()) ::
           {:ok, [map()]} | {:error, term()}
-  def select_rows_parameterized(conn, query) do
-    GenServer.call(conn, {:select_rows_parameterized, query}, :infinity)
+  def select_rows_parameterized(conn, query, opts \\ []) do
+    GenServer.call(conn, {:select_rows_parameterized, query, select_options(opts)}, :infinity)
   end
 
   @doc """
   Executes a parameterized SELECT query and returns results in columnar format.
   """
-  @spec select_cols_parameterized(GenServer.server(), Natch.Query.t()) ::
+  @spec select_cols_parameterized(GenServer.server(), Natch.Query.t(), keyword()) ::
           {:ok, map()} | {:error, term()}
-  def select_cols_parameterized(conn, query) do
-    GenServer.call(conn, {:select_cols_parameterized, query}, :infinity)
+  def select_cols_parameterized(conn, query, opts \\ []) do
+    GenServer.call(conn, {:select_cols_parameterized, query, select_options(opts)}, :infinity)
+  end
+
+  @doc """
+  Executes a SELECT query and returns its blocks as Native-format binaries.
+  """
+  @spec select_native(GenServer.server(), String.t() | Natch.Query.t(), keyword()) ::
+          {:ok, [binary()]} | {:error, term()}
+  def select_native(conn, query, opts \\ []) do
+    GenServer.call(conn, {:select_native, query, native_select_options(opts)}, :infinity)
+  end
+
+  @doc """
+  Inserts Native-format blocks into a table.
+  """
+  @spec insert_native(GenServer.server(), String.t(), [binary()]) :: :ok | {:error, term()}
+  def insert_native(conn, table, blocks) do
+    GenServer.call(conn, {:insert_native, table, blocks}, :infinity)
+  end
+
+  @doc """
+  Copies the result of a SELECT on `src` into `table` on `dst`.
+  """
+  @spec copy(GenServer.server(), String.t(), GenServer.server(), String.t(), keyword()) ::
+          {:ok, map()} | {:error, term()}
+  def copy(src, sql, dst, table, opts \\ []) do
+    opts = copy_options(opts)
+    src_pid = GenServer.whereis(src)
+    dst_pid = GenServer.whereis(dst)
+
+    if src_pid == dst_pid do
+      raise ArgumentError, "copy needs two different connections"
+    end
+
+    # Check out in pid order, so that copies in opposite directions can't
+    # each hold one connection while waiting for the other
+    [{_, first}, {_, second}] = Enum.sort([{src_pid, src}, {dst_pid, dst}])
+
+    with_checkout(first, fn first_lent ->
+      with_checkout(second, fn second_lent ->
+        if first == src do
+          run_copy(first_lent, sql, second_lent, table, opts)
+        else
+          run_copy(second_lent, sql, first_lent, table, opts)
+        end
+      end)
+    end)
+  end
+
+  # Borrow the client of `conn` for `fun`. The connection handles nothing
+  # else until it is returned, or until this process exits.
+  defp with_checkout(conn, fun) do
+    {:ok, lent} = GenServer.call(conn, :checkout, :infinity)
+
+    try do
+      fun.(lent)
+    after
+      send(lent.conn, {:checkin, lent.ref})
+    end
+  end
+
+  # Each endpoint is charged for its own errors. An error that is not a
+  # connection failure means both answered.
+  defp run_copy(src, sql, dst, table, opts) do
+    case {CircuitBreaker.allow(src.endpoint), CircuitBreaker.allow(dst.endpoint)} do
+      {:ok, :ok} ->
+        try do
+          stats =
+            Native.client_copy(
+              src.client,
+              sql,
+              dst.client,
+              table,
+              opts.rename,
+              opts.cast,
+              opts.max_queued_blocks,
+              opts.min_insert_rows
+            )
+
+          CircuitBreaker.record(src.endpoint, :success)
+          CircuitBreaker.record(dst.endpoint, :success)
+          {:ok, stats}
+        rescue
+          e ->
+            {failed, other} = if copy_error_side(e) == "source", do: {src, dst}, else: {dst, src}
+
+            case breaker_outcome(e) do
+              :success ->
+                CircuitBreaker.record(failed.endpoint, :success)
+                CircuitBreaker.record(other.endpoint, :success)
+
+              outcome ->
+                CircuitBreaker.record(failed.endpoint, outcome)
+                CircuitBreaker.release(other.endpoint)
+            end
+
+            error_tuple(e)
+        end
+
+      {src_allowed, dst_allowed} ->
+        # Give back the half-open probe of the side that would have gone
+        if src_allowed == :ok, do: CircuitBreaker.release(src.endpoint)
+        if dst_allowed == :ok, do: CircuitBreaker.release(dst.endpoint)
+        {:error, :circuit_open}
+    end
+  end
+
+  defp copy_error_side(exception_struct) do
+    case Jason.decode(Exception.message(exception_struct)) do
+      {:ok, %{"side" => side}} -> side
+      _ -> nil
+    end
+  end
+
+  @doc false
+  # Positional connection arguments shared by client_create and spool_open
+  def client_args(opts) do
+    [
+      Keyword.get(opts, :host, "localhost"),
+      Keyword.get(opts, :port, 9000),
+      Keyword.get(opts, :database, "default"),
+      Keyword.get(opts, :user, "default"),
+      Keyword.get(opts, :password, ""),
+      Keyword.get(opts, :compression, true),
+      Keyword.get(opts, :ssl, false),
+      # Timeout options - match C++ library defaults
+      Keyword.get(opts, :connect_timeout, 5000),
+      Keyword.get(opts, :recv_timeout, 0),
+      Keyword.get(opts, :send_timeout, 0)
+    ]
   end
 
   # GenServer callbacks
 
   @impl true
   def init(opts) do
-    {:ok, client} = build_client(opts)
-    {:ok, %{client: client, opts: opts}}
+    {breaker_opts, opts} = Keyword.pop(opts, :circuit_breaker, true)
+    endpoint = register_endpoint(opts, breaker_opts)
+
+    case CircuitBreaker.allow(endpoint) do
+      :ok ->
+        {:ok, client} = build_client(opts, endpoint)
+        {:ok, %{client: client, opts: opts, endpoint: endpoint}}
+
+      {:error, :circuit_open} ->
+        {host, port} = endpoint
+
+        raise Natch.ConnectionError,
+          message: "circuit open for #{host}:#{port}",
+          reason: :circuit_open
+    end
   end
 
   @impl true
@@ -146,107 +291,336 @@ defmodule Natch.Connection do
 
   @impl true
   def handle_call({:execute, sql}, _from, state) do
-    try do
-      Native.client_execute(state.client, sql)
-      {:reply, :ok, state}
-    rescue
-      e -> {:reply, error_tuple(e), state}
-    end
+    reply =
+      guarded(state, fn ->
+        Native.client_execute(state.client, sql)
+        :ok
+      end)
+
+    {:reply, reply, state}
   end
 
   @impl true
   def handle_call(:ping, _from, state) do
-    try do
-      Native.client_ping(state.client)
-      {:reply, :ok, state}
-    rescue
-      e -> {:reply, error_tuple(e), state}
-    end
+    reply =
+      guarded(state, fn ->
+        Native.client_ping(state.client)
+        :ok
+      end)
+
+    {:reply, reply, state}
   end
 
   @impl true
   def handle_call(:reset, _from, state) do
-    try do
-      Native.client_reset_connection(state.client)
-      {:reply, :ok, state}
-    rescue
-      e -> {:reply, error_tuple(e), state}
-    end
+    reply =
+      guarded(state, fn ->
+        Native.client_reset_connection(state.client)
+        :ok
+      end)
+
+    {:reply, reply, state}
   end
 
   @impl true
   def handle_call({:insert, table, columns, schema}, _from, state) do
-    try do
-      # Build block from columnar data
-      block = Natch.Block.build_block(columns, schema)
+    reply =
+      guarded(state, fn ->
+        # Build block from columnar data
+        block = Natch.Block.build_block(columns, schema)
 
-      # Insert block
-      Native.client_insert(state.client, table, block)
+        # Insert block
+        Native.client_insert(state.client, table, block)
+        :ok
+      end)
 
-      {:reply, :ok, state}
-    rescue
-      e -> {:reply, error_tuple(e), state}
-    end
+    {:reply, reply, state}
   end
 
   @impl true
-  def handle_call({:select_rows, query}, _from, state) do
-    try do
-      # client_select returns list of maps directly
-      rows = Native.client_select(state.client, query)
+  def handle_call({:insert_block, table, block}, _from, state) do
+    # Block was built by the caller; only compression and I/O happen here
+    reply =
+      guarded(state, fn ->
+        Native.client_insert(state.client, table, block)
+        :ok
+      end)
+
+    {:reply, reply, state}
+  end
 
-      {:reply, {:ok, rows}, state}
-    rescue
-      e -> {:reply, error_tuple(e), state}
-    end
+  @impl true
+  def handle_call({:select_rows, query, opts}, _from, state) do
+    reply =
+      guarded(state, fn ->
+        # client_select returns list of maps directly
+        rows = Native.client_select(state.client, query, opts)
+        select_reply(rows, opts)
+      end)
+
+    {:reply, reply, state}
   end
 
   @impl true
-  def handle_call({:select_cols, query}, _from, state) do
-    try do
-      # client_select_cols returns map of column lists
-      cols = Native.client_select_cols(state.client, query)
+  def handle_call({:select_cols, query, opts}, _from, state) do
+    reply =
+      guarded(state, fn ->
+        # client_select_cols returns map of column lists
+        cols = Native.client_select_cols(state.client, query, opts)
+        select_reply(cols, opts)
+      end)
+
+    {:reply, reply, state}
+  end
 
-      {:reply, {:ok, cols}, state}
-    rescue
-      e -> {:reply, error_tuple(e), state}
+  @impl true
+  def handle_call({:select_native, %Natch.Query{} = query, opts}, _from, state) do
+    reply =
+      guarded(state, fn ->
+        {:ok, Native.client_select_native_parameterized(state.client, query.ref, opts)}
+      end)
+
+    {:reply, reply, state}
+  end
+
+  @impl true
+  def handle_call({:select_native, sql, opts}, _from, state) do
+    reply = guarded(state, fn -> {:ok, Native.client_select_native(state.client, sql, opts)} end)
+    {:reply, reply, state}
+  end
+
+  @impl true
+  def handle_call({:insert_native, table, blocks}, _from, state) do
+    reply =
+      guarded(state, fn ->
+        Native.client_insert_native(state.client, table, blocks)
+        :ok
+      end)
+
+    {:reply, reply, state}
+  end
+
+  # Lends the client to the caller (see copy/5) and waits here, handling
+  # nothing else, until the caller checks it back in or exits
+  @impl true
+  def handle_call(:checkout, {owner, _tag} = from, state) do
+    ref = Process.monitor(owner)
+    lent = %{conn: self(), client: state.client, endpoint: state.endpoint, ref: ref}
+    GenServer.reply(from, {:ok, lent})
+
+    receive do
+      {:checkin, ^ref} -> Process.demonitor(ref, [:flush])
+      {:DOWN, ^ref, :process, _pid, _reason} -> :ok
     end
+
+    {:noreply, state}
   end
 
   # Phase 6C - Parameterized Query Support
 
   @impl true
   def handle_call({:execute_parameterized, query}, _from, state) do
-    try do
-      Native.client_execute_parameterized(state.client, query.ref)
-      {:reply, :ok, state}
-    rescue
-      e -> {:reply, error_tuple(e), state}
-    end
+    reply =
+      guarded(state, fn ->
+        Native.client_execute_parameterized(state.client, query.ref)
+        :ok
+      end)
+
+    {:reply, reply, state}
   end
 
   @impl true
-  def handle_call({:select_rows_parameterized, query}, _from, state) do
-    try do
-      rows = Native.client_select_parameterized(state.client, query.ref)
-      {:reply, {:ok, rows}, state}
-    rescue
-      e -> {:reply, error_tuple(e), state}
-    end
+  def handle_call({:select_rows_parameterized, query, opts}, _from, state) do
+    reply =
+      guarded(state, fn ->
+        rows = Native.client_select_parameterized(state.client, query.ref, opts)
+        select_reply(rows, opts)
+      end)
+
+    {:reply, reply, state}
   end
 
   @impl true
-  def handle_call({:select_cols_parameterized, query}, _from, state) do
-    try do
-      cols = Native.client_select_cols_parameterized(state.client, query.ref)
-      {:reply, {:ok, cols}, state}
-    rescue
-      e -> {:reply, error_tuple(e), state}
-    end
+  def handle_call({:select_cols_parameterized, query, opts}, _from, state) do
+    reply =
+      guarded(state, fn ->
+        cols = Native.client_select_cols_parameterized(state.client, query.ref, opts)
+        select_reply(cols, opts)
+      end)
+
+    {:reply, reply, state}
   end
 
   # Private functions
 
+  # Validated in the caller so bad options raise there, not in the GenServer
+  defp select_options(opts) do
+    opts =
+      Keyword.validate!(opts,
+        intern_strings: false,
+        intern_threshold: 0.5,
+        decode_stats: false,
+        cancel_token: nil,
+        filter: [],
+        sample: nil
+      )
+
+    for key <- [:intern_strings, :decode_stats], not is_boolean(opts[key]) do
+      raise ArgumentError, "#{inspect(key)} must be a boolean"
+    end
+
+    unless is_float(opts[:intern_threshold]) and opts[:intern_threshold] >= 0.0 and
+             opts[:intern_threshold] <= 1.0 do
+      raise ArgumentError, ":intern_threshold must be a float between 0.0 and 1.0"
+    end
+
+    opts
+    |> Keyword.update!(:filter, &filter_predicates/1)
+    |> Keyword.update!(:sample, &sample_spec/1)
+    |> Enum.reject(&(&1 in [cancel_token: nil, filter: [], sample: nil]))
+    |> Map.new()
+  end
+
+  @filter_comparisons [:==, :!=, :<, :<=, :>, :>=]
+
+  # Normalize :filter to the {column, op, value} tuples the NIF decodes, with
+  # dates and datetimes as the integers ClickHouse stores
+  defp filter_predicates(predicates) when is_list(predicates) do
+    Enum.map(predicates, fn
+      {column, op} when op in [:is_nil, :not_nil] ->
+        {filter_column(column), op, nil}
+
+      {column, op, values} when op in [:in, :not_in] and is_list(values) ->
+        {filter_column(column), op, Enum.map(values, &filter_value/1)}
+
+      {column, op, value} when op in @filter_comparisons ->
+        {filter_column(column), op, filter_value(value)}
+
+      other ->
+        raise ArgumentError, "invalid :filter predicate: #{inspect(other)}"
+    end)
+  end
+
+  defp filter_predicates(other) do
+    raise ArgumentError, ":filter must be a list of predicates, got: #{inspect(other)}"
+  end
+
+  defp filter_column(column) when is_atom(column), do: Atom.to_string(column)
+  defp filter_column(column) when is_binary(column), do: column
+
+  defp filter_column(column) do
+    raise ArgumentError, ":filter column must be an atom or string, got: #{inspect(column)}"
+  end
+
+  defp filter_value(value) when is_number(value) or is_binary(value), do: value
+  defp filter_value(true), do: 1
+  defp filter_value(false), do: 0
+  defp filter_value(%Date{} = date), do: Date.diff(date, ~D[1970-01-01])
+  # Tagged so the NIF can scale to the column: seconds for DateTime, ticks
+  # at the column's precision for DateTime64
+  defp filter_value(%DateTime{} = datetime),
+    do: {:unix_us, DateTime.to_unix(datetime, :microsecond)}
+
+  defp filter_value(%NaiveDateTime{} = datetime),
+    do: {:unix_us, NaiveDateTime.diff(datetime, ~N[1970-01-01 00:00:00], :microsecond)}
+
+  defp filter_value(nil) do
+    raise ArgumentError, "use {column, :is_nil} to filter on NULL"
+  end
+
+  defp filter_value(value) do
+    raise ArgumentError, "unsupported :filter value: #{inspect(value)}"
+  end
+
+  # {mode, n, seed} as the NIF decodes it
+  defp sample_spec(nil), do: nil
+  defp sample_spec({:every, n}) when is_integer(n) and n > 0, do: {:every, n, nil}
+  defp sample_spec({:reservoir, k}) when is_integer(k) and k > 0, do: {:reservoir, k, nil}
+
+  defp sample_spec({:reservoir, k, seed})
+       when is_integer(k) and k > 0 and is_integer(seed) and seed >= 0,
+       do: {:reservoir, k, seed}
+
+  defp sample_spec(other) do
+    raise ArgumentError,
+          ":sample must be {:every, n} or {:reservoir, k} with a positive integer, " <>
+            "got: #{inspect(other)}"
+  end
+
+  # Blocks are passed through undecoded, so only cancellation applies
+  defp native_select_options(opts) do
+    case Keyword.validate!(opts, cancel_token: nil) do
+      [cancel_token: nil] -> %{}
+      opts -> Map.new(opts)
+    end
+  end
+
+  defp copy_options(opts) do
+    opts =
+      Keyword.validate!(opts,
+        rename: [],
+        cast: [],
+        max_queued_blocks: 4,
+        min_insert_rows: 1_048_576
+      )
+
+    for key <- [:max_queued_blocks, :min_insert_rows] do
+      unless is_integer(opts[key]) and opts[key] > 0 do
+        raise ArgumentError, "#{inspect(key)} must be a positive integer"
+      end
+    end
+
+    %{
+      rename: for({from, to} <- opts[:rename], do: {to_string(from), to_string(to)}),
+      cast: for({column, type} <- opts[:cast], do: {to_string(column), cast_type(type)}),
+      max_queued_blocks: opts[:max_queued_blocks],
+      min_insert_rows: opts[:min_insert_rows]
+    }
+  end
+
+  # ClickHouse type names pass through; Natch column types are translated
+  defp cast_type(type) when is_binary(type), do: type
+  defp cast_type(type), do: Natch.Column.clickhouse_type(type)
+
+  # With decode_stats the NIF returns {result, stats}
+  defp select_reply({result, stats}, %{decode_stats: true}),
+    do: {:ok, result, %{decode_stats: stats}}
+
+  defp select_reply(result, _opts), do: {:ok, result}
+
+  defp register_endpoint(_opts, false), do: nil
+
+  defp register_endpoint(opts, breaker_opts) do
+    endpoint = {Keyword.get(opts, :host, "localhost"), Keyword.get(opts, :port, 9000)}
+    :ok = CircuitBreaker.register(endpoint, if(breaker_opts == true, do: [], else: breaker_opts))
+    endpoint
+  end
+
+  # Runs a native call behind the endpoint's circuit breaker. Only
+  # connection failures count against the endpoint; a server error means
+  # it answered, and a receive timeout only that the query was slow.
+  defp guarded(state, fun) do
+    with :ok <- CircuitBreaker.allow(state.endpoint) do
+      try do
+        reply = fun.()
+        CircuitBreaker.record(state.endpoint, :success)
+        reply
+      rescue
+        e ->
+          CircuitBreaker.record(state.endpoint, breaker_outcome(e))
+          error_tuple(e)
+      end
+    end
+  end
+
+  defp breaker_outcome(exception_struct) do
+    cond do
+      Natch.Error.timeout_error?(exception_struct) -> :timeout
+      Natch.Error.connection_error?(exception_struct) -> :failure
+      true -> :success
+    end
+  end
+
   # Delegate to shared error handling
   defp handle_error(exception_struct) do
     Natch.Error.handle_nif_error(exception_struct)
@@ -256,38 +630,15 @@ defmodule Natch.Connection do
     Natch.Error.handle_callback_error(exception_struct)
   end
 
-  defp build_client(opts) do
-    host = Keyword.get(opts, :host, "localhost")
-    port = Keyword.get(opts, :port, 9000)
-    database = Keyword.get(opts, :database, "default")
-    user = Keyword.get(opts, :user, "default")
-    password = Keyword.get(opts, :password, "")
-    compression = Keyword.get(opts, :compression, true)
-    ssl = Keyword.get(opts, :ssl, false)
-
-    # Timeout options - match C++ library defaults
-    connect_timeout = Keyword.get(opts, :connect_timeout, 5000)
-    recv_timeout = Keyword.get(opts, :recv_timeout, 0)
-    send_timeout = Keyword.get(opts, :send_timeout, 0)
-
+  defp build_client(opts, endpoint) do
     try do
-      client =
-        Native.client_create(
-          host,
-          port,
-          database,
-          user,
-          password,
-          compression,
-          ssl,
-          connect_timeout,
-          recv_timeout,
-          send_timeout
-        )
-
+      client = apply(Native, :client_create, client_args(opts))
+      CircuitBreaker.record(endpoint, :success)
       {:ok, client}
     rescue
-      e -> handle_error(e)
+      e ->
+        CircuitBreaker.record(endpoint, breaker_outcome(e))
+        handle_error(e)
     end
   end
 end
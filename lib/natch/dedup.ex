@@ -0,0 +1,154 @@
+defmodule Natch.Dedup do
+  @moduledoc """
+  Recent-keys filter that drops already-inserted rows before they are sent.
+
+  At-least-once pipelines resend overlapping batches. A dedup filter
+  remembers the keys of rows inserted during the last `:window` and drops
+  rows whose key it has seen, before the block is built, so duplicates cost
+  neither network nor server-side merges. Rows repeated within one batch are
+  dropped too.
+
+  The filter is a time-windowed Bloom filter in native memory: it never
+  lets a duplicate through while its key is in the window, but may drop a
+  new row as a false positive at the configured rate. Use it to save work,
+  and keep a deduplicating table engine (`ReplacingMergeTree`, insert
+  deduplication) where correctness depends on it.
+
+  `Natch.insert_cols/5`, `Natch.insert_rows/5` and `Natch.insert_stream/5`
+  only remember keys once the server acknowledged the INSERT, so a failed
+  insert can be retried with the same rows. Two processes inserting the
+  same new key at the same time may both send it.
+
+  A filter can be shared by any number of processes and connections.
+
+  ## Examples
+
+      dedup = Natch.Dedup.new(keys: [:event_id], capacity: 1_000_000)
+
+      :ok = Natch.insert_cols(conn, "events", columns, schema, dedup: dedup)
+
+      # Or check explicitly, and remember the keys once the rows are stored
+      {columns, kept, pending} = Natch.Dedup.check(dedup, columns)
+      :ok = Natch.Spool.insert(spool, "events", columns, schema)
+      :ok = Natch.Dedup.commit(dedup, pending)
+
+  ## Options
+
+    * `:keys` - Columns whose values together identify a row (required)
+    * `:capacity` - Distinct keys expected per window (default: `1_000_000`)
+    * `:false_positive_rate` - Share of new rows that may be dropped as
+      duplicates at `:capacity` keys (default: `0.001`)
+    * `:window` - Milliseconds a key is remembered: at least half of this,
+      at most all of it (default: `600_000`)
+    * `:max_memory` - Upper bound in bytes on the filter's memory; when the
+      requested rate needs more, the rate rises instead (default: no limit)
+
+  Memory is about `-capacity * ln(rate) / ln(2)^2` bits for each of two
+  generations: roughly 3.6 MB for the defaults. `stats/1` reports the actual
+  size and expected rate.
+  """
+
+  alias Natch.Native
+
+  @enforce_keys [:ref, :keys]
+  defstruct [:ref, :keys]
+
+  @type t :: %__MODULE__{ref: reference(), keys: [atom() | String.t()]}
+
+  @typedoc "Keys of the rows `check/3` kept, to pass to `commit/2`."
+  @opaque pending :: binary()
+
+  @doc """
+  Creates a filter. See the module documentation for options.
+  """
+  @spec new(keyword()) :: t()
+  def new(opts) do
+    opts =
+      Keyword.validate!(opts, [
+        :keys,
+        capacity: 1_000_000,
+        false_positive_rate: 0.001,
+        window: 600_000,
+        max_memory: nil
+      ])
+
+    keys = opts[:keys]
+
+    unless is_list(keys) and keys != [] do
+      raise ArgumentError, ":keys must be a non-empty list of column names"
+    end
+
+    unless is_float(opts[:false_positive_rate]) and opts[:false_positive_rate] > 0.0 and
+             opts[:false_positive_rate] < 1.0 do
+      raise ArgumentError, ":false_positive_rate must be a float between 0.0 and 1.0"
+    end
+
+    ref =
+      Native.dedup_create(
+        opts[:capacity],
+        opts[:false_positive_rate],
+        opts[:window],
+        opts[:max_memory] || 0
+      )
+
+    %__MODULE__{ref: ref, keys: keys}
+  end
+
+  @doc """
+  Drops the rows of `columns` whose key was seen within the window, or
+  earlier in `columns`, without remembering any key.
+
+  `in_flight` is the pending value of an insert not yet acknowledged; its
+  keys count as seen. Returns the filtered columns, the number of rows kept
+  and their pending keys, for `commit/2` once they are inserted.
+  """
+  @spec check(t(), map(), pending()) :: {map(), non_neg_integer(), pending()}
+  def check(%__MODULE__{ref: ref, keys: keys}, columns, in_flight \\ <<>>)
+      when is_map(columns) do
+    key_lists = Enum.map(keys, &fetch_column!(columns, &1))
+    {names, lists} = columns |> Enum.to_list() |> Enum.unzip()
+    {filtered, kept, pending} = Native.dedup_check(ref, key_lists, lists, in_flight)
+
+    {names |> Enum.zip(filtered) |> Map.new(), kept, pending}
+  end
+
+  @doc """
+  Remembers the keys `check/3` kept. Call it once those rows are inserted.
+  """
+  @spec commit(t(), pending()) :: :ok
+  def commit(%__MODULE__{ref: ref}, pending), do: Native.dedup_commit(ref, pending)
+
+  @doc """
+  Drops the rows of `columns` whose key was seen within the window and
+  remembers the keys of the rest at once, as `check/3` then `commit/2`.
+
+  Returns the filtered columns and the number of rows kept.
+  """
+  @spec filter(t(), map()) :: {map(), non_neg_integer()}
+  def filter(dedup, columns) do
+    {columns, kept, pending} = check(dedup, columns)
+    :ok = commit(dedup, pending)
+    {columns, kept}
+  end
+
+  @doc """
+  Returns filter counters: memory in bytes, capacity, hash functions,
+  expected false-positive rate, rows checked and dropped, and rotations.
+  """
+  @spec stats(t()) :: map()
+  def stats(%__MODULE__{ref: ref}), do: Native.dedup_stats(ref)
+
+  @doc """
+  Forgets every key.
+  """
+  @spec reset(t()) :: :ok
+  def reset(%__MODULE__{ref: ref}), do: Native.dedup_reset(ref)
+
+  # Support both atom and string keys, as Natch.Block does
+  defp fetch_column!(columns, name) do
+    case Map.get(columns, name) || Map.get(columns, to_string(name)) do
+      nil -> raise ArgumentError, "Missing key column #{inspect(name)} for dedup"
+      values -> values
+    end
+  end
+end
@@ -228,6 +228,28 @@ defmodule Natch.Error do
     end
   end
 
+  @doc """
+  Whether a NIF error is a connection-level failure (connect, send or
+  receive), as opposed to an error reported by a reachable server.
+  """
+  def connection_error?(exception_struct) do
+    case Jason.decode(Exception.message(exception_struct)) do
+      {:ok, %{"type" => "connection"}} -> true
+      _ -> false
+    end
+  end
+
+  @doc """
+  Whether a NIF error is a receive that timed out (`:recv_timeout`): the
+  endpoint took the request but did not answer in time.
+  """
+  def timeout_error?(exception_struct) do
+    case Jason.decode(Exception.message(exception_struct)) do
+      {:ok, %{"type" => "connection", "timeout" => true}} -> true
+      _ -> false
+    end
+  end
+
   @doc """
   Handle GenServer callback errors by parsing JSON and returning error tuples.
 
@@ -0,0 +1,272 @@
+defmodule Natch.Hedge do
+  @moduledoc """
+  Hedged reads across replicas.
+
+  A hedged read sends the query to the first connection. If that replica has
+  neither finished nor started streaming rows within the hedge delay, the
+  same query goes to the next connection as well. The first successful
+  response wins and the other query is cancelled, so one slow replica no
+  longer sets the tail latency.
+
+  Only use hedging for read-only queries: both replicas may run the query.
+
+  ## Examples
+
+      {:ok, replica_a} = Natch.start_link(host: "ch-1")
+      {:ok, replica_b} = Natch.start_link(host: "ch-2")
+
+      {:ok, rows} =
+        Natch.Hedge.select_rows(
+          [replica_a, replica_b],
+          "SELECT * FROM events WHERE user_id = {uid}",
+          [uid: 42],
+          hedge_after: :p95
+        )
+
+      Natch.Hedge.stats()
+      # => %{queries: 1000, hedged: 48, hedge_rate: 0.048, hedge_wins: 31,
+      #      primary_wins: 17, p95_ms: 12}
+
+  ## Options
+
+    * `:hedge_after` - Delay before hedging: milliseconds, or `:p95` to use
+      the observed 95th percentile of recent primary latencies (default:
+      `:p95`). Until enough latencies are recorded, `:p95` waits 50ms.
+
+  All other options are passed through to `Natch.select_rows/4` or
+  `Natch.select_cols/4`.
+
+  A cancelled query stops when the losing replica delivers its next block.
+  """
+
+  @default_delay_ms 50
+  @samples 128
+  @min_samples 20
+
+  # :counters indices
+  @queries 1
+  @hedged 2
+  @hedge_wins 3
+  @primary_wins 4
+  @sample_cursor 5
+
+  @doc """
+  Runs a hedged `Natch.select_rows/4` across `conns`, in preference order.
+  """
+  @spec select_rows([Natch.conn()], String.t(), keyword() | map(), keyword()) ::
+          {:ok, [Natch.row()]} | {:error, term()}
+  def select_rows(conns, sql, params \\ [], opts \\ []) do
+    run(&Natch.select_rows/4, conns, sql, params, opts)
+  end
+
+  @doc """
+  Runs a hedged `Natch.select_cols/4` across `conns`, in preference order.
+  """
+  @spec select_cols([Natch.conn()], String.t(), keyword() | map(), keyword()) ::
+          {:ok, map()} | {:error, term()}
+  def select_cols(conns, sql, params \\ [], opts \\ []) do
+    run(&Natch.select_cols/4, conns, sql, params, opts)
+  end
+
+  @doc """
+  Returns hedging statistics since start (or the last `reset_stats/0`).
+  """
+  @spec stats() :: map()
+  def stats do
+    {counters, _latencies} = state()
+    queries = :counters.get(counters, @queries)
+    hedged = :counters.get(counters, @hedged)
+
+    %{
+      queries: queries,
+      hedged: hedged,
+      hedge_rate: if(queries > 0, do: hedged / queries, else: 0.0),
+      hedge_wins: :counters.get(counters, @hedge_wins),
+      primary_wins: :counters.get(counters, @primary_wins),
+      p95_ms: p95()
+    }
+  end
+
+  @doc """
+  Resets hedging statistics and recorded latencies.
+  """
+  @spec reset_stats() :: :ok
+  def reset_stats do
+    {counters, latencies} = state()
+
+    for i <- [@queries, @hedged, @hedge_wins, @primary_wins, @sample_cursor] do
+      :counters.put(counters, i, 0)
+    end
+
+    for i <- 1..@samples, do: :atomics.put(latencies, i, 0)
+    :ok
+  end
+
+  @doc false
+  # Called from Natch.Application at start
+  def init do
+    counters = :counters.new(5, [:write_concurrency])
+    latencies = :atomics.new(@samples, signed: false)
+    :persistent_term.put(__MODULE__, {counters, latencies})
+  end
+
+  # Private functions
+
+  defp run(select, [primary | rest], sql, params, opts) do
+    {hedge_after, select_opts} = Keyword.pop(opts, :hedge_after, :p95)
+    delay_ms = hedge_delay(hedge_after)
+    {counters, _latencies} = state()
+    :counters.add(counters, @queries, 1)
+
+    started = System.monotonic_time(:millisecond)
+    first = start_attempt(select, primary, sql, params, select_opts)
+
+    case await_primary(first, delay_ms) do
+      {:done, result} ->
+        record_latency(started)
+        result
+
+      :slow when rest != [] ->
+        :counters.add(counters, @hedged, 1)
+        second = start_attempt(select, hd(rest), sql, params, select_opts)
+        race(first, second, started)
+
+      :slow ->
+        result = Task.await(first.task, :infinity)
+        record_latency(started)
+        result
+    end
+  end
+
+  defp start_attempt(select, conn, sql, params, opts) do
+    ref = make_ref()
+    token = Natch.Native.cancel_token_create(ref)
+
+    task =
+      Task.async(fn ->
+        try do
+          select.(conn, sql, params, Keyword.put(opts, :cancel_token, token))
+        catch
+          :exit, reason -> {:error, reason}
+        end
+      end)
+
+    %{task: task, ref: ref, token: token}
+  end
+
+  # Wait for the primary to finish or start streaming rows, up to delay_ms
+  defp await_primary(%{task: %Task{ref: task_ref} = task, ref: ref}, delay_ms) do
+    receive do
+      {^task_ref, result} ->
+        Process.demonitor(task_ref, [:flush])
+        flush_first_block(ref)
+        {:done, result}
+
+      {:natch_first_block, ^ref} ->
+        {:done, Task.await(task, :infinity)}
+    after
+      delay_ms -> :slow
+    end
+  end
+
+  # First successful response wins; an error waits for the other attempt
+  defp race(first, second, started) do
+    %{task: %Task{ref: first_ref}} = first
+    %{task: %Task{ref: second_ref}} = second
+    {counters, _latencies} = state()
+
+    receive do
+      {^first_ref, result} ->
+        Process.demonitor(first_ref, [:flush])
+
+        case result do
+          {:ok, _} ->
+            cancel(second)
+            flush_first_block(first.ref)
+            :counters.add(counters, @primary_wins, 1)
+            record_latency(started)
+            result
+
+          _error ->
+            flush_first_block(first.ref)
+            await_fallback(second, @hedge_wins, started)
+        end
+
+      {^second_ref, result} ->
+        Process.demonitor(second_ref, [:flush])
+
+        case result do
+          {:ok, _} ->
+            cancel(first)
+            flush_first_block(second.ref)
+            :counters.add(counters, @hedge_wins, 1)
+            # The primary would have taken at least this long
+            record_latency(started)
+            result
+
+          _error ->
+            flush_first_block(second.ref)
+            await_fallback(first, @primary_wins, started)
+        end
+    end
+  end
+
+  # The other attempt failed, so this one answers whatever it returns
+  defp await_fallback(%{task: task, ref: ref}, win_counter, started) do
+    result = Task.await(task, :infinity)
+    flush_first_block(ref)
+    {counters, _latencies} = state()
+    if match?({:ok, _}, result), do: :counters.add(counters, win_counter, 1)
+    record_latency(started)
+    result
+  end
+
+  defp cancel(%{task: task, ref: ref, token: token}) do
+    Natch.Native.cancel_token_cancel(token)
+    Task.shutdown(task, :brutal_kill)
+    flush_first_block(ref)
+  end
+
+  defp flush_first_block(ref) do
+    receive do
+      {:natch_first_block, ^ref} -> :ok
+    after
+      0 -> :ok
+    end
+  end
+
+  defp hedge_delay(ms) when is_integer(ms) and ms >= 0, do: ms
+  defp hedge_delay(:p95), do: p95() || @default_delay_ms
+
+  defp hedge_delay(other) do
+    raise ArgumentError,
+          ":hedge_after must be a non-negative integer or :p95, got: #{inspect(other)}"
+  end
+
+  # Query latencies, in a ring of @samples. When a hedge beats a primary
+  # still running, the elapsed time goes in as a lower bound on the
+  # primary's latency. Leaving it out would keep only the fast primaries,
+  # pull the p95 down and make hedging fire ever earlier.
+  defp record_latency(started) do
+    {counters, latencies} = state()
+    elapsed = System.monotonic_time(:millisecond) - started
+    :counters.add(counters, @sample_cursor, 1)
+    slot = rem(:counters.get(counters, @sample_cursor) - 1, @samples) + 1
+    # Stored +1 so that 0 marks an empty slot
+    :atomics.put(latencies, slot, elapsed + 1)
+  end
+
+  defp p95 do
+    {_counters, latencies} = state()
+
+    samples =
+      for i <- 1..@samples, value = :atomics.get(latencies, i), value > 0, do: value - 1
+
+    if length(samples) >= @min_samples do
+      sorted = Enum.sort(samples)
+      Enum.at(sorted, ceil(length(sorted) * 0.95) - 1)
+    end
+  end
+
+  defp state, do: :persistent_term.get(__MODULE__)
+end
@@ -43,18 +43,20 @@ defmodule Natch.Native do
   def column_datetime_append(_col, _timestamp), do: :erlang.nif_error(:nif_not_loaded)
 
   def column_size(_col), do: :erlang.nif_error(:nif_not_loaded)
+  def column_encode_native(_type_name, _values), do: :erlang.nif_error(:nif_not_loaded)
+  def column_save_native(_col), do: :erlang.nif_error(:nif_not_loaded)
 
   # Phase 5 - Bulk Append NIFs (Performance Optimization)
   def column_uint64_append_bulk(_col, _values), do: :erlang.nif_error(:nif_not_loaded)
   def column_int64_append_bulk(_col, _values), do: :erlang.nif_error(:nif_not_loaded)
   def column_string_append_bulk(_col, _values), do: :erlang.nif_error(:nif_not_loaded)
   def column_float64_append_bulk(_col, _values), do: :erlang.nif_error(:nif_not_loaded)
-  def column_datetime_append_bulk(_col, _timestamps), do: :erlang.nif_error(:nif_not_loaded)
+  def column_datetime_append_bulk(_col, _values), do: :erlang.nif_error(:nif_not_loaded)
 
   # Phase 5C - Additional Type Support
-  def column_datetime64_append_bulk(_col, _ticks), do: :erlang.nif_error(:nif_not_loaded)
-  def column_date_append_bulk(_col, _days), do: :erlang.nif_error(:nif_not_loaded)
-  def column_decimal_append_bulk(_col, _scaled_values), do: :erlang.nif_error(:nif_not_loaded)
+  def column_datetime64_append_bulk(_col, _values), do: :erlang.nif_error(:nif_not_loaded)
+  def column_date_append_bulk(_col, _values), do: :erlang.nif_error(:nif_not_loaded)
+  def column_decimal_append_bulk(_col, _values), do: :erlang.nif_error(:nif_not_loaded)
   def column_uint8_append_bulk(_col, _values), do: :erlang.nif_error(:nif_not_loaded)
   def column_uint32_append_bulk(_col, _values), do: :erlang.nif_error(:nif_not_loaded)
   def column_uint16_append_bulk(_col, _values), do: :erlang.nif_error(:nif_not_loaded)
@@ -76,10 +78,19 @@ defmodule Natch.Native do
   def column_map_append_from_array(_map_col, _array_tuple_col),
     do: :erlang.nif_error(:nif_not_loaded)
 
+  def column_map_append_bulk(_map_col, _maps), do: :erlang.nif_error(:nif_not_loaded)
+
   # LowCardinality column NIF
   def column_lowcardinality_append_from_column(_lc_col, _source_col),
     do: :erlang.nif_error(:nif_not_loaded)
 
+  def column_lowcardinality_string_append_bulk(_lc_col, _values),
+    do: :erlang.nif_error(:nif_not_loaded)
+
+  # Enum column NIFs (names or codes, validated natively)
+  def column_enum8_append_bulk(_col, _values), do: :erlang.nif_error(:nif_not_loaded)
+  def column_enum16_append_bulk(_col, _values), do: :erlang.nif_error(:nif_not_loaded)
+
   # Nullable type NIFs
   def column_nullable_uint64_append_bulk(_col, _values, _nulls),
     do: :erlang.nif_error(:nif_not_loaded)
@@ -98,11 +109,32 @@ defmodule Natch.Native do
   def block_append_column(_block, _name, _column), do: :erlang.nif_error(:nif_not_loaded)
   def block_row_count(_block), do: :erlang.nif_error(:nif_not_loaded)
   def block_column_count(_block), do: :erlang.nif_error(:nif_not_loaded)
+  def block_to_native(_block), do: :erlang.nif_error(:nif_not_loaded)
+  def client_insert_native(_client, _table, _blocks), do: :erlang.nif_error(:nif_not_loaded)
+
+  def client_copy(_src, _sql, _dst, _table, _rename, _cast, _max_queued, _min_insert_rows),
+    do: :erlang.nif_error(:nif_not_loaded)
   def client_insert(_client, _table_name, _block), do: :erlang.nif_error(:nif_not_loaded)
 
   # Phase 4 - SELECT NIFs
-  def client_select(_client, _query), do: :erlang.nif_error(:nif_not_loaded)
-  def client_select_cols(_client, _query), do: :erlang.nif_error(:nif_not_loaded)
+  def client_select(_client, _query, _opts), do: :erlang.nif_error(:nif_not_loaded)
+  def client_select_cols(_client, _query, _opts), do: :erlang.nif_error(:nif_not_loaded)
+  def select_buffer_stats(), do: :erlang.nif_error(:nif_not_loaded)
+  def select_decode_stats(), do: :erlang.nif_error(:nif_not_loaded)
+  def select_decode_stats_reset(), do: :erlang.nif_error(:nif_not_loaded)
+  def native_decode(_data, _as_columns), do: :erlang.nif_error(:nif_not_loaded)
+  def client_select_native(_client, _sql, _opts), do: :erlang.nif_error(:nif_not_loaded)
+
+  def client_select_native_parameterized(_client, _query, _opts),
+    do: :erlang.nif_error(:nif_not_loaded)
+
+  # SIMD kernel dispatch
+  def cpu_level(), do: :erlang.nif_error(:nif_not_loaded)
+  def cpu_level_set(_level), do: :erlang.nif_error(:nif_not_loaded)
+
+  # Query cancellation (used by Natch.Hedge)
+  def cancel_token_create(_ref), do: :erlang.nif_error(:nif_not_loaded)
+  def cancel_token_cancel(_token), do: :erlang.nif_error(:nif_not_loaded)
 
   # Phase 6C - Parameterized Query NIFs
   def query_create(_sql), do: :erlang.nif_error(:nif_not_loaded)
@@ -130,6 +162,40 @@ defmodule Natch.Native do
 
   # Parameterized query execution
   def client_execute_parameterized(_client, _query), do: :erlang.nif_error(:nif_not_loaded)
-  def client_select_parameterized(_client, _query), do: :erlang.nif_error(:nif_not_loaded)
-  def client_select_cols_parameterized(_client, _query), do: :erlang.nif_error(:nif_not_loaded)
+  def client_select_parameterized(_client, _query, _opts), do: :erlang.nif_error(:nif_not_loaded)
+  def client_select_cols_parameterized(_client, _query, _opts),
+    do: :erlang.nif_error(:nif_not_loaded)
+
+  # Insert spool (used by Natch.Spool)
+  def spool_open(
+        _path,
+        _host,
+        _port,
+        _database,
+        _user,
+        _password,
+        _compression,
+        _ssl,
+        _connect_timeout,
+        _recv_timeout,
+        _send_timeout,
+        _capacity,
+        _batch_bytes,
+        _linger_ms,
+        _sync
+      ),
+      do: :erlang.nif_error(:nif_not_loaded)
+
+  def spool_append(_spool, _table, _block), do: :erlang.nif_error(:nif_not_loaded)
+  def spool_stats(_spool), do: :erlang.nif_error(:nif_not_loaded)
+  def spool_close(_spool), do: :erlang.nif_error(:nif_not_loaded)
+
+  # Insert deduplication (used by Natch.Dedup)
+  def dedup_create(_capacity, _false_positive_rate, _window_ms, _max_bytes),
+    do: :erlang.nif_error(:nif_not_loaded)
+
+  def dedup_check(_dedup, _keys, _columns, _in_flight), do: :erlang.nif_error(:nif_not_loaded)
+  def dedup_commit(_dedup, _pending), do: :erlang.nif_error(:nif_not_loaded)
+  def dedup_stats(_dedup), do: :erlang.nif_error(:nif_not_loaded)
+  def dedup_reset(_dedup), do: :erlang.nif_error(:nif_not_loaded)
 end
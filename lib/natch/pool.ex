@@ -0,0 +1,647 @@
+defmodule Natch.Pool do
+  @moduledoc """
+  Connection pool with a priority- and tenant-aware admission scheduler.
+
+  The pool owns a fixed set of `Natch.Connection`s. Callers check one out
+  for the length of a query; when none is free they queue, and the scheduler
+  decides who gets the next connection:
+
+    * **Priority classes** share connections by weighted fair queuing. With
+      the default weights `interactive: 8, default: 4, background: 1`,
+      interactive queries get 8 connections for every background one while
+      both are waiting, and background work still makes progress.
+    * **Tenants** within a class are served round-robin, so one tenant's
+      burst doesn't queue everyone else behind it.
+    * **Per-tenant caps** bound how many connections a single tenant can
+      hold at once, across all classes.
+    * **Adaptive concurrency** (opt-in) lowers the number of queries in
+      flight when the server reports overload or latency climbs, and raises
+      it again as queries complete quickly. Excess callers queue, and with
+      `:max_queue` set, are shed immediately once the queue is full.
+
+  ## Examples
+
+      {:ok, pool} =
+        Natch.Pool.start_link(
+          size: 8,
+          connection: [host: "localhost", port: 9000],
+          tenant_limit: 4
+        )
+
+      {:ok, rows} =
+        Natch.Pool.select_rows(pool, "SELECT * FROM events WHERE id = {id}", [id: 1],
+          priority: :interactive,
+          tenant: "acme"
+        )
+
+      Natch.Pool.run(pool, fn conn -> Natch.execute(conn, "OPTIMIZE TABLE events") end,
+        priority: :background
+      )
+
+      Natch.Pool.metrics(pool)
+
+  ## Sessions
+
+  A query checks a connection out only for its own duration, so work that
+  depends on connection state — temporary tables, `SET` settings — needs a
+  session: one connection pinned for a sequence of operations. Calls inside
+  a session go straight to that connection, without passing through the
+  pool. When the session ends, the connection is reset in the background
+  (dropping its temporary tables and settings) before anyone else gets it.
+
+      Natch.Pool.session(pool, fn conn ->
+        :ok = Natch.execute(conn, "CREATE TEMPORARY TABLE ids (id UInt64)")
+        :ok = Natch.insert_cols(conn, "ids", %{id: ids}, id: :uint64)
+        Natch.select_rows(conn, "SELECT * FROM events WHERE id IN (SELECT id FROM ids)")
+      end)
+
+  `checkout/2` and `checkin/1` do the same without a closure, and
+  `transfer/2` hands a session to another process.
+
+  ## Pool options
+
+    * `:size` - Number of connections (default: `4`)
+    * `:connection` - Options passed to `Natch.start_link/1` for each connection
+    * `:classes` - Keyword list of priority class weights
+      (default: `[interactive: 8, default: 4, background: 1]`)
+    * `:tenant_limit` - Connections any one tenant may hold (default: `:infinity`)
+    * `:tenant_limits` - Map of per-tenant overrides of `:tenant_limit`
+    * `:adaptive` - `true` or a keyword list to adapt the in-flight limit
+      between `:min` and `:size` (AIMD, default: `false`). Options:
+      `:min` (default `1`), `:initial` (default `:size`), `:backoff`
+      multiplier on overload (default `0.9`), `:tolerance` - latency spike
+      factor over the long-term average (default `2.0`), and
+      `:overload_codes` - server error codes that signal overload
+      (default `[202]`, TOO_MANY_SIMULTANEOUS_QUERIES)
+    * `:max_queue` - Callers allowed to wait; further checkouts return
+      `{:error, :overloaded}` at once (default: `:infinity`)
+    * `:name` - Optional name to register the pool under
+
+  ## Checkout options
+
+    * `:priority` - Priority class (default: `:default`)
+    * `:tenant` - Tenant identifier, any term (default: `nil`)
+    * `:queue_timeout` - Milliseconds to wait for a connection before
+      returning `{:error, :queue_timeout}` (default: `15_000`)
+  """
+
+  use GenServer
+
+  alias Natch.Pool.{Limiter, Session}
+
+  @default_classes [interactive: 8, default: 4, background: 1]
+  @checkout_keys [:priority, :tenant, :queue_timeout]
+  @wait_samples 512
+
+  @type pool :: GenServer.server()
+
+  @doc """
+  Starts a pool and its connections.
+  """
+  @spec start_link(keyword()) :: GenServer.on_start()
+  def start_link(opts \\ []) do
+    {gen_opts, opts} = Keyword.split(opts, [:name])
+    GenServer.start_link(__MODULE__, opts, gen_opts)
+  end
+
+  @doc """
+  Checks out a connection, runs `fun` with it and checks it back in.
+
+  Returns whatever `fun` returns, `{:error, :queue_timeout}` if no
+  connection became available in time, or `{:error, :overloaded}` if the
+  queue is full.
+
+  With `:adaptive` enabled, `fun`'s result and duration feed the limiter:
+  `{:error, _}` results carrying an overload code lower the limit.
+  """
+  @spec run(pool(), (Natch.conn() -> result), keyword()) ::
+          result | {:error, :queue_timeout | :overloaded}
+        when result: term()
+  def run(pool, fun, opts \\ []) when is_function(fun, 1) do
+    opts = Keyword.validate!(opts, priority: :default, tenant: nil, queue_timeout: 15_000)
+
+    checkout = {:checkout, opts[:priority], opts[:tenant], opts[:queue_timeout], :query}
+
+    case GenServer.call(pool, checkout, :infinity) do
+      {:ok, conn, lease} ->
+        started = System.monotonic_time()
+
+        try do
+          result = fun.(conn)
+          checkin(pool, lease, outcome(result), started)
+          result
+        catch
+          kind, reason ->
+            checkin(pool, lease, :error, started)
+            :erlang.raise(kind, reason, __STACKTRACE__)
+        end
+
+      {:error, _} = error ->
+        error
+    end
+  end
+
+  @doc """
+  Runs `Natch.select_rows/4` on a pooled connection.
+
+  Accepts checkout options alongside the select options.
+  """
+  @spec select_rows(pool(), String.t(), keyword() | map(), keyword()) ::
+          {:ok, [Natch.row()]} | {:error, term()}
+  def select_rows(pool, sql, params \\ [], opts \\ []) do
+    {checkout_opts, select_opts} = Keyword.split(opts, @checkout_keys)
+    run(pool, &Natch.select_rows(&1, sql, params, select_opts), checkout_opts)
+  end
+
+  @doc """
+  Runs `Natch.select_cols/4` on a pooled connection.
+
+  Accepts checkout options alongside the select options.
+  """
+  @spec select_cols(pool(), String.t(), keyword() | map(), keyword()) ::
+          {:ok, map()} | {:error, term()}
+  def select_cols(pool, sql, params \\ [], opts \\ []) do
+    {checkout_opts, select_opts} = Keyword.split(opts, @checkout_keys)
+    run(pool, &Natch.select_cols(&1, sql, params, select_opts), checkout_opts)
+  end
+
+  @doc """
+  Runs `Natch.execute/3` on a pooled connection.
+  """
+  @spec execute(pool(), String.t(), keyword() | map(), keyword()) :: :ok | {:error, term()}
+  def execute(pool, sql, params \\ [], opts \\ []) do
+    run(pool, &Natch.execute(&1, sql, params), opts)
+  end
+
+  @doc """
+  Returns scheduler metrics.
+
+    * `:size`, `:idle`, `:busy` - connection counts
+    * `:queue_depth` - waiting callers per priority class
+    * `:running` - connections held per tenant
+    * `:wait_ms` - per priority class: `:count`, `:mean`, `:max` and `:p99`
+      of queue wait times (percentiles over the last #{@wait_samples} waits)
+    * `:queue_timeouts` - callers that gave up waiting
+    * `:limit` - current in-flight limit (`:size` unless `:adaptive`)
+    * `:limit_decreases` - times the adaptive limit was cut
+    * `:shed` - checkouts rejected because the queue was full
+    * `:sessions` - connections held by sessions
+    * `:resetting` - connections being reset after a session
+  """
+  @spec metrics(pool()) :: map()
+  def metrics(pool) do
+    GenServer.call(pool, :metrics)
+  end
+
+  @doc """
+  Runs `fun` in a session: one connection pinned for all of `fun`'s calls.
+
+  Takes the checkout options of `run/3`. The connection is reset after
+  `fun` returns or raises, so temporary tables and settings never leak
+  to the next caller. Sessions bypass the adaptive limiter's latency
+  tracking, since their duration is not a query's, and do not count against
+  the in-flight limit, so long-lived sessions cannot starve queued queries.
+  """
+  @spec session(pool(), (Natch.conn() -> result), keyword()) ::
+          result | {:error, :queue_timeout | :overloaded}
+        when result: term()
+  def session(pool, fun, opts \\ []) when is_function(fun, 1) do
+    case checkout(pool, opts) do
+      {:ok, session} ->
+        try do
+          fun.(session.conn)
+        after
+          checkin(session)
+        end
+
+      {:error, _} = error ->
+        error
+    end
+  end
+
+  @doc """
+  Checks out a session for the calling process.
+
+  Use `session.conn` with any `Natch` function and end the session with
+  `checkin/1`. If the owning process exits first, the pool reclaims and
+  resets the connection.
+  """
+  @spec checkout(pool(), keyword()) ::
+          {:ok, Session.t()} | {:error, :queue_timeout | :overloaded | term()}
+  def checkout(pool, opts \\ []) do
+    opts = Keyword.validate!(opts, priority: :default, tenant: nil, queue_timeout: 15_000)
+    checkout = {:checkout, opts[:priority], opts[:tenant], opts[:queue_timeout], :session}
+
+    case GenServer.call(pool, checkout, :infinity) do
+      {:ok, conn, lease} -> {:ok, %Session{pool: pool, conn: conn, lease: lease}}
+      {:error, _} = error -> error
+    end
+  end
+
+  @doc """
+  Ends a session. The connection returns to the pool once it is reset.
+  """
+  @spec checkin(Session.t()) :: :ok
+  def checkin(%Session{pool: pool, lease: lease}) do
+    GenServer.cast(pool, {:checkin, lease, :session, 0})
+  end
+
+  @doc """
+  Hands a session to `pid`, which becomes its owner.
+
+  Returns the session to pass to `pid`; the old handle must not be
+  checked in.
+  """
+  @spec transfer(Session.t(), pid()) :: {:ok, Session.t()} | {:error, :not_found}
+  def transfer(%Session{pool: pool, lease: lease} = session, pid) when is_pid(pid) do
+    case GenServer.call(pool, {:transfer, lease, pid}) do
+      {:ok, new_lease} -> {:ok, %{session | lease: new_lease}}
+      error -> error
+    end
+  end
+
+  # GenServer callbacks
+
+  @impl true
+  def init(opts) do
+    opts =
+      Keyword.validate!(opts,
+        size: 4,
+        connection: [],
+        classes: @default_classes,
+        tenant_limit: :infinity,
+        tenant_limits: %{},
+        adaptive: false,
+        max_queue: :infinity
+      )
+
+    conns =
+      for _ <- 1..opts[:size] do
+        {:ok, conn} = Natch.Connection.start_link(opts[:connection])
+        conn
+      end
+
+    classes = Map.new(opts[:classes])
+
+    state = %{
+      size: opts[:size],
+      idle: conns,
+      leases: %{},
+      running: %{},
+      classes: classes,
+      tenant_limit: opts[:tenant_limit],
+      tenant_limits: opts[:tenant_limits],
+      queues: Map.new(classes, fn {class, _} -> {class, empty_class_queue()} end),
+      waiters: %{},
+      finish: Map.new(classes, fn {class, _} -> {class, 0.0} end),
+      vtime: 0.0,
+      waits: Map.new(classes, fn {class, _} -> {class, empty_wait_stats()} end),
+      queue_timeouts: 0,
+      limiter: build_limiter(opts[:adaptive], opts[:size]),
+      max_queue: opts[:max_queue],
+      shed: 0,
+      sessions: 0,
+      resetting: 0
+    }
+
+    {:ok, state}
+  end
+
+  @impl true
+  def handle_call({:checkout, class, tenant, timeout, kind}, from, state) do
+    cond do
+      not Map.has_key?(state.classes, class) ->
+        {:reply, {:error, {:unknown_priority, class}}, state}
+
+      queue_full?(state) ->
+        {:reply, {:error, :overloaded}, %{state | shed: state.shed + 1}}
+
+      true ->
+        checkout(class, tenant, timeout, kind, from, state)
+    end
+  end
+
+  def handle_call({:transfer, lease, pid}, _from, state) do
+    case Map.pop(state.leases, lease) do
+      {nil, _} ->
+        {:reply, {:error, :not_found}, state}
+
+      {held, leases} ->
+        Process.demonitor(lease, [:flush])
+        new_lease = Process.monitor(pid)
+        {:reply, {:ok, new_lease}, %{state | leases: Map.put(leases, new_lease, held)}}
+    end
+  end
+
+  def handle_call(:metrics, _from, state) do
+    {:reply, build_metrics(state), state}
+  end
+
+  @impl true
+  def handle_cast({:checkin, lease, outcome, rtt}, state) do
+    state =
+      case state do
+        %{limiter: nil} ->
+          state
+
+        _session when outcome == :session ->
+          state
+
+        %{limiter: limiter} ->
+          %{state | limiter: Limiter.update(limiter, outcome, rtt, queries_in_flight(state))}
+      end
+
+    {:noreply, state |> release(lease) |> dispatch()}
+  end
+
+  @impl true
+  def handle_info({:queue_timeout, id}, state) do
+    case Map.pop(state.waiters, id) do
+      {nil, _} ->
+        {:noreply, state}
+
+      {{class, tenant}, waiters} ->
+        {waiter, state} = remove_waiter(%{state | waiters: waiters}, class, tenant, id)
+        GenServer.reply(waiter.from, {:error, :queue_timeout})
+        {:noreply, %{state | queue_timeouts: state.queue_timeouts + 1}}
+    end
+  end
+
+  # The caller died holding a connection
+  def handle_info({:DOWN, monitor, :process, _pid, _reason}, state) do
+    {:noreply, state |> release(monitor) |> dispatch()}
+  end
+
+  def handle_info({:session_reset, conn}, state) do
+    state = %{state | idle: [conn | state.idle], resetting: state.resetting - 1}
+    {:noreply, dispatch(state)}
+  end
+
+  # Private functions
+
+  defp checkout(class, tenant, timeout, kind, {pid, _} = from, state) do
+    id = make_ref()
+    waiter = %{id: id, from: from, pid: pid, kind: kind, enqueued_at: System.monotonic_time()}
+    timer = Process.send_after(self(), {:queue_timeout, id}, timeout)
+
+    state =
+      state
+      |> enqueue(class, tenant, Map.put(waiter, :timer, timer))
+      |> dispatch()
+
+    {:noreply, state}
+  end
+
+  defp checkin(pool, lease, outcome, started) do
+    rtt = System.convert_time_unit(System.monotonic_time() - started, :native, :microsecond)
+    GenServer.cast(pool, {:checkin, lease, outcome, rtt})
+  end
+
+  defp outcome({:error, %{type: "server", details: %{"code" => code}}}), do: {:server_error, code}
+  defp outcome({:error, _}), do: :error
+  defp outcome(_), do: :ok
+
+  defp build_limiter(false, _size), do: nil
+  defp build_limiter(true, size), do: Limiter.new(size, [])
+  defp build_limiter(opts, size) when is_list(opts), do: Limiter.new(size, opts)
+
+  defp queue_full?(%{max_queue: :infinity}), do: false
+  defp queue_full?(state), do: map_size(state.waiters) >= state.max_queue
+
+  defp in_flight_limit(%{limiter: nil, size: size}), do: size
+  defp in_flight_limit(%{limiter: limiter}), do: Limiter.limit(limiter)
+
+  defp empty_class_queue, do: %{tenants: :queue.new(), by_tenant: %{}, depth: 0}
+
+  defp empty_wait_stats, do: %{count: 0, total: 0, max: 0, samples: :queue.new(), sampled: 0}
+
+  defp enqueue(state, class, tenant, waiter) do
+    update_in(state.queues[class], fn queue ->
+      {tenants, by_tenant} =
+        case queue.by_tenant do
+          %{^tenant => waiting} ->
+            {queue.tenants, Map.put(queue.by_tenant, tenant, :queue.in(waiter, waiting))}
+
+          _ ->
+            {:queue.in(tenant, queue.tenants),
+             Map.put(queue.by_tenant, tenant, :queue.in(waiter, :queue.new()))}
+        end
+
+      %{queue | tenants: tenants, by_tenant: by_tenant, depth: queue.depth + 1}
+    end)
+    |> put_in([:waiters, waiter.id], {class, tenant})
+  end
+
+  defp remove_waiter(state, class, tenant, id) do
+    queue = state.queues[class]
+    waiting = Map.fetch!(queue.by_tenant, tenant)
+    {[waiter], rest} = waiting |> :queue.to_list() |> Enum.split_with(&(&1.id == id))
+    queue = put_tenant_queue(queue, tenant, :queue.from_list(rest))
+    {waiter, put_in(state.queues[class], %{queue | depth: queue.depth - 1})}
+  end
+
+  defp put_tenant_queue(queue, tenant, waiting) do
+    if :queue.is_empty(waiting) do
+      %{
+        queue
+        | by_tenant: Map.delete(queue.by_tenant, tenant),
+          tenants: :queue.delete(tenant, queue.tenants)
+      }
+    else
+      %{queue | by_tenant: Map.put(queue.by_tenant, tenant, waiting)}
+    end
+  end
+
+  # Hand idle connections to waiters until either runs out or the in-flight
+  # limit is reached. Sessions hold their connection for as long as their
+  # owner likes, so only query leases count against the limit.
+  defp dispatch(%{idle: []} = state), do: state
+
+  defp dispatch(state) do
+    if queries_in_flight(state) >= in_flight_limit(state) do
+      state
+    else
+      dispatch_next(state)
+    end
+  end
+
+  defp queries_in_flight(state), do: map_size(state.leases) - state.sessions
+
+  defp dispatch_next(state) do
+    case pick_class(state) do
+      nil ->
+        state
+
+      {class, start_tag, finish_tag, tenant} ->
+        state = %{state | vtime: start_tag, finish: Map.put(state.finish, class, finish_tag)}
+
+        state
+        |> grant(class, tenant)
+        |> dispatch()
+    end
+  end
+
+  # Start-time fair queuing across classes: each class's next request is
+  # tagged S = max(V, F_class), F = S + 1/weight; the smallest F among
+  # classes with an admissible tenant goes next
+  defp pick_class(state) do
+    state.classes
+    |> Enum.flat_map(fn {class, weight} ->
+      case next_tenant(state, class) do
+        nil ->
+          []
+
+        tenant ->
+          start_tag = max(state.vtime, state.finish[class])
+          [{class, start_tag, start_tag + 1 / weight, tenant}]
+      end
+    end)
+    |> Enum.min_by(fn {_class, _start, finish, _tenant} -> finish end, &<=/2, fn -> nil end)
+  end
+
+  # First tenant in round-robin order that is under its cap
+  defp next_tenant(state, class) do
+    state.queues[class].tenants
+    |> :queue.to_list()
+    |> Enum.find(&under_limit?(state, &1))
+  end
+
+  defp under_limit?(state, tenant) do
+    case Map.get(state.tenant_limits, tenant, state.tenant_limit) do
+      :infinity -> true
+      limit -> Map.get(state.running, tenant, 0) < limit
+    end
+  end
+
+  defp grant(state, class, tenant) do
+    queue = state.queues[class]
+    {{:value, waiter}, waiting} = :queue.out(Map.fetch!(queue.by_tenant, tenant))
+
+    # Served tenants go to the back of the rotation
+    queue = put_tenant_queue(queue, tenant, waiting)
+
+    queue =
+      if Map.has_key?(queue.by_tenant, tenant) do
+        %{queue | tenants: :queue.in(tenant, :queue.delete(tenant, queue.tenants))}
+      else
+        queue
+      end
+
+    state = %{
+      state
+      | queues: Map.put(state.queues, class, %{queue | depth: queue.depth - 1}),
+        waiters: Map.delete(state.waiters, waiter.id)
+    }
+
+    Process.cancel_timer(waiter.timer)
+
+    if Process.alive?(waiter.pid) do
+      [conn | idle] = state.idle
+      monitor = Process.monitor(waiter.pid)
+      GenServer.reply(waiter.from, {:ok, conn, monitor})
+
+      %{
+        state
+        | idle: idle,
+          leases: Map.put(state.leases, monitor, {conn, tenant, waiter.kind}),
+          running: Map.update(state.running, tenant, 1, &(&1 + 1)),
+          sessions: state.sessions + if(waiter.kind == :session, do: 1, else: 0),
+          waits: Map.update!(state.waits, class, &record_wait(&1, waiter.enqueued_at))
+      }
+    else
+      state
+    end
+  end
+
+  defp release(state, lease) do
+    case Map.pop(state.leases, lease) do
+      {nil, _} ->
+        state
+
+      {{conn, tenant, kind}, leases} ->
+        Process.demonitor(lease, [:flush])
+
+        running =
+          case Map.fetch!(state.running, tenant) do
+            1 -> Map.delete(state.running, tenant)
+            n -> Map.put(state.running, tenant, n - 1)
+          end
+
+        state = %{state | leases: leases, running: running}
+
+        case kind do
+          :query -> %{state | idle: [conn | state.idle]}
+          :session -> reset_session(%{state | sessions: state.sessions - 1}, conn)
+        end
+    end
+  end
+
+  # Drop the session's temporary tables and settings off the pool process;
+  # the connection rejoins the idle list once the reset is done
+  defp reset_session(state, conn) do
+    pool = self()
+
+    spawn(fn ->
+      try do
+        Natch.Connection.reset(conn)
+      catch
+        :exit, _ -> :ok
+      end
+
+      send(pool, {:session_reset, conn})
+    end)
+
+    %{state | resetting: state.resetting + 1}
+  end
+
+  defp record_wait(stats, enqueued_at) do
+    wait = System.convert_time_unit(System.monotonic_time() - enqueued_at, :native, :microsecond)
+
+    {samples, sampled} =
+      if stats.sampled < @wait_samples do
+        {:queue.in(wait, stats.samples), stats.sampled + 1}
+      else
+        {:queue.in(wait, :queue.drop(stats.samples)), stats.sampled}
+      end
+
+    %{
+      stats
+      | count: stats.count + 1,
+        total: stats.total + wait,
+        max: max(stats.max, wait),
+        samples: samples,
+        sampled: sampled
+    }
+  end
+
+  defp build_metrics(state) do
+    %{
+      size: state.size,
+      idle: length(state.idle),
+      busy: map_size(state.leases),
+      queue_depth: Map.new(state.queues, fn {class, queue} -> {class, queue.depth} end),
+      running: state.running,
+      wait_ms: Map.new(state.waits, fn {class, stats} -> {class, wait_summary(stats)} end),
+      queue_timeouts: state.queue_timeouts,
+      limit: in_flight_limit(state),
+      limit_decreases: if(state.limiter, do: state.limiter.decreases, else: 0),
+      shed: state.shed,
+      sessions: state.sessions,
+      resetting: state.resetting
+    }
+  end
+
+  defp wait_summary(%{count: 0}), do: %{count: 0, mean: 0.0, max: 0.0, p99: 0.0}
+
+  defp wait_summary(stats) do
+    sorted = stats.samples |> :queue.to_list() |> Enum.sort()
+    p99 = Enum.at(sorted, ceil(length(sorted) * 0.99) - 1)
+
+    %{
+      count: stats.count,
+      mean: stats.total / stats.count / 1000,
+      max: stats.max / 1000,
+      p99: p99 / 1000
+    }
+  end
+end
@@ -0,0 +1,115 @@
+defmodule Natch.Pool.Limiter do
+  @moduledoc false
+  # Adaptive in-flight query limit for Natch.Pool (AIMD).
+  #
+  # Every completed query reports its outcome and round-trip time:
+  #
+  #   * An overload error from the server (TOO_MANY_SIMULTANEOUS_QUERIES by
+  #     default) or a latency spike cuts the limit multiplicatively.
+  #   * A success while the limit was the bottleneck raises it by 1/limit,
+  #     i.e. about one more query in flight per limit's worth of completions.
+  #
+  # A latency spike is a short-term EWMA of round-trip times exceeding
+  # `tolerance` times the long-term EWMA. After a cut, further cuts wait
+  # until about a limit's worth of queries has completed: the queries
+  # already in flight were admitted under the old limit, so their errors
+  # and latencies say nothing about the new one.
+
+  @short_alpha 0.2
+  @long_alpha 0.02
+  @warmup_samples 10
+
+  defstruct [
+    :limit,
+    :min,
+    :max,
+    :backoff,
+    :tolerance,
+    :overload_codes,
+    short_rtt: nil,
+    long_rtt: nil,
+    samples: 0,
+    decreases: 0,
+    cooldown: 0
+  ]
+
+  @type t :: %__MODULE__{}
+  @type outcome :: :ok | {:server_error, integer()} | :error
+
+  @spec new(pos_integer(), keyword()) :: t()
+  def new(max, opts) do
+    opts =
+      Keyword.validate!(opts,
+        min: 1,
+        max: max,
+        initial: max,
+        backoff: 0.9,
+        tolerance: 2.0,
+        overload_codes: [202]
+      )
+
+    %__MODULE__{
+      limit: opts[:initial] / 1,
+      min: opts[:min],
+      max: min(opts[:max], max),
+      backoff: opts[:backoff],
+      tolerance: opts[:tolerance],
+      overload_codes: opts[:overload_codes]
+    }
+  end
+
+  # Current whole-query limit
+  @spec limit(t()) :: pos_integer()
+  def limit(%__MODULE__{limit: limit, min: min}), do: max(min, trunc(limit))
+
+  # Feed one completed query: its outcome, round-trip time and how many
+  # queries were in flight when it finished (itself included)
+  @spec update(t(), outcome(), non_neg_integer(), non_neg_integer()) :: t()
+  def update(limiter, {:server_error, code}, _rtt_us, _in_flight) do
+    if code in limiter.overload_codes, do: decrease(limiter), else: tick(limiter)
+  end
+
+  def update(limiter, :error, _rtt_us, _in_flight), do: tick(limiter)
+
+  def update(limiter, :ok, rtt_us, in_flight) do
+    limiter = observe(limiter, rtt_us)
+
+    cond do
+      limiter.samples >= @warmup_samples and
+          limiter.short_rtt > limiter.tolerance * limiter.long_rtt ->
+        decrease(limiter)
+
+      in_flight >= limit(limiter) ->
+        limit = min(limiter.max / 1, limiter.limit + 1 / limiter.limit)
+        tick(%{limiter | limit: limit})
+
+      true ->
+        tick(limiter)
+    end
+  end
+
+  defp observe(%{samples: 0} = limiter, rtt_us) do
+    %{limiter | short_rtt: rtt_us / 1, long_rtt: rtt_us / 1, samples: 1}
+  end
+
+  defp observe(limiter, rtt_us) do
+    %{
+      limiter
+      | short_rtt: ewma(limiter.short_rtt, rtt_us, @short_alpha),
+        long_rtt: ewma(limiter.long_rtt, rtt_us, @long_alpha),
+        samples: limiter.samples + 1
+    }
+  end
+
+  defp ewma(average, sample, alpha), do: alpha * sample + (1 - alpha) * average
+
+  defp decrease(%{cooldown: cooldown} = limiter) when cooldown > 0, do: tick(limiter)
+
+  defp decrease(limiter) do
+    limit = max(limiter.min / 1, limiter.limit * limiter.backoff)
+    %{limiter | limit: limit, decreases: limiter.decreases + 1, cooldown: trunc(limit)}
+  end
+
+  defp tick(%{cooldown: 0} = limiter), do: limiter
+  defp tick(limiter), do: %{limiter | cooldown: limiter.cooldown - 1}
+end
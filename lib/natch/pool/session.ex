@@ -0,0 +1,12 @@
+defmodule Natch.Pool.Session do
+  @moduledoc """
+  A pooled connection pinned to one owner, see `Natch.Pool.checkout/2`.
+
+  Pass `conn` to any `Natch` function.
+  """
+
+  @enforce_keys [:pool, :conn, :lease]
+  defstruct [:pool, :conn, :lease]
+
+  @type t :: %__MODULE__{pool: Natch.Pool.pool(), conn: Natch.conn(), lease: reference()}
+end
@@ -0,0 +1,139 @@
+defmodule Natch.Spool do
+  @moduledoc """
+  Durable local insert spool for fire-and-forget ingest.
+
+  A spool is a memory-mapped, append-only file. `insert/4` builds the block,
+  writes it to the spool in ClickHouse's Native format and returns as soon as
+  it is in the mapping, without waiting for the server. A native background
+  thread drains the spool to ClickHouse: consecutive blocks for the same table
+  are merged into one INSERT, and while the server is unreachable it retries
+  with backoff (100ms up to 10s) instead of buffering in memory.
+
+  Blocks that are not yet acknowledged survive a crash or restart of the VM:
+  opening the same path again replays them. Delivery is at-least-once — a
+  batch inserted just before a crash may be sent again — so pair the spool
+  with a deduplicating table engine when duplicates matter.
+
+  Errors that retrying cannot fix (unknown table, type mismatch) drop the
+  affected blocks; `stats/1` counts them in `:rejected_records` and keeps the
+  last error. When such an error hits a merged batch, its blocks are sent
+  again one at a time, so only the blocks that fail on their own are dropped.
+
+  ## Examples
+
+      {:ok, spool} = Natch.Spool.open("/var/lib/myapp/events.spool", host: "localhost")
+
+      :ok = Natch.Spool.insert(spool, "events", %{id: [1, 2], name: ["a", "b"]},
+        id: :uint64,
+        name: :string
+      )
+
+      :ok = Natch.Spool.flush(spool)
+      Natch.Spool.stats(spool)
+      # => %{pending_bytes: 0, appended_records: 1, drained_records: 1, ...}
+
+  ## Options
+
+    * `:capacity` - Size of the spool in bytes, fixed when the file is
+      created (default: 256 MiB). `insert/4` returns `{:error, :spool_full}`
+      once undrained blocks fill it.
+    * `:batch_bytes` - Upper bound on the serialized size of one drained
+      batch (default: 8 MiB)
+    * `:linger` - Milliseconds the drain thread waits for more blocks before
+      sending a batch smaller than `:batch_bytes` (default: `50`)
+    * `:sync` - `msync` every append, so acknowledged blocks also survive a
+      power loss, at the cost of a disk flush per insert (default: `false`)
+
+  All other options are connection options, as for `Natch.start_link/1`.
+  """
+
+  alias Natch.Native
+
+  @spool_keys [capacity: 256 * 1024 * 1024, batch_bytes: 8 * 1024 * 1024, linger: 50, sync: false]
+
+  @type t :: reference()
+
+  @doc """
+  Opens the spool at `path`, creating it if needed, and starts draining it.
+
+  The server does not need to be reachable: blocks are kept until it is.
+  A spool file can be open only once at a time.
+  """
+  @spec open(Path.t(), keyword()) :: {:ok, t()}
+  def open(path, opts \\ []) do
+    {spool_opts, conn_opts} = Keyword.split(opts, Keyword.keys(@spool_keys))
+    spool_opts = Keyword.merge(@spool_keys, spool_opts)
+
+    args =
+      [to_string(path) | Natch.Connection.client_args(conn_opts)] ++
+        [spool_opts[:capacity], spool_opts[:batch_bytes], spool_opts[:linger], spool_opts[:sync]]
+
+    try do
+      {:ok, apply(Native, :spool_open, args)}
+    rescue
+      e -> Natch.Error.handle_nif_error(e)
+    end
+  end
+
+  @doc """
+  Writes a block of columnar data for `table` to the spool.
+
+  Takes the same `columns` and `schema` as `Natch.insert_cols/5`. Returns
+  once the block is in the spool; it reaches ClickHouse in the background.
+  """
+  @spec insert(t(), String.t(), map(), Natch.schema()) :: :ok | {:error, term()}
+  def insert(spool, table, columns, schema) when is_map(columns) and is_list(schema) do
+    block = Natch.Block.build_block(columns, schema)
+
+    case Native.spool_append(spool, table, block) do
+      :ok -> :ok
+      :spool_full -> {:error, :spool_full}
+    end
+  rescue
+    e -> Natch.Error.handle_callback_error(e)
+  end
+
+  @doc """
+  Waits until every block in the spool has been drained.
+
+  Returns `{:error, :timeout}` if blocks are still pending after `timeout`
+  milliseconds, for example while the server is down.
+  """
+  @spec flush(t(), non_neg_integer()) :: :ok | {:error, :timeout}
+  def flush(spool, timeout \\ 5_000) do
+    deadline = System.monotonic_time(:millisecond) + timeout
+    await_drained(spool, deadline)
+  end
+
+  @doc """
+  Returns spool counters: capacity and pending bytes, records appended,
+  drained, rejected and recovered at open, drained batches, retries and
+  the last error (or `nil`).
+  """
+  @spec stats(t()) :: map()
+  def stats(spool), do: Native.spool_stats(spool)
+
+  @doc """
+  Stops draining. Pending blocks stay in the file for the next `open/2`.
+
+  Waits for an INSERT in progress to finish. A spool that is garbage
+  collected without `close/1` stops without waiting, and the file stays
+  locked until an INSERT in progress ends.
+  """
+  @spec close(t()) :: :ok
+  def close(spool), do: Native.spool_close(spool)
+
+  defp await_drained(spool, deadline) do
+    cond do
+      stats(spool).pending_bytes == 0 ->
+        :ok
+
+      System.monotonic_time(:millisecond) >= deadline ->
+        {:error, :timeout}
+
+      true ->
+        Process.sleep(10)
+        await_drained(spool, deadline)
+    end
+  end
+end
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <fine.hpp>
+
+// Atoms shared across NIFs. Declared static so FINE interns them once at
+// NIF load; fine::encode on these returns the cached term.
+namespace atoms {
+
+// Struct tags
+static auto struct_key = fine::Atom("__struct__");
+static auto calendar = fine::Atom("calendar");
+static auto ElixirCalendarISO = fine::Atom("Elixir.Calendar.ISO");
+static auto ElixirDate = fine::Atom("Elixir.Date");
+static auto ElixirDateTime = fine::Atom("Elixir.DateTime");
+static auto ElixirNaiveDateTime = fine::Atom("Elixir.NaiveDateTime");
+static auto ElixirDecimal = fine::Atom("Elixir.Decimal");
+
+// Date/DateTime/NaiveDateTime fields
+static auto year = fine::Atom("year");
+static auto month = fine::Atom("month");
+static auto day = fine::Atom("day");
+static auto hour = fine::Atom("hour");
+static auto minute = fine::Atom("minute");
+static auto second = fine::Atom("second");
+static auto microsecond = fine::Atom("microsecond");
+static auto utc_offset = fine::Atom("utc_offset");
+static auto std_offset = fine::Atom("std_offset");
+
+// Literals
+static auto nil = fine::Atom("nil");
+static auto true_ = fine::Atom("true");
+static auto false_ = fine::Atom("false");
+
+// Decimal fields
+static auto sign = fine::Atom("sign");
+static auto coef = fine::Atom("coef");
+static auto exp = fine::Atom("exp");
+
+// SELECT options
+static auto intern_strings = fine::Atom("intern_strings");
+static auto intern_threshold = fine::Atom("intern_threshold");
+static auto decode_stats = fine::Atom("decode_stats");
+static auto cancel_token = fine::Atom("cancel_token");
+static auto filter = fine::Atom("filter");
+static auto sample = fine::Atom("sample");
+
+// Decode stats fields
+static auto values = fine::Atom("values");
+static auto nanoseconds = fine::Atom("nanoseconds");
+static auto binary_bytes = fine::Atom("binary_bytes");
+
+}  // namespace atoms
@@ -1,10 +1,14 @@
 #include <fine.hpp>
 #include <clickhouse/client.h>
 #include <clickhouse/block.h>
+#include <cstring>
 #include <string>
+#include <vector>
 #include <memory>
 #include <stdexcept>
 #include "error_encoding.h"
+#include "native_format.h"
+#include "probes.h"
 
 using namespace clickhouse;
 
@@ -71,6 +75,24 @@ uint64_t block_column_count(
 }
 FINE_NIF(block_column_count, 0);
 
+// Serialize the block in Native format (see native_format.h)
+fine::Term block_to_native(
+    ErlNifEnv *env,
+    fine::ResourcePtr<BlockResource> block_res) {
+  try {
+    Buffer buffer;
+    write_native_block(*block_res->ptr, &buffer);
+
+    ERL_NIF_TERM term;
+    unsigned char* data = enif_make_new_binary(env, buffer.size(), &term);
+    std::memcpy(data, buffer.data(), buffer.size());
+    return term;
+  } catch (const std::exception& e) {
+    throw std::runtime_error(encode_clickhouse_error(e));
+  }
+}
+FINE_NIF(block_to_native, ERL_NIF_DIRTY_JOB_CPU_BOUND);
+
 // Forward declare Client (from minimal.cpp)
 // We need this to avoid duplicate FINE_RESOURCE declarations
 namespace clickhouse {
@@ -83,12 +105,47 @@ fine::Atom client_insert(
     fine::ResourcePtr<Client> client,
     std::string table_name,
     fine::ResourcePtr<BlockResource> block_res) {
+  NATCH_PROBE2(insert__start, table_name.c_str(), block_res->ptr->GetRowCount());
   try {
     // Block is copied by Insert
     client->Insert(table_name, *block_res->ptr);
-    return fine::Atom("ok");
   } catch (const std::exception& e) {
+    NATCH_PROBE2(insert__error, table_name.c_str(), e.what());
     throw std::runtime_error(encode_clickhouse_error(e));
   }
+  NATCH_PROBE1(insert__done, table_name.c_str());
+  return fine::Atom("ok");
+}
+FINE_NIF(client_insert, ERL_NIF_DIRTY_JOB_IO_BOUND);
+
+// Insert Native-format blocks (see native_format.h), e.g. from
+// client_select_native, without decoding them into terms. Each binary is
+// loaded into columns and sent as its own INSERT.
+fine::Atom client_insert_native(
+    ErlNifEnv *env,
+    fine::ResourcePtr<Client> client,
+    std::string table_name,
+    std::vector<ErlNifBinary> blocks) {
+  for (const ErlNifBinary& data : blocks) {
+    Block block;
+    try {
+      block = read_native_block(data.data, data.size);
+    } catch (const std::exception& e) {
+      throw std::runtime_error(encode_clickhouse_error(e));
+    }
+    if (block.GetRowCount() == 0) {
+      continue;
+    }
+
+    NATCH_PROBE2(insert__start, table_name.c_str(), block.GetRowCount());
+    try {
+      client->Insert(table_name, block);
+    } catch (const std::exception& e) {
+      NATCH_PROBE2(insert__error, table_name.c_str(), e.what());
+      throw std::runtime_error(encode_clickhouse_error(e));
+    }
+    NATCH_PROBE1(insert__done, table_name.c_str());
+  }
+  return fine::Atom("ok");
 }
-FINE_NIF(client_insert, 0);
+FINE_NIF(client_insert_native, ERL_NIF_DIRTY_JOB_IO_BOUND);
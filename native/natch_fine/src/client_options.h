@@ -0,0 +1,58 @@
+#pragma once
+
+#include <clickhouse/client.h>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Build ClientOptions from the connection arguments Elixir passes to
+// client_create (empty database/user/password mean "not set")
+inline clickhouse::ClientOptions make_client_options(
+    const std::string& host,
+    uint64_t port,
+    const std::string& database,
+    const std::string& user,
+    const std::string& password,
+    bool compression,
+    bool ssl,
+    uint64_t connect_timeout,
+    uint64_t recv_timeout,
+    uint64_t send_timeout) {
+  clickhouse::ClientOptions opts;
+  opts.SetHost(host);
+  opts.SetPort(static_cast<uint16_t>(port));
+
+  if (!database.empty()) {
+    opts.SetDefaultDatabase(database);
+  }
+
+  if (!user.empty()) {
+    opts.SetUser(user);
+  }
+
+  if (!password.empty()) {
+    opts.SetPassword(password);
+  }
+
+  if (compression) {
+    opts.SetCompressionMethod(clickhouse::CompressionMethod::LZ4);
+  }
+
+  if (ssl) {
+    // Enable SSL with default settings:
+    // - Use system CA certificates for verification
+    // - Verify peer certificate
+    // - Enable SNI
+    clickhouse::ClientOptions::SSLOptions ssl_opts;
+    ssl_opts.SetUseDefaultCALocations(true);
+    ssl_opts.SetUseSNI(true);
+    opts.SetSSLOptions(ssl_opts);
+  }
+
+  // Set socket-level timeouts
+  opts.SetConnectionConnectTimeout(std::chrono::milliseconds(connect_timeout));
+  opts.SetConnectionRecvTimeout(std::chrono::milliseconds(recv_timeout));
+  opts.SetConnectionSendTimeout(std::chrono::milliseconds(send_timeout));
+
+  return opts;
+}
@@ -11,10 +11,25 @@
 #include <clickhouse/columns/tuple.h>
 #include <clickhouse/columns/map.h>
 #include <clickhouse/columns/lowcardinality.h>
+#include <clickhouse/columns/enum.h>
+#include <clickhouse/types/types.h>
+#include <clickhouse/base/buffer.h>
+#include <clickhouse/base/output.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <type_traits>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <memory>
 #include <stdexcept>
+#include <vector>
 #include "error_encoding.h"
+#include "atoms.h"
 
 using namespace clickhouse;
 
@@ -133,6 +148,56 @@ uint64_t column_size(
 }
 FINE_NIF(column_size, 0);
 
+// Decode one list element into the wire type used for a column
+static bool get_list_number(ErlNifEnv *env, ERL_NIF_TERM term, ErlNifUInt64 *out) {
+  return enif_get_uint64(env, term, out);
+}
+
+static bool get_list_number(ErlNifEnv *env, ERL_NIF_TERM term, ErlNifSInt64 *out) {
+  return enif_get_int64(env, term, out);
+}
+
+static bool get_list_number(ErlNifEnv *env, ERL_NIF_TERM term, double *out) {
+  // Integers are accepted for float columns without an Elixir-side conversion
+  ErlNifSInt64 integer;
+  if (enif_get_double(env, term, out)) {
+    return true;
+  }
+  if (enif_get_int64(env, term, &integer)) {
+    *out = static_cast<double>(integer);
+    return true;
+  }
+  return false;
+}
+
+// Decode an Elixir list straight into a numeric column's storage
+// Reserves once and skips the intermediate std::vector a typed NIF argument
+// would need, so each value is copied once from term to column. An invalid
+// element truncates the column back to its old size: nothing is appended.
+template <typename T, typename Wire>
+static void append_number_list(
+    ErlNifEnv *env, ColumnVector<T>& col, ERL_NIF_TERM list, const char* type_name) {
+  unsigned length = 0;
+  if (!enif_get_list_length(env, list, &length)) {
+    throw std::invalid_argument(std::string(type_name) + " values must be a list");
+  }
+  auto& data = col.GetWritableData();
+  const size_t old_size = data.size();
+  data.reserve(old_size + length);
+
+  ERL_NIF_TERM head, tail = list;
+  while (enif_get_list_cell(env, tail, &head, &tail)) {
+    Wire value;
+    if (!get_list_number(env, head, &value)) {
+      data.resize(old_size);
+      char buf[256];
+      enif_snprintf(buf, sizeof(buf), "Invalid value for %s column: %T", type_name, head);
+      throw std::invalid_argument(buf);
+    }
+    data.push_back(static_cast<T>(value));
+  }
+}
+
 //
 // BULK APPEND OPERATIONS
 // These functions accept vectors of values for efficient bulk insertion
@@ -143,13 +208,13 @@ FINE_NIF(column_size, 0);
 fine::Atom column_uint64_append_bulk(
     ErlNifEnv *env,
     fine::ResourcePtr<ColumnResource> col_res,
-    std::vector<uint64_t> values) {
+    fine::Term values) {
   try {
     auto typed = std::static_pointer_cast<ColumnUInt64>(col_res->ptr);
-    for (const auto& value : values) {
-      typed->Append(value);
-    }
+    append_number_list<uint64_t, ErlNifUInt64>(env, *typed, values, "UInt64");
     return fine::Atom("ok");
+  } catch (const std::invalid_argument&) {
+    throw;
   } catch (const std::exception& e) {
     throw std::runtime_error(encode_clickhouse_error(e));
   }
@@ -160,13 +225,13 @@ FINE_NIF(column_uint64_append_bulk, 0);
 fine::Atom column_int64_append_bulk(
     ErlNifEnv *env,
     fine::ResourcePtr<ColumnResource> col_res,
-    std::vector<int64_t> values) {
+    fine::Term values) {
   try {
     auto typed = std::static_pointer_cast<ColumnInt64>(col_res->ptr);
-    for (const auto& value : values) {
-      typed->Append(value);
-    }
+    append_number_list<int64_t, ErlNifSInt64>(env, *typed, values, "Int64");
     return fine::Atom("ok");
+  } catch (const std::invalid_argument&) {
+    throw;
   } catch (const std::exception& e) {
     throw std::runtime_error(encode_clickhouse_error(e));
   }
@@ -177,11 +242,14 @@ FINE_NIF(column_int64_append_bulk, 0);
 fine::Atom column_string_append_bulk(
     ErlNifEnv *env,
     fine::ResourcePtr<ColumnResource> col_res,
-    std::vector<std::string> values) {
+    std::vector<ErlNifBinary> values) {
   try {
+    // Binaries are borrowed from the caller's terms; ColumnString copies
+    // each one exactly once into its own storage
     auto typed = std::static_pointer_cast<ColumnString>(col_res->ptr);
-    for (const auto& value : values) {
-      typed->Append(value);
+    typed->Reserve(typed->Size() + values.size());
+    for (const auto& bin : values) {
+      typed->Append(std::string_view(reinterpret_cast<const char*>(bin.data), bin.size));
     }
     return fine::Atom("ok");
   } catch (const std::exception& e) {
@@ -194,65 +262,377 @@ FINE_NIF(column_string_append_bulk, 0);
 fine::Atom column_float64_append_bulk(
     ErlNifEnv *env,
     fine::ResourcePtr<ColumnResource> col_res,
-    std::vector<double> values) {
+    fine::Term values) {
   try {
     auto typed = std::static_pointer_cast<ColumnFloat64>(col_res->ptr);
-    for (const auto& value : values) {
-      typed->Append(value);
-    }
+    append_number_list<double, double>(env, *typed, values, "Float64");
     return fine::Atom("ok");
+  } catch (const std::invalid_argument&) {
+    throw;
   } catch (const std::exception& e) {
     throw std::runtime_error(encode_clickhouse_error(e));
   }
 }
 FINE_NIF(column_float64_append_bulk, 0);
 
-// Bulk append DateTime values (Unix timestamps as uint64)
+// ============================================================================
+// Native decoding of Elixir temporal and Decimal structs
+// ============================================================================
+
+// Days since 1970-01-01 for a proleptic Gregorian date (days_from_civil)
+static int64_t days_from_civil(int64_t y, unsigned m, unsigned d) {
+  y -= m <= 2;
+  const int64_t era = (y >= 0 ? y : y - 399) / 400;
+  const unsigned yoe = static_cast<unsigned>(y - era * 400);
+  const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+  const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+[[noreturn]] static void raise_invalid_value(const char* what, ERL_NIF_TERM term) {
+  char buf[256];
+  enif_snprintf(buf, sizeof(buf), "Invalid %s value: %T", what, term);
+  throw std::invalid_argument(buf);
+}
+
+// Date stores days since 1970-01-01 as UInt16 (up to 2149-06-06)
+static uint16_t date_days(ErlNifEnv *env, ERL_NIF_TERM term, int64_t days) {
+  if (days < 0 || days > UINT16_MAX) {
+    char buf[256];
+    enif_snprintf(buf, sizeof(buf), "Date value out of range (1970-01-01..2149-06-06): %T", term);
+    throw std::invalid_argument(buf);
+  }
+  return static_cast<uint16_t>(days);
+}
+
+// DateTime stores Unix seconds as UInt32 (up to 2106-02-07 06:28:15)
+static uint32_t datetime_seconds(ErlNifEnv *env, ERL_NIF_TERM term, int64_t seconds) {
+  if (seconds < 0 || seconds > UINT32_MAX) {
+    char buf[256];
+    enif_snprintf(buf, sizeof(buf),
+                  "DateTime value out of range (1970-01-01 00:00:00..2106-02-07 06:28:15): %T",
+                  term);
+    throw std::invalid_argument(buf);
+  }
+  return static_cast<uint32_t>(seconds);
+}
+
+// True if term is a struct of the given module
+static bool is_struct(ErlNifEnv *env, ERL_NIF_TERM term, const fine::Atom& module) {
+  ERL_NIF_TERM tag;
+  return enif_is_map(env, term) &&
+         enif_get_map_value(env, term, fine::encode(env, atoms::struct_key), &tag) &&
+         enif_is_identical(tag, fine::encode(env, module));
+}
+
+static bool get_int_field(
+    ErlNifEnv *env, ERL_NIF_TERM map, const fine::Atom& key, ErlNifSInt64 *out) {
+  ERL_NIF_TERM value;
+  return enif_get_map_value(env, map, fine::encode(env, key), &value) &&
+         enif_get_int64(env, value, out);
+}
+
+static bool is_iso_calendar(ErlNifEnv *env, ERL_NIF_TERM map) {
+  ERL_NIF_TERM value;
+  return enif_get_map_value(env, map, fine::encode(env, atoms::calendar), &value) &&
+         enif_is_identical(value, fine::encode(env, atoms::ElixirCalendarISO));
+}
+
+// Days since epoch for a %Date{}; false if term is not a Date
+static bool decode_date(ErlNifEnv *env, ERL_NIF_TERM term, int64_t *days) {
+  if (!is_struct(env, term, atoms::ElixirDate) || !is_iso_calendar(env, term)) {
+    return false;
+  }
+  ErlNifSInt64 y, m, d;
+  if (!get_int_field(env, term, atoms::year, &y) ||
+      !get_int_field(env, term, atoms::month, &m) ||
+      !get_int_field(env, term, atoms::day, &d)) {
+    return false;
+  }
+  *days = days_from_civil(y, static_cast<unsigned>(m), static_cast<unsigned>(d));
+  return true;
+}
+
+// Unix seconds and microsecond part for a %DateTime{} (shifted to UTC) or a
+// %NaiveDateTime{} (taken as UTC); false if term is neither
+static bool decode_timestamp(
+    ErlNifEnv *env, ERL_NIF_TERM term, int64_t *seconds, int64_t *micros) {
+  bool is_datetime = is_struct(env, term, atoms::ElixirDateTime);
+  if (!is_datetime && !is_struct(env, term, atoms::ElixirNaiveDateTime)) {
+    return false;
+  }
+  if (!is_iso_calendar(env, term)) {
+    return false;
+  }
+
+  ErlNifSInt64 y, mo, d, h, mi, s;
+  if (!get_int_field(env, term, atoms::year, &y) ||
+      !get_int_field(env, term, atoms::month, &mo) ||
+      !get_int_field(env, term, atoms::day, &d) ||
+      !get_int_field(env, term, atoms::hour, &h) ||
+      !get_int_field(env, term, atoms::minute, &mi) ||
+      !get_int_field(env, term, atoms::second, &s)) {
+    return false;
+  }
+
+  // microsecond is {value, precision}
+  ERL_NIF_TERM usec_term;
+  const ERL_NIF_TERM* usec_tuple;
+  int usec_arity;
+  ErlNifSInt64 usec;
+  if (!enif_get_map_value(env, term, fine::encode(env, atoms::microsecond), &usec_term) ||
+      !enif_get_tuple(env, usec_term, &usec_arity, &usec_tuple) || usec_arity != 2 ||
+      !enif_get_int64(env, usec_tuple[0], &usec)) {
+    return false;
+  }
+
+  int64_t days = days_from_civil(y, static_cast<unsigned>(mo), static_cast<unsigned>(d));
+  int64_t secs = days * 86400 + h * 3600 + mi * 60 + s;
+
+  if (is_datetime) {
+    ErlNifSInt64 utc, dst;
+    if (!get_int_field(env, term, atoms::utc_offset, &utc) ||
+        !get_int_field(env, term, atoms::std_offset, &dst)) {
+      return false;
+    }
+    secs -= utc + dst;
+  }
+
+  *seconds = secs;
+  *micros = usec;
+  return true;
+}
+
+static std::string too_many_fractional_digits(size_t scale) {
+  return "Decimal value has more than " + std::to_string(scale) + " fractional digits";
+}
+
+// Bring a coefficient too wide for uint64 into range by taking off the
+// trailing zeros a negative `shift` allows. Reads the bignum from its
+// external term format (SMALL_BIG_EXT / LARGE_BIG_EXT) and advances `shift`
+// by the digits taken off.
+static ErlNifUInt64 reduce_big_coef(
+    ErlNifEnv *env, ERL_NIF_TERM term, ERL_NIF_TERM coef_term, int64_t& shift, size_t scale) {
+  ErlNifBinary ext;
+  if (!enif_term_to_binary(env, coef_term, &ext)) {
+    raise_invalid_value("decimal", term);
+  }
+  std::vector<uint32_t> limbs;  // little-endian, base 2^32
+  bool is_big = false;
+  if (ext.size >= 4 && ext.data[0] == 131 && (ext.data[1] == 110 || ext.data[1] == 111)) {
+    size_t header = ext.data[1] == 110 ? 3 : 6;
+    size_t digits = ext.data[1] == 110
+                        ? ext.data[2]
+                        : (size_t(ext.data[2]) << 24) | (size_t(ext.data[3]) << 16) |
+                              (size_t(ext.data[4]) << 8) | size_t(ext.data[5]);
+    // A negative coefficient is not a valid %Decimal{}
+    if (ext.size >= header + digits && ext.data[header - 1] == 0) {
+      is_big = true;
+      limbs.assign((digits + 3) / 4, 0);
+      for (size_t i = 0; i < digits; i++) {
+        limbs[i / 4] |= uint32_t(ext.data[header + i]) << (8 * (i % 4));
+      }
+    }
+  }
+  enif_release_binary(&ext);
+  if (!is_big) {
+    raise_invalid_value("decimal", term);
+  }
+
+  while (limbs.size() > 2) {
+    if (shift >= 0) {
+      throw std::invalid_argument("Decimal value out of range for Decimal64");
+    }
+    uint64_t remainder = 0;
+    for (size_t i = limbs.size(); i-- > 0;) {
+      uint64_t current = (remainder << 32) | limbs[i];
+      limbs[i] = static_cast<uint32_t>(current / 10);
+      remainder = current % 10;
+    }
+    if (remainder != 0) {
+      throw std::invalid_argument(too_many_fractional_digits(scale));
+    }
+    while (!limbs.empty() && limbs.back() == 0) {
+      limbs.pop_back();
+    }
+    ++shift;
+  }
+  limbs.resize(2, 0);
+  return (ErlNifUInt64(limbs[1]) << 32) | limbs[0];
+}
+
+// Scale a %Decimal{} to an integer with `scale` fractional digits
+// Raises if the value is not finite, needs more digits, or overflows int64.
+// The coefficient may exceed 64 bits if the exponent removes enough zeros.
+static int64_t decode_decimal(ErlNifEnv *env, ERL_NIF_TERM term, size_t scale) {
+  ErlNifSInt64 sign, exp;
+  ErlNifUInt64 coef;
+  ERL_NIF_TERM coef_term;
+  if (!get_int_field(env, term, atoms::sign, &sign) ||
+      !get_int_field(env, term, atoms::exp, &exp) ||
+      !enif_get_map_value(env, term, fine::encode(env, atoms::coef), &coef_term)) {
+    raise_invalid_value("decimal", term);
+  }
+  int64_t shift = exp + static_cast<int64_t>(scale);
+  if (!enif_get_uint64(env, coef_term, &coef)) {
+    // :inf / :NaN and non-integers are rejected here too
+    coef = reduce_big_coef(env, term, coef_term, shift, scale);
+  }
+
+  if (coef != 0) {
+    for (; shift > 0; --shift) {
+      if (coef > static_cast<ErlNifUInt64>(INT64_MAX) / 10) {
+        throw std::invalid_argument("Decimal value out of range for Decimal64");
+      }
+      coef *= 10;
+    }
+    for (; shift < 0; ++shift) {
+      if (coef % 10 != 0) {
+        throw std::invalid_argument(too_many_fractional_digits(scale));
+      }
+      coef /= 10;
+    }
+    if (coef > static_cast<ErlNifUInt64>(INT64_MAX)) {
+      throw std::invalid_argument("Decimal value out of range for Decimal64");
+    }
+  }
+
+  int64_t magnitude = static_cast<int64_t>(coef);
+  return sign < 0 ? -magnitude : magnitude;
+}
+
+// Bulk append DateTime values (%DateTime{}, %NaiveDateTime{} or Unix seconds)
 fine::Atom column_datetime_append_bulk(
     ErlNifEnv *env,
     fine::ResourcePtr<ColumnResource> col_res,
-    std::vector<uint64_t> timestamps) {
+    fine::Term values) {
   try {
     auto typed = std::static_pointer_cast<ColumnDateTime>(col_res->ptr);
-    for (const auto& timestamp : timestamps) {
-      typed->Append(static_cast<time_t>(timestamp));
+
+    // Decode everything first so an invalid element appends nothing
+    unsigned length = 0;
+    if (!enif_get_list_length(env, values, &length)) {
+      throw std::invalid_argument("DateTime values must be a list");
+    }
+    std::vector<time_t> timestamps;
+    timestamps.reserve(length);
+
+    ERL_NIF_TERM head, tail = values;
+    while (enif_get_list_cell(env, tail, &head, &tail)) {
+      ErlNifUInt64 timestamp;
+      int64_t seconds, micros;
+      if (decode_timestamp(env, head, &seconds, &micros)) {
+        timestamps.push_back(datetime_seconds(env, head, seconds));
+      } else if (enif_get_uint64(env, head, &timestamp)) {
+        seconds = static_cast<int64_t>(std::min<ErlNifUInt64>(timestamp, INT64_MAX));
+        timestamps.push_back(datetime_seconds(env, head, seconds));
+      } else {
+        raise_invalid_value("datetime", head);
+      }
+    }
+
+    for (time_t timestamp : timestamps) {
+      typed->Append(timestamp);
     }
     return fine::Atom("ok");
+  } catch (const std::invalid_argument&) {
+    throw;
   } catch (const std::exception& e) {
     throw std::runtime_error(encode_clickhouse_error(e));
   }
 }
 FINE_NIF(column_datetime_append_bulk, 0);
 
-// Bulk append DateTime64 values (microsecond timestamps as int64)
+// Bulk append DateTime64 values (%DateTime{}, %NaiveDateTime{} or ticks at
+// the column's precision)
 fine::Atom column_datetime64_append_bulk(
     ErlNifEnv *env,
     fine::ResourcePtr<ColumnResource> col_res,
-    std::vector<int64_t> ticks) {
+    fine::Term values) {
   try {
     auto typed = std::static_pointer_cast<ColumnDateTime64>(col_res->ptr);
-    for (const auto& tick : ticks) {
+
+    // Structs carry microseconds; rescale to the column's tick precision
+    const size_t precision = typed->GetPrecision();
+    int64_t ticks_per_second = 1;
+    for (size_t i = 0; i < precision; ++i) {
+      ticks_per_second *= 10;
+    }
+
+    unsigned length = 0;
+    if (!enif_get_list_length(env, values, &length)) {
+      throw std::invalid_argument("DateTime64 values must be a list");
+    }
+    std::vector<int64_t> ticks;
+    ticks.reserve(length);
+
+    ERL_NIF_TERM head, tail = values;
+    while (enif_get_list_cell(env, tail, &head, &tail)) {
+      ErlNifSInt64 raw;
+      int64_t seconds, micros;
+      if (decode_timestamp(env, head, &seconds, &micros)) {
+        int64_t fraction = precision >= 6
+            ? micros * (ticks_per_second / 1000000)
+            : micros / (1000000 / ticks_per_second);
+        ticks.push_back(seconds * ticks_per_second + fraction);
+      } else if (enif_get_int64(env, head, &raw)) {
+        ticks.push_back(raw);
+      } else {
+        raise_invalid_value("datetime64", head);
+      }
+    }
+
+    for (int64_t tick : ticks) {
       typed->Append(tick);
     }
     return fine::Atom("ok");
+  } catch (const std::invalid_argument&) {
+    throw;
   } catch (const std::exception& e) {
     throw std::runtime_error(encode_clickhouse_error(e));
   }
 }
 FINE_NIF(column_datetime64_append_bulk, 0);
 
-// Bulk append Decimal64 values (scaled int64 values)
+// Bulk append Decimal values (%Decimal{}, already-scaled integers or floats)
 fine::Atom column_decimal_append_bulk(
     ErlNifEnv *env,
     fine::ResourcePtr<ColumnResource> col_res,
-    std::vector<int64_t> scaled_values) {
+    fine::Term values) {
   try {
     auto typed = std::static_pointer_cast<ColumnDecimal>(col_res->ptr);
-    for (const auto& value : scaled_values) {
+    const size_t scale = typed->GetScale();
+    const double multiplier = std::pow(10.0, static_cast<double>(scale));
+
+    unsigned length = 0;
+    if (!enif_get_list_length(env, values, &length)) {
+      throw std::invalid_argument("Decimal values must be a list");
+    }
+    std::vector<int64_t> scaled_values;
+    scaled_values.reserve(length);
+
+    ERL_NIF_TERM head, tail = values;
+    while (enif_get_list_cell(env, tail, &head, &tail)) {
+      ErlNifSInt64 scaled;
+      double number;
+      if (enif_get_int64(env, head, &scaled)) {
+        scaled_values.push_back(scaled);
+      } else if (enif_get_double(env, head, &number)) {
+        scaled_values.push_back(static_cast<int64_t>(std::trunc(number * multiplier)));
+      } else if (is_struct(env, head, atoms::ElixirDecimal)) {
+        scaled_values.push_back(decode_decimal(env, head, scale));
+      } else {
+        raise_invalid_value("decimal", head);
+      }
+    }
+
+    for (int64_t value : scaled_values) {
       // Convert int64 to Int128 for ColumnDecimal
       typed->Append(Int128(value));
     }
     return fine::Atom("ok");
+  } catch (const std::invalid_argument&) {
+    throw;
   } catch (const std::exception& e) {
     throw std::runtime_error(encode_clickhouse_error(e));
   }
@@ -307,7 +687,7 @@ FINE_NIF(column_nullable_int64_append_bulk, 0);
 fine::Atom column_nullable_string_append_bulk(
     ErlNifEnv *env,
     fine::ResourcePtr<ColumnResource> col_res,
-    std::vector<std::string> values,
+    std::vector<ErlNifBinary> values,
     std::vector<uint64_t> nulls) {
   try {
     auto nullable_col = std::static_pointer_cast<ColumnNullable>(col_res->ptr);
@@ -315,7 +695,8 @@ fine::Atom column_nullable_string_append_bulk(
     auto null_map = nullable_col->Nulls()->As<ColumnUInt8>();
 
     for (size_t i = 0; i < values.size(); i++) {
-      nested->Append(values[i]);
+      nested->Append(std::string_view(
+          reinterpret_cast<const char*>(values[i].data), values[i].size));
       null_map->Append(static_cast<uint8_t>(nulls[i]));
     }
     return fine::Atom("ok");
@@ -352,17 +733,41 @@ FINE_NIF(column_nullable_float64_append_bulk, 0);
 // Bulk append operations for Bool, Date, Float32, and additional integer types
 //
 
-// Bulk append Date values (days since epoch as uint16)
+// Bulk append Date values (%Date{} or days since epoch)
 fine::Atom column_date_append_bulk(
     ErlNifEnv *env,
     fine::ResourcePtr<ColumnResource> col_res,
-    std::vector<uint64_t> days) {
+    fine::Term values) {
   try {
     auto typed = std::static_pointer_cast<ColumnDate>(col_res->ptr);
-    for (const auto& day : days) {
-      typed->AppendRaw(static_cast<uint16_t>(day));
+
+    unsigned length = 0;
+    if (!enif_get_list_length(env, values, &length)) {
+      throw std::invalid_argument("Date values must be a list");
+    }
+    std::vector<uint16_t> days;
+    days.reserve(length);
+
+    ERL_NIF_TERM head, tail = values;
+    while (enif_get_list_cell(env, tail, &head, &tail)) {
+      int64_t day;
+      ErlNifUInt64 raw;
+      if (decode_date(env, head, &day)) {
+        days.push_back(date_days(env, head, day));
+      } else if (enif_get_uint64(env, head, &raw)) {
+        day = static_cast<int64_t>(std::min<ErlNifUInt64>(raw, INT64_MAX));
+        days.push_back(date_days(env, head, day));
+      } else {
+        raise_invalid_value("date", head);
+      }
+    }
+
+    for (uint16_t day : days) {
+      typed->AppendRaw(day);
     }
     return fine::Atom("ok");
+  } catch (const std::invalid_argument&) {
+    throw;
   } catch (const std::exception& e) {
     throw std::runtime_error(encode_clickhouse_error(e));
   }
@@ -373,13 +778,13 @@ FINE_NIF(column_date_append_bulk, 0);
 fine::Atom column_uint8_append_bulk(
     ErlNifEnv *env,
     fine::ResourcePtr<ColumnResource> col_res,
-    std::vector<uint64_t> values) {
+    fine::Term values) {
   try {
     auto typed = std::static_pointer_cast<ColumnUInt8>(col_res->ptr);
-    for (const auto& value : values) {
-      typed->Append(static_cast<uint8_t>(value));
-    }
+    append_number_list<uint8_t, ErlNifUInt64>(env, *typed, values, "UInt8");
     return fine::Atom("ok");
+  } catch (const std::invalid_argument&) {
+    throw;
   } catch (const std::exception& e) {
     throw std::runtime_error(encode_clickhouse_error(e));
   }
@@ -390,13 +795,13 @@ FINE_NIF(column_uint8_append_bulk, 0);
 fine::Atom column_uint32_append_bulk(
     ErlNifEnv *env,
     fine::ResourcePtr<ColumnResource> col_res,
-    std::vector<uint64_t> values) {
+    fine::Term values) {
   try {
     auto typed = std::static_pointer_cast<ColumnUInt32>(col_res->ptr);
-    for (const auto& value : values) {
-      typed->Append(static_cast<uint32_t>(value));
-    }
+    append_number_list<uint32_t, ErlNifUInt64>(env, *typed, values, "UInt32");
     return fine::Atom("ok");
+  } catch (const std::invalid_argument&) {
+    throw;
   } catch (const std::exception& e) {
     throw std::runtime_error(encode_clickhouse_error(e));
   }
@@ -407,13 +812,13 @@ FINE_NIF(column_uint32_append_bulk, 0);
 fine::Atom column_uint16_append_bulk(
     ErlNifEnv *env,
     fine::ResourcePtr<ColumnResource> col_res,
-    std::vector<uint64_t> values) {
+    fine::Term values) {
   try {
     auto typed = std::static_pointer_cast<ColumnUInt16>(col_res->ptr);
-    for (const auto& value : values) {
-      typed->Append(static_cast<uint16_t>(value));
-    }
+    append_number_list<uint16_t, ErlNifUInt64>(env, *typed, values, "UInt16");
     return fine::Atom("ok");
+  } catch (const std::invalid_argument&) {
+    throw;
   } catch (const std::exception& e) {
     throw std::runtime_error(encode_clickhouse_error(e));
   }
@@ -424,13 +829,13 @@ FINE_NIF(column_uint16_append_bulk, 0);
 fine::Atom column_int32_append_bulk(
     ErlNifEnv *env,
     fine::ResourcePtr<ColumnResource> col_res,
-    std::vector<int64_t> values) {
+    fine::Term values) {
   try {
     auto typed = std::static_pointer_cast<ColumnInt32>(col_res->ptr);
-    for (const auto& value : values) {
-      typed->Append(static_cast<int32_t>(value));
-    }
+    append_number_list<int32_t, ErlNifSInt64>(env, *typed, values, "Int32");
     return fine::Atom("ok");
+  } catch (const std::invalid_argument&) {
+    throw;
   } catch (const std::exception& e) {
     throw std::runtime_error(encode_clickhouse_error(e));
   }
@@ -441,13 +846,13 @@ FINE_NIF(column_int32_append_bulk, 0);
 fine::Atom column_int16_append_bulk(
     ErlNifEnv *env,
     fine::ResourcePtr<ColumnResource> col_res,
-    std::vector<int64_t> values) {
+    fine::Term values) {
   try {
     auto typed = std::static_pointer_cast<ColumnInt16>(col_res->ptr);
-    for (const auto& value : values) {
-      typed->Append(static_cast<int16_t>(value));
-    }
+    append_number_list<int16_t, ErlNifSInt64>(env, *typed, values, "Int16");
     return fine::Atom("ok");
+  } catch (const std::invalid_argument&) {
+    throw;
   } catch (const std::exception& e) {
     throw std::runtime_error(encode_clickhouse_error(e));
   }
@@ -458,13 +863,13 @@ FINE_NIF(column_int16_append_bulk, 0);
 fine::Atom column_int8_append_bulk(
     ErlNifEnv *env,
     fine::ResourcePtr<ColumnResource> col_res,
-    std::vector<int64_t> values) {
+    fine::Term values) {
   try {
     auto typed = std::static_pointer_cast<ColumnInt8>(col_res->ptr);
-    for (const auto& value : values) {
-      typed->Append(static_cast<int8_t>(value));
-    }
+    append_number_list<int8_t, ErlNifSInt64>(env, *typed, values, "Int8");
     return fine::Atom("ok");
+  } catch (const std::invalid_argument&) {
+    throw;
   } catch (const std::exception& e) {
     throw std::runtime_error(encode_clickhouse_error(e));
   }
@@ -475,13 +880,13 @@ FINE_NIF(column_int8_append_bulk, 0);
 fine::Atom column_float32_append_bulk(
     ErlNifEnv *env,
     fine::ResourcePtr<ColumnResource> col_res,
-    std::vector<double> values) {
+    fine::Term values) {
   try {
     auto typed = std::static_pointer_cast<ColumnFloat32>(col_res->ptr);
-    for (const auto& value : values) {
-      typed->Append(static_cast<float>(value));
-    }
+    append_number_list<float, double>(env, *typed, values, "Float32");
     return fine::Atom("ok");
+  } catch (const std::invalid_argument&) {
+    throw;
   } catch (const std::exception& e) {
     throw std::runtime_error(encode_clickhouse_error(e));
   }
@@ -664,6 +1069,179 @@ fine::Atom column_map_append_from_array(
 }
 FINE_NIF(column_map_append_from_array, 0);
 
+// Appends one Elixir term to a scalar column; returns false if the term does
+// not fit the column type. Built once per nested column, then called per element
+using TermAppender = std::function<bool(ErlNifEnv*, ERL_NIF_TERM)>;
+
+template <typename T>
+static TermAppender make_integer_appender(ColumnRef col) {
+  auto typed = col->As<ColumnVector<T>>();
+  return [typed](ErlNifEnv *env, ERL_NIF_TERM term) {
+    if constexpr (std::is_same_v<T, uint64_t>) {
+      ErlNifUInt64 value;
+      if (!enif_get_uint64(env, term, &value)) {
+        return false;
+      }
+      typed->Append(value);
+    } else {
+      ErlNifSInt64 value;
+      if (!enif_get_int64(env, term, &value) ||
+          value < static_cast<ErlNifSInt64>(std::numeric_limits<T>::min()) ||
+          value > static_cast<ErlNifSInt64>(std::numeric_limits<T>::max())) {
+        return false;
+      }
+      typed->Append(static_cast<T>(value));
+    }
+    return true;
+  };
+}
+
+template <typename T>
+static TermAppender make_float_appender(ColumnRef col) {
+  auto typed = col->As<ColumnVector<T>>();
+  return [typed](ErlNifEnv *env, ERL_NIF_TERM term) {
+    double value;
+    ErlNifSInt64 integer;
+    if (enif_get_double(env, term, &value)) {
+      typed->Append(static_cast<T>(value));
+    } else if (enif_get_int64(env, term, &integer)) {
+      typed->Append(static_cast<T>(integer));
+    } else {
+      return false;
+    }
+    return true;
+  };
+}
+
+// Returns an empty appender for types that have no direct term mapping
+static TermAppender make_term_appender(ColumnRef col) {
+  switch (col->Type()->GetCode()) {
+    case Type::UInt8: {
+      // Bool columns are UInt8 on the client side
+      auto typed = col->As<ColumnUInt8>();
+      return [typed](ErlNifEnv *env, ERL_NIF_TERM term) {
+        ErlNifUInt64 value;
+        if (enif_is_identical(term, fine::encode(env, atoms::true_))) {
+          typed->Append(1);
+        } else if (enif_is_identical(term, fine::encode(env, atoms::false_))) {
+          typed->Append(0);
+        } else if (enif_get_uint64(env, term, &value) && value <= UINT8_MAX) {
+          typed->Append(static_cast<uint8_t>(value));
+        } else {
+          return false;
+        }
+        return true;
+      };
+    }
+    case Type::UInt16: return make_integer_appender<uint16_t>(col);
+    case Type::UInt32: return make_integer_appender<uint32_t>(col);
+    case Type::UInt64: return make_integer_appender<uint64_t>(col);
+    case Type::Int8: return make_integer_appender<int8_t>(col);
+    case Type::Int16: return make_integer_appender<int16_t>(col);
+    case Type::Int32: return make_integer_appender<int32_t>(col);
+    case Type::Int64: return make_integer_appender<int64_t>(col);
+    case Type::Float32: return make_float_appender<float>(col);
+    case Type::Float64: return make_float_appender<double>(col);
+    case Type::String: {
+      auto typed = col->As<ColumnString>();
+      return [typed](ErlNifEnv *env, ERL_NIF_TERM term) {
+        ErlNifBinary bin;
+        if (!enif_inspect_binary(env, term, &bin)) {
+          return false;
+        }
+        typed->Append(std::string_view(reinterpret_cast<const char*>(bin.data), bin.size));
+        return true;
+      };
+    }
+    default:
+      return TermAppender();
+  }
+}
+
+// Releases an enif map iterator on every exit path
+class MapIteratorGuard {
+public:
+  MapIteratorGuard(ErlNifEnv *env, ErlNifMapIterator *iter) : env_(env), iter_(iter) {}
+  ~MapIteratorGuard() { enif_map_iterator_destroy(env_, iter_); }
+
+private:
+  ErlNifEnv *env_;
+  ErlNifMapIterator *iter_;
+};
+
+// Bulk append Elixir maps to a Map(K, V) column with scalar K and V
+// Keys, values and offsets are written in one pass straight into the
+// Array(Tuple(K, V)) storage, then appended to the target column in place
+fine::Atom column_map_append_bulk(
+    ErlNifEnv *env,
+    fine::ResourcePtr<ColumnResource> map_col_res,
+    fine::Term maps) {
+  try {
+    if (!map_col_res->ptr) {
+      throw std::runtime_error("Map column pointer is null");
+    }
+    auto map_col = map_col_res->ptr->As<ColumnMap>();
+    if (!map_col) {
+      throw std::runtime_error("Column is not a Map");
+    }
+
+    const auto* map_type = map_col->Type()->As<MapType>();
+    auto keys = CreateColumnByType(map_type->GetKeyType()->GetName());
+    auto values = CreateColumnByType(map_type->GetValueType()->GetName());
+
+    TermAppender append_key = make_term_appender(keys);
+    TermAppender append_value = make_term_appender(values);
+    if (!append_key || !append_value) {
+      throw std::invalid_argument(
+          "column_map_append_bulk/2 only supports scalar key and value types, got: " +
+          map_col->Type()->GetName());
+    }
+
+    auto offsets = std::make_shared<ColumnUInt64>();
+    uint64_t offset = 0;
+
+    ERL_NIF_TERM map, tail = maps;
+    while (enif_get_list_cell(env, tail, &map, &tail)) {
+      ErlNifMapIterator iter;
+      if (!enif_is_map(env, map) ||
+          !enif_map_iterator_create(env, map, &iter, ERL_NIF_MAP_ITERATOR_FIRST)) {
+        raise_invalid_value("map", map);
+      }
+      MapIteratorGuard guard(env, &iter);
+
+      ERL_NIF_TERM key, value;
+      while (enif_map_iterator_get_pair(env, &iter, &key, &value)) {
+        if (!append_key(env, key)) {
+          raise_invalid_value("map key", key);
+        }
+        if (!append_value(env, value)) {
+          raise_invalid_value("map value", value);
+        }
+        ++offset;
+        enif_map_iterator_next(env, &iter);
+      }
+      offsets->Append(offset);
+    }
+    if (!enif_is_empty_list(env, tail)) {
+      throw std::invalid_argument("Map values must be a list");
+    }
+
+    auto tuple = std::make_shared<ColumnTuple>(std::vector<ColumnRef>{keys, values});
+    auto array = std::make_shared<ColumnArray>(tuple, offsets);
+    auto built = std::make_shared<ColumnMap>(array);
+
+    // Append in place: a block or parent column may already hold this one
+    map_col->Append(built);
+
+    return fine::Atom("ok");
+  } catch (const std::invalid_argument&) {
+    throw;
+  } catch (const std::exception& e) {
+    throw std::runtime_error(encode_clickhouse_error(e));
+  }
+}
+FINE_NIF(column_map_append_bulk, 0);
+
 // ============================================================================
 // LowCardinality Type Support
 // ============================================================================
@@ -695,3 +1273,597 @@ fine::Atom column_lowcardinality_append_from_column(
   }
 }
 FINE_NIF(column_lowcardinality_append_from_column, 0);
+
+// Append String values directly to a LowCardinality(String) column
+// Each value is hashed once into the column's own dictionary, which persists
+// across every batch appended to this column; only an index is written per row
+fine::Atom column_lowcardinality_string_append_bulk(
+    ErlNifEnv *env,
+    fine::ResourcePtr<ColumnResource> lc_col_res,
+    std::vector<ErlNifBinary> values) {
+  try {
+    if (!lc_col_res->ptr) {
+      throw std::runtime_error("LowCardinality column pointer is null");
+    }
+
+    auto lc_col = lc_col_res->ptr->As<ColumnLowCardinalityT<ColumnString>>();
+    if (!lc_col) {
+      throw std::runtime_error("Column is not LowCardinality(String)");
+    }
+
+    for (const auto& bin : values) {
+      // Borrow the binary's bytes; the dictionary copies only unseen values
+      lc_col->Append(std::string_view(reinterpret_cast<const char*>(bin.data), bin.size));
+    }
+
+    return fine::Atom("ok");
+  } catch (const std::exception& e) {
+    throw std::runtime_error(encode_clickhouse_error(e));
+  }
+}
+FINE_NIF(column_lowcardinality_string_append_bulk, 0);
+
+// ============================================================================
+// Enum Type Support
+// ============================================================================
+
+// Sorted name -> code table built once per call from the column's EnumType
+// Names point into the EnumType, which the column keeps alive for the call
+class EnumLookup {
+public:
+  explicit EnumLookup(const EnumType& enum_type) : enum_type_(enum_type) {
+    for (auto it = enum_type.BeginValueToName(); it != enum_type.EndValueToName(); ++it) {
+      by_name_.emplace_back(std::string_view(it->second), it->first);
+    }
+    std::sort(by_name_.begin(), by_name_.end());
+  }
+
+  // Resolve an element (binary name, atom name or integer code) to its code
+  int16_t Resolve(ErlNifEnv *env, ERL_NIF_TERM term) const {
+    ErlNifBinary bin;
+    if (enif_inspect_binary(env, term, &bin)) {
+      return ByName(std::string_view(reinterpret_cast<const char*>(bin.data), bin.size));
+    }
+
+    // Atom names are at most 255 characters, 4 bytes each in UTF-8
+    char atom_buf[1024];
+    int atom_len = enif_get_atom(env, term, atom_buf, sizeof(atom_buf), ERL_NIF_UTF8);
+    if (atom_len > 0) {
+      return ByName(std::string_view(atom_buf, atom_len - 1));
+    }
+
+    ErlNifSInt64 code;
+    if (enif_get_int64(env, term, &code)) {
+      if (code < INT16_MIN || code > INT16_MAX ||
+          !enum_type_.HasEnumValue(static_cast<int16_t>(code))) {
+        throw std::invalid_argument("Unknown enum value: " + std::to_string(code));
+      }
+      return static_cast<int16_t>(code);
+    }
+
+    throw std::invalid_argument("Enum values must be strings, atoms or integers");
+  }
+
+private:
+  int16_t ByName(std::string_view name) const {
+    auto it = std::lower_bound(
+        by_name_.begin(), by_name_.end(), name,
+        [](const std::pair<std::string_view, int16_t>& item, std::string_view key) {
+          return item.first < key;
+        });
+    if (it == by_name_.end() || it->first != name) {
+      throw std::invalid_argument("Unknown enum name: " + std::string(name));
+    }
+    return it->second;
+  }
+
+  const EnumType& enum_type_;
+  std::vector<std::pair<std::string_view, int16_t>> by_name_;
+};
+
+// Validate and encode a list of enum names/codes into an Enum8/Enum16 column
+template <typename EnumColumn, typename Code>
+void append_enum_values(ErlNifEnv *env, EnumColumn& enum_col, ERL_NIF_TERM values) {
+  const auto* enum_type = enum_col.GetType().template As<EnumType>();
+  EnumLookup lookup(*enum_type);
+
+  // Encode the whole list before touching the column so a bad value appends nothing
+  unsigned length = 0;
+  if (!enif_get_list_length(env, values, &length)) {
+    throw std::invalid_argument("Enum values must be a list");
+  }
+  std::vector<Code> codes;
+  codes.reserve(length);
+
+  ERL_NIF_TERM head, tail = values;
+  while (enif_get_list_cell(env, tail, &head, &tail)) {
+    codes.push_back(static_cast<Code>(lookup.Resolve(env, head)));
+  }
+
+  for (Code code : codes) {
+    enum_col.Append(code);
+  }
+}
+
+// Bulk append Enum8 values given as names (binaries or atoms) or integer codes
+fine::Atom column_enum8_append_bulk(
+    ErlNifEnv *env,
+    fine::ResourcePtr<ColumnResource> col_res,
+    fine::Term values) {
+  try {
+    auto enum_col = col_res->ptr->As<ColumnEnum8>();
+    if (!enum_col) {
+      throw std::runtime_error("Column is not Enum8");
+    }
+    append_enum_values<ColumnEnum8, int8_t>(env, *enum_col, values);
+    return fine::Atom("ok");
+  } catch (const std::invalid_argument&) {
+    // Surface as ArgumentError, matching Elixir-side validation errors
+    throw;
+  } catch (const std::exception& e) {
+    throw std::runtime_error(encode_clickhouse_error(e));
+  }
+}
+FINE_NIF(column_enum8_append_bulk, 0);
+
+// Bulk append Enum16 values given as names (binaries or atoms) or integer codes
+fine::Atom column_enum16_append_bulk(
+    ErlNifEnv *env,
+    fine::ResourcePtr<ColumnResource> col_res,
+    fine::Term values) {
+  try {
+    auto enum_col = col_res->ptr->As<ColumnEnum16>();
+    if (!enum_col) {
+      throw std::runtime_error("Column is not Enum16");
+    }
+    append_enum_values<ColumnEnum16, int16_t>(env, *enum_col, values);
+    return fine::Atom("ok");
+  } catch (const std::invalid_argument&) {
+    throw;
+  } catch (const std::exception& e) {
+    throw std::runtime_error(encode_clickhouse_error(e));
+  }
+}
+FINE_NIF(column_enum16_append_bulk, 0);
+
+// ============================================================================
+// Direct encoding to Native column data
+// ============================================================================
+//
+// Writes a column's values straight from Elixir terms into the bytes
+// Column::Save would produce for the same values, so a Native block (see
+// native_format.h) can be built without creating columns first. Covers the
+// scalar types the bulk appends above accept, plus Nullable and Array of
+// them; other types are built as columns and saved (column_save_native).
+
+// Growable output buffer backed by an Erlang binary, handed over without a
+// final copy
+class NativeWriter {
+public:
+  NativeWriter() {
+    if (!enif_alloc_binary(4096, &bin_)) {
+      throw std::bad_alloc();
+    }
+  }
+  ~NativeWriter() {
+    if (owned_) {
+      enif_release_binary(&bin_);
+    }
+  }
+  NativeWriter(const NativeWriter&) = delete;
+  NativeWriter& operator=(const NativeWriter&) = delete;
+
+  // `size` writable bytes at the end of the buffer
+  uint8_t* Extend(size_t size) {
+    if (size_ + size > bin_.size &&
+        !enif_realloc_binary(&bin_, std::max(size_ + size, bin_.size * 2))) {
+      throw std::bad_alloc();
+    }
+    uint8_t* out = bin_.data + size_;
+    size_ += size;
+    return out;
+  }
+
+  template <typename T>
+  void Write(T value) {
+    std::memcpy(Extend(sizeof(T)), &value, sizeof(T));
+  }
+
+  void WriteVarint(uint64_t value) {
+    while (value >= 0x80) {
+      Write<uint8_t>(static_cast<uint8_t>(value) | 0x80);
+      value >>= 7;
+    }
+    Write<uint8_t>(static_cast<uint8_t>(value));
+  }
+
+  ERL_NIF_TERM Finish(ErlNifEnv *env) {
+    if (!enif_realloc_binary(&bin_, size_)) {
+      throw std::bad_alloc();
+    }
+    owned_ = false;
+    return enif_make_binary(env, &bin_);
+  }
+
+private:
+  ErlNifBinary bin_;
+  size_t size_ = 0;
+  bool owned_ = true;
+};
+
+// Integer within T's range (booleans count as 0/1 for Bool, stored as UInt8)
+template <typename T>
+static bool get_native_integer(ErlNifEnv *env, ERL_NIF_TERM term, T *out) {
+  if constexpr (std::is_unsigned_v<T>) {
+    ErlNifUInt64 value;
+    if (enif_get_uint64(env, term, &value)) {
+      if (value > std::numeric_limits<T>::max()) {
+        return false;
+      }
+      *out = static_cast<T>(value);
+      return true;
+    }
+    if constexpr (sizeof(T) == 1) {
+      if (enif_is_identical(term, fine::encode(env, atoms::true_)) ||
+          enif_is_identical(term, fine::encode(env, atoms::false_))) {
+        *out = enif_is_identical(term, fine::encode(env, atoms::true_)) ? 1 : 0;
+        return true;
+      }
+    }
+    return false;
+  } else {
+    ErlNifSInt64 value;
+    if (!enif_get_int64(env, term, &value) || value < std::numeric_limits<T>::min() ||
+        value > std::numeric_limits<T>::max()) {
+      return false;
+    }
+    *out = static_cast<T>(value);
+    return true;
+  }
+}
+
+// 16-byte big-endian binary or 36-char string, as Natch.Column accepts
+static bool get_native_uuid(ErlNifEnv *env, ERL_NIF_TERM term, UUID *out) {
+  ErlNifBinary bin;
+  if (!enif_inspect_binary(env, term, &bin)) {
+    return false;
+  }
+
+  uint64_t halves[2] = {0, 0};
+  if (bin.size == 16) {
+    for (size_t i = 0; i < 16; i++) {
+      halves[i / 8] = (halves[i / 8] << 8) | bin.data[i];
+    }
+  } else {
+    size_t digits = 0;
+    for (size_t i = 0; i < bin.size; i++) {
+      unsigned char c = bin.data[i];
+      if (c == '-') {
+        continue;
+      }
+      int nibble = c >= '0' && c <= '9' ? c - '0'
+                 : c >= 'a' && c <= 'f' ? c - 'a' + 10
+                 : c >= 'A' && c <= 'F' ? c - 'A' + 10
+                 : -1;
+      if (nibble < 0 || digits == 32) {
+        return false;
+      }
+      halves[digits / 16] = (halves[digits / 16] << 4) | static_cast<uint64_t>(nibble);
+      digits++;
+    }
+    if (digits != 32) {
+      return false;
+    }
+  }
+  *out = UUID{halves[0], halves[1]};
+  return true;
+}
+
+// Shared loop for the scalar types: nil writes T's default when the values
+// are the nested data of a Nullable
+template <typename T, typename Get>
+static void write_native_values(
+    ErlNifEnv *env, const std::vector<ERL_NIF_TERM>& values, bool nil_default,
+    NativeWriter& out, const char* type_name, Get get) {
+  ERL_NIF_TERM nil = fine::encode(env, atoms::nil);
+  uint8_t* data = out.Extend(values.size() * sizeof(T));
+  for (size_t i = 0; i < values.size(); i++) {
+    T value{};
+    if (!(nil_default && enif_is_identical(values[i], nil)) && !get(values[i], &value)) {
+      char buf[256];
+      enif_snprintf(buf, sizeof(buf), "Invalid value for %s column: %T", type_name, values[i]);
+      throw std::invalid_argument(buf);
+    }
+    std::memcpy(data + i * sizeof(T), &value, sizeof(T));
+  }
+}
+
+// Collect a list's elements; the encoders make more than one pass
+static void list_terms(ErlNifEnv *env, ERL_NIF_TERM list, std::vector<ERL_NIF_TERM>& out,
+                       const char* what) {
+  unsigned length = 0;
+  if (!enif_get_list_length(env, list, &length)) {
+    char buf[256];
+    enif_snprintf(buf, sizeof(buf), "%s values must be a list, got: %T", what, list);
+    throw std::invalid_argument(buf);
+  }
+  out.reserve(out.size() + length);
+  ERL_NIF_TERM head, tail = list;
+  while (enif_get_list_cell(env, tail, &head, &tail)) {
+    out.push_back(head);
+  }
+}
+
+static bool native_encodable(const TypeRef& type) {
+  switch (type->GetCode()) {
+  case Type::UInt8: case Type::UInt16: case Type::UInt32: case Type::UInt64:
+  case Type::Int8: case Type::Int16: case Type::Int32: case Type::Int64:
+  case Type::Float32: case Type::Float64:
+  case Type::String: case Type::Date: case Type::DateTime: case Type::DateTime64:
+  case Type::UUID:
+  case Type::Decimal: case Type::Decimal32: case Type::Decimal64: case Type::Decimal128:
+    return true;
+  case Type::Nullable:
+    return native_encodable(type->As<NullableType>()->GetNestedType());
+  case Type::Array:
+    return native_encodable(type->As<ArrayType>()->GetItemType());
+  default:
+    return false;
+  }
+}
+
+static void write_native_column(
+    ErlNifEnv *env, const TypeRef& type, const std::vector<ERL_NIF_TERM>& values,
+    bool nil_default, NativeWriter& out) {
+  switch (type->GetCode()) {
+  case Type::UInt64:
+    write_native_values<uint64_t>(env, values, nil_default, out, "UInt64",
+        [env](ERL_NIF_TERM t, uint64_t *v) { return get_native_integer(env, t, v); });
+    break;
+  case Type::UInt32:
+    write_native_values<uint32_t>(env, values, nil_default, out, "UInt32",
+        [env](ERL_NIF_TERM t, uint32_t *v) { return get_native_integer(env, t, v); });
+    break;
+  case Type::UInt16:
+    write_native_values<uint16_t>(env, values, nil_default, out, "UInt16",
+        [env](ERL_NIF_TERM t, uint16_t *v) { return get_native_integer(env, t, v); });
+    break;
+  case Type::UInt8:
+    write_native_values<uint8_t>(env, values, nil_default, out, "UInt8",
+        [env](ERL_NIF_TERM t, uint8_t *v) { return get_native_integer(env, t, v); });
+    break;
+  case Type::Int64:
+    write_native_values<int64_t>(env, values, nil_default, out, "Int64",
+        [env](ERL_NIF_TERM t, int64_t *v) { return get_native_integer(env, t, v); });
+    break;
+  case Type::Int32:
+    write_native_values<int32_t>(env, values, nil_default, out, "Int32",
+        [env](ERL_NIF_TERM t, int32_t *v) { return get_native_integer(env, t, v); });
+    break;
+  case Type::Int16:
+    write_native_values<int16_t>(env, values, nil_default, out, "Int16",
+        [env](ERL_NIF_TERM t, int16_t *v) { return get_native_integer(env, t, v); });
+    break;
+  case Type::Int8:
+    write_native_values<int8_t>(env, values, nil_default, out, "Int8",
+        [env](ERL_NIF_TERM t, int8_t *v) { return get_native_integer(env, t, v); });
+    break;
+  case Type::Float64:
+    write_native_values<double>(env, values, nil_default, out, "Float64",
+        [env](ERL_NIF_TERM t, double *v) { return get_list_number(env, t, v); });
+    break;
+  case Type::Float32:
+    write_native_values<float>(env, values, nil_default, out, "Float32",
+        [env](ERL_NIF_TERM t, float *v) {
+          double number;
+          if (!get_list_number(env, t, &number)) {
+            return false;
+          }
+          *v = static_cast<float>(number);
+          return true;
+        });
+    break;
+  case Type::Date:
+    write_native_values<uint16_t>(env, values, nil_default, out, "Date",
+        [env](ERL_NIF_TERM t, uint16_t *v) {
+          int64_t day;
+          if (decode_date(env, t, &day)) {
+            *v = date_days(env, t, day);
+            return true;
+          }
+          return get_native_integer(env, t, v);
+        });
+    break;
+  case Type::DateTime:
+    write_native_values<uint32_t>(env, values, nil_default, out, "DateTime",
+        [env](ERL_NIF_TERM t, uint32_t *v) {
+          int64_t seconds, micros;
+          if (decode_timestamp(env, t, &seconds, &micros)) {
+            *v = datetime_seconds(env, t, seconds);
+            return true;
+          }
+          return get_native_integer(env, t, v);
+        });
+    break;
+  case Type::DateTime64: {
+    // Same rescaling as column_datetime64_append_bulk
+    const size_t precision = type->As<DateTime64Type>()->GetPrecision();
+    int64_t ticks_per_second = 1;
+    for (size_t i = 0; i < precision; ++i) {
+      ticks_per_second *= 10;
+    }
+    write_native_values<int64_t>(env, values, nil_default, out, "DateTime64",
+        [env, precision, ticks_per_second](ERL_NIF_TERM t, int64_t *v) {
+          int64_t seconds, micros;
+          if (decode_timestamp(env, t, &seconds, &micros)) {
+            int64_t fraction = precision >= 6
+                ? micros * (ticks_per_second / 1000000)
+                : micros / (1000000 / ticks_per_second);
+            *v = seconds * ticks_per_second + fraction;
+            return true;
+          }
+          return get_native_integer(env, t, v);
+        });
+    break;
+  }
+  case Type::Decimal:
+  case Type::Decimal32:
+  case Type::Decimal64:
+  case Type::Decimal128: {
+    // Same scaling as column_decimal_append_bulk; stored as Int32, Int64 or
+    // Int128 depending on precision
+    auto decimal_type = type->As<DecimalType>();
+    const size_t scale = decimal_type->GetScale();
+    const size_t precision = decimal_type->GetPrecision();
+    const double multiplier = std::pow(10.0, static_cast<double>(scale));
+    const std::string type_name = type->GetName();
+    auto out_of_range = [env, &type_name](ERL_NIF_TERM t) {
+      char buf[256];
+      enif_snprintf(buf, sizeof(buf), "Decimal value out of range for %s column: %T",
+                    type_name.c_str(), t);
+      throw std::invalid_argument(buf);
+    };
+    auto scaled = [env, scale, multiplier, &out_of_range](ERL_NIF_TERM t, int64_t *v) {
+      ErlNifSInt64 integer;
+      double number;
+      if (enif_get_int64(env, t, &integer)) {
+        *v = integer;
+      } else if (enif_get_double(env, t, &number)) {
+        // Converting a double outside int64 is undefined; 2^63 is exact
+        double value = std::trunc(number * multiplier);
+        if (!(value >= -9223372036854775808.0 && value < 9223372036854775808.0)) {
+          out_of_range(t);
+        }
+        *v = static_cast<int64_t>(value);
+      } else if (is_struct(env, t, atoms::ElixirDecimal)) {
+        *v = decode_decimal(env, t, scale);
+      } else {
+        return false;
+      }
+      return true;
+    };
+
+    if (precision <= 9) {
+      write_native_values<int32_t>(env, values, nil_default, out, "Decimal",
+          [&scaled, &out_of_range](ERL_NIF_TERM t, int32_t *v) {
+            int64_t value;
+            if (!scaled(t, &value)) {
+              return false;
+            }
+            if (value < INT32_MIN || value > INT32_MAX) {
+              out_of_range(t);
+            }
+            *v = static_cast<int32_t>(value);
+            return true;
+          });
+    } else if (precision <= 18) {
+      write_native_values<int64_t>(env, values, nil_default, out, "Decimal", scaled);
+    } else {
+      // Little-endian Int128: low half, then the sign-extended high half
+      struct Int128Halves {
+        uint64_t low;
+        int64_t high;
+      };
+      write_native_values<Int128Halves>(env, values, nil_default, out, "Decimal",
+          [&scaled](ERL_NIF_TERM t, Int128Halves *v) {
+            int64_t value;
+            if (!scaled(t, &value)) {
+              return false;
+            }
+            *v = {static_cast<uint64_t>(value), value < 0 ? -1 : 0};
+            return true;
+          });
+    }
+    break;
+  }
+  case Type::UUID:
+    // Two UInt64 halves per value, high first
+    write_native_values<UUID>(env, values, nil_default, out, "UUID",
+        [env](ERL_NIF_TERM t, UUID *v) { return get_native_uuid(env, t, v); });
+    break;
+  case Type::String: {
+    ERL_NIF_TERM nil = fine::encode(env, atoms::nil);
+    for (ERL_NIF_TERM term : values) {
+      ErlNifBinary bin;
+      if (nil_default && enif_is_identical(term, nil)) {
+        out.WriteVarint(0);
+        continue;
+      }
+      if (!enif_inspect_binary(env, term, &bin)) {
+        raise_invalid_value("string", term);
+      }
+      out.WriteVarint(bin.size);
+      if (bin.size > 0) {
+        std::memcpy(out.Extend(bin.size), bin.data, bin.size);
+      }
+    }
+    break;
+  }
+  case Type::Nullable: {
+    // Null map, then the nested data with defaults in the null slots
+    ERL_NIF_TERM nil = fine::encode(env, atoms::nil);
+    uint8_t* nulls = out.Extend(values.size());
+    for (size_t i = 0; i < values.size(); i++) {
+      nulls[i] = enif_is_identical(values[i], nil) ? 1 : 0;
+    }
+    write_native_column(env, type->As<NullableType>()->GetNestedType(), values, true, out);
+    break;
+  }
+  case Type::Array: {
+    // Cumulative UInt64 offsets, then every row's elements flattened
+    ERL_NIF_TERM nil = fine::encode(env, atoms::nil);
+    std::vector<ERL_NIF_TERM> elements;
+    uint8_t* offsets = out.Extend(values.size() * sizeof(uint64_t));
+    for (size_t i = 0; i < values.size(); i++) {
+      if (!(nil_default && enif_is_identical(values[i], nil))) {
+        list_terms(env, values[i], elements, "Array");
+      }
+      uint64_t offset = elements.size();
+      std::memcpy(offsets + i * sizeof(uint64_t), &offset, sizeof(uint64_t));
+    }
+    write_native_column(env, type->As<ArrayType>()->GetItemType(), elements, false, out);
+    break;
+  }
+  default:
+    throw std::invalid_argument("Type " + type->GetName() + " cannot be encoded directly");
+  }
+}
+
+// Encode a list of values as the Native data of a column of `type_name`
+fine::Term column_encode_native(ErlNifEnv *env, std::string type_name, fine::Term values) {
+  try {
+    auto column = CreateColumnByType(type_name);
+    if (!column || !native_encodable(column->Type())) {
+      throw std::invalid_argument("Type " + type_name + " cannot be encoded directly");
+    }
+
+    std::vector<ERL_NIF_TERM> terms;
+    list_terms(env, values, terms, type_name.c_str());
+    NativeWriter out;
+    write_native_column(env, column->Type(), terms, false, out);
+    return out.Finish(env);
+  } catch (const std::invalid_argument&) {
+    throw;
+  } catch (const std::exception& e) {
+    throw std::runtime_error(encode_clickhouse_error(e));
+  }
+}
+FINE_NIF(column_encode_native, ERL_NIF_DIRTY_JOB_CPU_BOUND);
+
+// Native data of a built column, as Column::Save writes it
+fine::Term column_save_native(ErlNifEnv *env, fine::ResourcePtr<ColumnResource> col_res) {
+  try {
+    Buffer buffer;
+    BufferOutput output(&buffer);
+    col_res->ptr->Save(&output);
+    output.Flush();
+
+    ERL_NIF_TERM term;
+    unsigned char* data = enif_make_new_binary(env, buffer.size(), &term);
+    std::memcpy(data, buffer.data(), buffer.size());
+    return term;
+  } catch (const std::exception& e) {
+    throw std::runtime_error(encode_clickhouse_error(e));
+  }
+}
+FINE_NIF(column_save_native, ERL_NIF_DIRTY_JOB_CPU_BOUND);
@@ -0,0 +1,389 @@
+#include <fine.hpp>
+#include <clickhouse/client.h>
+#include <clickhouse/block.h>
+#include <clickhouse/columns/factory.h>
+#include <clickhouse/columns/numeric.h>
+#include <clickhouse/columns/nullable.h>
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "error_encoding.h"
+#include "probes.h"
+
+using namespace clickhouse;
+
+namespace {
+
+// ============================================================================
+// Column casts
+// ============================================================================
+//
+// Numeric columns convert between any of the integer and float types, and
+// Nullable of those keep their null map while the nested column converts.
+// Integer targets reject values they cannot hold; floats truncate toward
+// zero, as ClickHouse's CAST does.
+
+template <typename To, typename From>
+bool fits(From value) {
+  if constexpr (std::is_floating_point_v<To>) {
+    return true;
+  } else if constexpr (std::is_floating_point_v<From>) {
+    // Compare in long double: the integer bounds round up as double
+    long double truncated = std::trunc(static_cast<long double>(value));
+    return std::isfinite(value) &&
+           truncated >= static_cast<long double>(std::numeric_limits<To>::min()) &&
+           truncated <= static_cast<long double>(std::numeric_limits<To>::max());
+  } else if constexpr (std::is_signed_v<From> == std::is_signed_v<To>) {
+    return value >= std::numeric_limits<To>::min() && value <= std::numeric_limits<To>::max();
+  } else if constexpr (std::is_signed_v<From>) {
+    return value >= 0 && static_cast<std::make_unsigned_t<From>>(value) <=
+                             std::numeric_limits<To>::max();
+  } else {
+    return value <= static_cast<std::make_unsigned_t<To>>(std::numeric_limits<To>::max());
+  }
+}
+
+// Call `f` with the column as its ColumnVector<T>; false if not numeric
+template <typename F>
+bool visit_numeric(const ColumnRef& col, F&& f) {
+  switch (col->GetType().GetCode()) {
+  case Type::UInt8: f(*col->As<ColumnUInt8>()); return true;
+  case Type::UInt16: f(*col->As<ColumnUInt16>()); return true;
+  case Type::UInt32: f(*col->As<ColumnUInt32>()); return true;
+  case Type::UInt64: f(*col->As<ColumnUInt64>()); return true;
+  case Type::Int8: f(*col->As<ColumnInt8>()); return true;
+  case Type::Int16: f(*col->As<ColumnInt16>()); return true;
+  case Type::Int32: f(*col->As<ColumnInt32>()); return true;
+  case Type::Int64: f(*col->As<ColumnInt64>()); return true;
+  case Type::Float32: f(*col->As<ColumnFloat32>()); return true;
+  case Type::Float64: f(*col->As<ColumnFloat64>()); return true;
+  default: return false;
+  }
+}
+
+// Convert `col` (named `name` in errors) to a new column of `type_name`
+ColumnRef cast_column(const ColumnRef& col, const std::string& name,
+                      const std::string& type_name) {
+  ColumnRef target = CreateColumnByType(type_name);
+  if (!target) {
+    throw std::invalid_argument("unknown cast type " + type_name + " for column " + name);
+  }
+  if (target->Type()->GetName() == col->Type()->GetName()) {
+    return col;
+  }
+
+  auto cannot_cast = [&]() {
+    return std::runtime_error("cannot cast column " + name + " from " +
+                              col->Type()->GetName() + " to " + type_name);
+  };
+
+  if (col->GetType().GetCode() == Type::Nullable &&
+      target->GetType().GetCode() == Type::Nullable) {
+    auto nullable = col->As<ColumnNullable>();
+    ColumnRef nested = cast_column(nullable->Nested(), name,
+                                   target->As<ColumnNullable>()->Nested()->Type()->GetName());
+    return std::make_shared<ColumnNullable>(nested, nullable->Nulls());
+  }
+
+  bool converted = false;
+  visit_numeric(col, [&](auto& from) {
+    visit_numeric(target, [&](auto& to) {
+      using From = std::decay_t<decltype(from.At(0))>;
+      using To = std::decay_t<decltype(to.At(0))>;
+      auto& values = from.GetWritableData();
+      to.Reserve(values.size());
+      for (From value : values) {
+        if (!fits<To>(value)) {
+          throw std::runtime_error("value out of range casting column " + name + " to " +
+                                   type_name);
+        }
+        to.Append(static_cast<To>(value));
+      }
+      converted = true;
+    });
+  });
+  if (!converted) {
+    throw cannot_cast();
+  }
+  return target;
+}
+
+// ============================================================================
+// Block forwarding
+// ============================================================================
+
+struct CopyOptions {
+  std::unordered_map<std::string, std::string> rename;
+  // Keyed by destination (renamed) column name
+  std::unordered_map<std::string, std::string> cast;
+  size_t max_queued_blocks;
+  // Rows gathered from source blocks before they go out as one INSERT
+  size_t min_insert_rows;
+};
+
+// Rename and cast the columns of a received block for the destination
+Block transform_block(const Block& block, const CopyOptions& opts) {
+  if (opts.rename.empty() && opts.cast.empty()) {
+    return block;
+  }
+
+  Block out(block.GetColumnCount(), block.GetRowCount());
+  for (Block::Iterator it(block); it.IsValid(); it.Next()) {
+    std::string name = it.Name();
+    if (auto renamed = opts.rename.find(name); renamed != opts.rename.end()) {
+      name = renamed->second;
+    }
+    ColumnRef column = it.Column();
+    if (auto cast = opts.cast.find(name); cast != opts.cast.end()) {
+      column = cast_column(column, name, cast->second);
+    }
+    out.AppendColumn(name, column);
+  }
+  return out;
+}
+
+// Bounded hand-off from the SELECT callback to the insert thread. A full
+// queue blocks the callback, which stops reading from the source socket,
+// so a slow destination throttles the source instead of buffering it.
+class BlockQueue {
+public:
+  explicit BlockQueue(size_t capacity) : capacity_(std::max<size_t>(capacity, 1)) {}
+
+  // False once the consumer has failed; the block is dropped
+  bool Push(Block block) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_full_.wait(lock, [this] { return blocks_.size() < capacity_ || failed_; });
+    if (failed_) {
+      return false;
+    }
+    blocks_.push_back(std::move(block));
+    not_empty_.notify_one();
+    return true;
+  }
+
+  // The next block, or nothing once closed and drained
+  std::optional<Block> Pop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_empty_.wait(lock, [this] { return !blocks_.empty() || closed_; });
+    if (blocks_.empty()) {
+      return std::nullopt;
+    }
+    Block block = std::move(blocks_.front());
+    blocks_.pop_front();
+    not_full_.notify_one();
+    return block;
+  }
+
+  void Close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    not_empty_.notify_all();
+  }
+
+  // Stop accepting blocks and release a waiting producer
+  void Fail() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    failed_ = true;
+    blocks_.clear();
+    not_full_.notify_all();
+  }
+
+  bool Failed() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return failed_;
+  }
+
+private:
+  size_t capacity_;
+  std::mutex mutex_;
+  std::condition_variable not_full_;
+  std::condition_variable not_empty_;
+  std::deque<Block> blocks_;
+  bool closed_ = false;
+  bool failed_ = false;
+};
+
+// Source blocks merged into one INSERT. Each INSERT makes a part on a
+// MergeTree destination, so sending every source block (max_block_size
+// rows, 65505 by default) on its own floods the table with small parts.
+class InsertBatch {
+public:
+  void Add(Block block) {
+    if (parts_ == 0) {
+      block_ = std::move(block);
+    } else {
+      if (parts_ == 1) {
+        // The first block may share its columns with the source; copy them
+        // before appending
+        block_ = own_columns(block_);
+      }
+      for (size_t i = 0; i < block_.GetColumnCount(); i++) {
+        block_[i]->Append(block[i]);
+      }
+      block_.RefreshRowCount();
+    }
+    parts_++;
+  }
+
+  size_t Rows() const { return parts_ ? block_.GetRowCount() : 0; }
+
+  size_t Parts() const { return parts_; }
+
+  // The merged block; the batch starts over empty
+  Block Take() {
+    parts_ = 0;
+    return std::move(block_);
+  }
+
+private:
+  static Block own_columns(const Block& block) {
+    Block owned(block.GetColumnCount(), block.GetRowCount());
+    for (Block::Iterator it(block); it.IsValid(); it.Next()) {
+      ColumnRef column = it.Column()->CloneEmpty();
+      column->Append(it.Column());
+      owned.AppendColumn(it.Name(), column);
+    }
+    return owned;
+  }
+
+  Block block_;
+  size_t parts_ = 0;
+};
+
+// Mark an encoded error with the connection it came from, "source" or
+// "destination", so the caller can charge the right endpoint
+std::string with_side(const std::string& error_json, const char* side) {
+  return std::string("{\"side\":\"") + side + "\"," + error_json.substr(1);
+}
+
+}  // namespace
+
+// Copy the result of `sql` on `src` into `table` on `dst`
+//
+// Blocks go from the source's SELECT callback (this dirty scheduler thread)
+// through a bounded queue to an insert thread writing to the destination,
+// so reading and writing overlap and no value becomes a term. The insert
+// thread merges blocks into INSERTs of at least min_insert_rows rows (the
+// last may be smaller); clickhouse-cpp has no call to stream blocks into a
+// single open INSERT. Returns %{rows: n, blocks: n, inserts: n} as
+// inserted. Errors from either connection carry its side; a failed cast
+// carries none.
+fine::Term client_copy(
+    ErlNifEnv *env,
+    fine::ResourcePtr<Client> src,
+    std::string sql,
+    fine::ResourcePtr<Client> dst,
+    std::string table,
+    std::vector<std::tuple<std::string, std::string>> rename,
+    std::vector<std::tuple<std::string, std::string>> cast,
+    uint64_t max_queued_blocks,
+    uint64_t min_insert_rows) {
+  CopyOptions opts;
+  for (auto& [from, to] : rename) {
+    opts.rename.emplace(std::move(from), std::move(to));
+  }
+  for (auto& [column, type_name] : cast) {
+    opts.cast.emplace(std::move(column), std::move(type_name));
+  }
+  opts.max_queued_blocks = max_queued_blocks;
+  opts.min_insert_rows = min_insert_rows;
+
+  BlockQueue queue(opts.max_queued_blocks);
+  uint64_t rows = 0;
+  uint64_t blocks = 0;
+  uint64_t inserts = 0;
+  std::string insert_error;
+
+  std::thread inserter([&] {
+    InsertBatch batch;
+    auto flush = [&] {
+      size_t parts = batch.Parts();
+      Block block = batch.Take();
+      NATCH_PROBE2(insert__start, table.c_str(), block.GetRowCount());
+      try {
+        dst->Insert(table, block);
+      } catch (const std::exception& e) {
+        NATCH_PROBE2(insert__error, table.c_str(), e.what());
+        insert_error = with_side(encode_clickhouse_error(e), "destination");
+        queue.Fail();
+        return false;
+      }
+      NATCH_PROBE1(insert__done, table.c_str());
+      rows += block.GetRowCount();
+      blocks += parts;
+      inserts++;
+      return true;
+    };
+
+    while (std::optional<Block> block = queue.Pop()) {
+      batch.Add(std::move(*block));
+      if (batch.Rows() >= opts.min_insert_rows && !flush()) {
+        return;
+      }
+    }
+    // Nothing left of a failed SELECT is inserted
+    if (batch.Parts() > 0 && !queue.Failed()) {
+      flush();
+    }
+  });
+
+  std::string select_error;
+  NATCH_PROBE1(query__start, sql.c_str());
+  try {
+    src->SelectCancelable(sql, [&](const Block& block) {
+      // The header block carries no rows
+      if (block.GetRowCount() == 0) {
+        return !queue.Failed();
+      }
+      NATCH_PROBE2(block__receive, block.GetRowCount(), block.GetColumnCount());
+      Block transformed;
+      try {
+        transformed = transform_block(block, opts);
+      } catch (const std::exception& e) {
+        // Cancel rather than throw through Select, so the source connection
+        // drains the rest of the result and stays usable
+        select_error = encode_clickhouse_error(e);
+        queue.Fail();
+        return false;
+      }
+      return queue.Push(std::move(transformed));
+    });
+  } catch (const std::exception& e) {
+    NATCH_PROBE1(query__error, e.what());
+    select_error = with_side(encode_clickhouse_error(e), "source");
+    queue.Fail();
+  }
+  queue.Close();
+  inserter.join();
+
+  // A failed insert or cast cancels the SELECT, so its error is the cause
+  if (!insert_error.empty()) {
+    throw std::runtime_error(insert_error);
+  }
+  if (!select_error.empty()) {
+    throw std::runtime_error(select_error);
+  }
+  NATCH_PROBE1(query__done, rows);
+
+  ERL_NIF_TERM keys[] = {enif_make_atom(env, "rows"), enif_make_atom(env, "blocks"),
+                         enif_make_atom(env, "inserts")};
+  ERL_NIF_TERM values[] = {enif_make_uint64(env, rows), enif_make_uint64(env, blocks),
+                           enif_make_uint64(env, inserts)};
+  ERL_NIF_TERM result;
+  enif_make_map_from_arrays(env, keys, values, 3, &result);
+  return result;
+}
+
+FINE_NIF(client_copy, ERL_NIF_DIRTY_JOB_IO_BOUND);
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <string_view>
+
+// Runtime ISA selection for the kernels in simd_kernels.cpp
+//
+// The library is built for the baseline ISA. The kernels are additionally
+// compiled per target with function attributes, and one level is chosen
+// from cpuid when the NIF library loads, so one artifact runs everywhere
+// and uses the widest registers the host has. NATCH_CPU_LEVEL in the
+// environment (scalar, sse4_2, avx2, avx512), or cpu_level_set/1 at run
+// time, lowers the choice; neither can raise it above what the CPU reports.
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__)) && \
+    !defined(NATCH_DISABLE_SIMD_DISPATCH)
+#define NATCH_X86_DISPATCH 1
+#else
+#define NATCH_X86_DISPATCH 0
+#endif
+
+enum class CpuLevel : uint8_t { Scalar, SSE42, AVX2, AVX512 };
+
+inline const char* cpu_level_name(CpuLevel level) {
+  switch (level) {
+  case CpuLevel::SSE42: return "sse4_2";
+  case CpuLevel::AVX2: return "avx2";
+  case CpuLevel::AVX512: return "avx512";
+  default: return "scalar";
+  }
+}
+
+inline bool parse_cpu_level(std::string_view name, CpuLevel& level) {
+  for (CpuLevel candidate : {CpuLevel::Scalar, CpuLevel::SSE42, CpuLevel::AVX2, CpuLevel::AVX512}) {
+    if (name == cpu_level_name(candidate)) {
+      level = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Highest level the CPU supports. __builtin_cpu_supports also checks that
+// the OS saves the AVX and AVX-512 register state.
+inline CpuLevel detect_cpu_level() {
+#if NATCH_X86_DISPATCH
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+      __builtin_cpu_supports("avx512vl")) {
+    return CpuLevel::AVX512;
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    return CpuLevel::AVX2;
+  }
+  if (__builtin_cpu_supports("sse4.2")) {
+    return CpuLevel::SSE42;
+  }
+#endif
+  return CpuLevel::Scalar;
+}
+
+class CpuDispatch {
+public:
+  static CpuDispatch& Global() {
+    static CpuDispatch dispatch;
+    return dispatch;
+  }
+
+  // Read once per kernel call, so a change applies from the next call
+  CpuLevel Level() const { return level_.load(std::memory_order_relaxed); }
+
+  CpuLevel Detected() const { return detected_; }
+
+  // False, leaving the level as is, if the CPU lacks `level`
+  bool Set(CpuLevel level) {
+    if (level > detected_) {
+      return false;
+    }
+    level_.store(level, std::memory_order_relaxed);
+    return true;
+  }
+
+private:
+  CpuDispatch() : detected_(detect_cpu_level()), level_(detected_) {
+    CpuLevel requested;
+    if (const char* env = std::getenv("NATCH_CPU_LEVEL"); env && parse_cpu_level(env, requested)) {
+      level_.store(std::min(requested, detected_), std::memory_order_relaxed);
+    }
+  }
+
+  const CpuLevel detected_;
+  std::atomic<CpuLevel> level_;
+};
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <clickhouse/types/types.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Per-type decode cost counters for the SELECT decoders
+//
+// Time and binary bytes are exclusive: an Array(UUID) column charges the
+// offset slicing to Array and the UUID formatting to UUID, so a slow query
+// points at the type that actually costs. Only queries that ask for them
+// are measured: they count into a DecodeTally of their own, which is added
+// to the process-wide counters (select_decode_stats/0) once at the end.
+struct DecodeTally {
+  static constexpr size_t kMaxCodes = 64;
+
+  struct Counters {
+    uint64_t values = 0;
+    uint64_t nanoseconds = 0;
+    uint64_t binary_bytes = 0;
+  };
+
+  void Record(clickhouse::Type::Code code, uint64_t values, uint64_t nanoseconds, uint64_t binary_bytes) {
+    Counters& counters = codes[Index(code)];
+    counters.values += values;
+    counters.nanoseconds += nanoseconds;
+    counters.binary_bytes += binary_bytes;
+  }
+
+  static size_t Index(clickhouse::Type::Code code) {
+    size_t i = static_cast<size_t>(code);
+    return i < kMaxCodes ? i : 0;
+  }
+
+  std::array<Counters, kMaxCodes> codes{};
+};
+
+class DecodeStats {
+public:
+  static constexpr size_t kMaxCodes = DecodeTally::kMaxCodes;
+
+  static DecodeStats& Global() {
+    static DecodeStats stats;
+    return stats;
+  }
+
+  void Add(const DecodeTally& tally) {
+    for (size_t i = 0; i < kMaxCodes; i++) {
+      const DecodeTally::Counters& counters = tally.codes[i];
+      if (counters.values == 0) {
+        continue;
+      }
+      values_[i].fetch_add(counters.values, std::memory_order_relaxed);
+      nanoseconds_[i].fetch_add(counters.nanoseconds, std::memory_order_relaxed);
+      binary_bytes_[i].fetch_add(counters.binary_bytes, std::memory_order_relaxed);
+    }
+  }
+
+  DecodeTally Snapshot() const {
+    DecodeTally tally;
+    for (size_t i = 0; i < kMaxCodes; i++) {
+      tally.codes[i] = {values_[i].load(std::memory_order_relaxed),
+                        nanoseconds_[i].load(std::memory_order_relaxed),
+                        binary_bytes_[i].load(std::memory_order_relaxed)};
+    }
+    return tally;
+  }
+
+  void Reset() {
+    for (size_t i = 0; i < kMaxCodes; i++) {
+      values_[i].store(0, std::memory_order_relaxed);
+      nanoseconds_[i].store(0, std::memory_order_relaxed);
+      binary_bytes_[i].store(0, std::memory_order_relaxed);
+    }
+  }
+
+private:
+  std::array<std::atomic<uint64_t>, kMaxCodes> values_{};
+  std::array<std::atomic<uint64_t>, kMaxCodes> nanoseconds_{};
+  std::array<std::atomic<uint64_t>, kMaxCodes> binary_bytes_{};
+};
+
+// Times one append_column_terms call and charges it to its type code
+//
+// Nested decoders run inside the parent's scope; each scope subtracts the
+// time and bytes its children reported so only its own work is recorded.
+// Outside a QueryGuard a scope does nothing, so queries that don't ask for
+// stats read no clock.
+class DecodeScope {
+public:
+  DecodeScope(clickhouse::Type::Code code, size_t values) : tally_(query_tally_) {
+    if (!tally_) {
+      return;
+    }
+    code_ = code;
+    values_ = values;
+    saved_child_ns_ = child_ns_;
+    saved_bytes_ = binary_bytes_;
+    child_ns_ = 0;
+    binary_bytes_ = 0;
+    start_ = std::chrono::steady_clock::now();
+  }
+
+  ~DecodeScope() {
+    if (!tally_) {
+      return;
+    }
+    uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start_).count();
+    uint64_t self_ns = elapsed > child_ns_ ? elapsed - child_ns_ : 0;
+
+    tally_->Record(code_, values_, self_ns, binary_bytes_);
+
+    child_ns_ = saved_child_ns_ + elapsed;
+    binary_bytes_ = saved_bytes_;
+  }
+
+  DecodeScope(const DecodeScope&) = delete;
+  DecodeScope& operator=(const DecodeScope&) = delete;
+
+  // Called by make_binary_term for every binary it allocates
+  static void CountBinary(size_t bytes) { binary_bytes_ += bytes; }
+
+  // Count this thread's decodes into `tally` for the lifetime of the guard;
+  // with nullptr, don't measure them
+  class QueryGuard {
+  public:
+    explicit QueryGuard(DecodeTally* tally) : saved_(query_tally_) { query_tally_ = tally; }
+    ~QueryGuard() { query_tally_ = saved_; }
+
+    QueryGuard(const QueryGuard&) = delete;
+    QueryGuard& operator=(const QueryGuard&) = delete;
+
+  private:
+    DecodeTally* saved_;
+  };
+
+private:
+  static inline thread_local uint64_t child_ns_ = 0;
+  static inline thread_local uint64_t binary_bytes_ = 0;
+  static inline thread_local DecodeTally* query_tally_ = nullptr;
+
+  DecodeTally* tally_;
+  clickhouse::Type::Code code_{};
+  size_t values_ = 0;
+  std::chrono::steady_clock::time_point start_;
+  uint64_t saved_child_ns_ = 0;
+  uint64_t saved_bytes_ = 0;
+};
@@ -0,0 +1,322 @@
+#include <fine.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+// splitmix64 finalizer: spreads combined column hashes over all 64 bits
+inline uint64_t mix64(uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
+}
+
+// enif_hash yields 32 bits; two salts make a 64-bit term hash. The internal
+// hash differs between VM instances, which is fine for an in-memory filter.
+inline uint64_t term_hash(ERL_NIF_TERM term) {
+  return (enif_hash(ERL_NIF_INTERNAL_HASH, term, 0x9e3779b9) << 32) |
+         enif_hash(ERL_NIF_INTERNAL_HASH, term, 0x85ebca6b);
+}
+
+// Map a 64-bit hash onto [0, n) without a division
+inline uint64_t reduce(uint64_t hash, uint64_t n) {
+  return static_cast<uint64_t>((static_cast<unsigned __int128>(hash) * n) >> 64);
+}
+
+}  // namespace
+
+// Time-windowed Bloom filter over row keys, used by Natch.Dedup
+//
+// Checking and remembering keys are separate steps, so a key is only
+// remembered once its INSERT was acknowledged and a failed insert can be
+// retried. Two generations of equal size: keys are added to the current
+// one and looked up in both. Every half window the previous generation is dropped
+// and the current one takes its place, so a key is remembered for at least
+// half a window and at most a full one. A lookup never misses a key still
+// in the window; it reports an unseen key as seen with the configured
+// false-positive rate.
+class RecentKeys {
+public:
+  // Sized for `capacity` distinct keys per generation at `fp_rate`:
+  // m = -n ln p / ln(2)^2 bits and k = m / n ln 2 probes. `max_bytes`
+  // (0 = no limit) caps both generations together, raising the rate.
+  RecentKeys(uint64_t capacity, double fp_rate, uint64_t window_ms, uint64_t max_bytes)
+      : capacity_(std::max<uint64_t>(capacity, 1)),
+        half_window_(std::chrono::milliseconds(std::max<uint64_t>(window_ms / 2, 1))),
+        rotated_at_(std::chrono::steady_clock::now()) {
+    if (!(fp_rate > 0.0 && fp_rate < 1.0)) {
+      throw std::invalid_argument("false_positive_rate must be between 0.0 and 1.0");
+    }
+
+    const double ln2 = std::log(2.0);
+    double bits = std::ceil(-static_cast<double>(capacity_) * std::log(fp_rate) / (ln2 * ln2));
+    uint64_t words = std::max<uint64_t>(static_cast<uint64_t>(bits + 63) / 64, 1);
+    if (max_bytes > 0) {
+      words = std::max<uint64_t>(std::min<uint64_t>(words, max_bytes / 2 / sizeof(uint64_t)), 1);
+    }
+    bits_ = words * 64;
+    probes_ = static_cast<uint32_t>(std::clamp<double>(
+        std::round(static_cast<double>(bits_) / capacity_ * ln2), 1.0, 30.0));
+
+    current_.assign(words, 0);
+    previous_.assign(words, 0);
+  }
+
+  // Whether `hash` is present in either generation
+  bool Contains(uint64_t hash) const {
+    uint64_t h1 = hash;
+    uint64_t h2 = mix64(hash) | 1;
+    bool seen_current = true;
+    bool seen_previous = true;
+
+    for (uint32_t i = 0; i < probes_; i++) {
+      uint64_t bit = reduce(h1 + i * h2, bits_);
+      uint64_t word = bit >> 6;
+      uint64_t mask = 1ULL << (bit & 63);
+      seen_current &= (current_[word] & mask) != 0;
+      seen_previous &= (previous_[word] & mask) != 0;
+    }
+    return seen_current || seen_previous;
+  }
+
+  void Add(uint64_t hash) {
+    uint64_t h1 = hash;
+    uint64_t h2 = mix64(hash) | 1;
+
+    for (uint32_t i = 0; i < probes_; i++) {
+      uint64_t bit = reduce(h1 + i * h2, bits_);
+      current_[bit >> 6] |= 1ULL << (bit & 63);
+    }
+  }
+
+  void Rotate() {
+    auto now = std::chrono::steady_clock::now();
+    if (now - rotated_at_ < half_window_) {
+      return;
+    }
+
+    if (now - rotated_at_ >= 2 * half_window_) {
+      // Idle for a whole window: nothing in either generation is recent
+      std::fill(previous_.begin(), previous_.end(), 0);
+    } else {
+      previous_.swap(current_);
+    }
+    std::fill(current_.begin(), current_.end(), 0);
+    rotated_at_ = now;
+    rotations_++;
+  }
+
+  void Reset() {
+    std::fill(current_.begin(), current_.end(), 0);
+    std::fill(previous_.begin(), previous_.end(), 0);
+    rotated_at_ = std::chrono::steady_clock::now();
+  }
+
+  // Expected false-positive rate at `capacity` keys per generation, against
+  // both generations
+  double EffectiveRate() const {
+    double one = std::pow(1.0 - std::exp(-static_cast<double>(probes_) * capacity_ / bits_),
+                          static_cast<double>(probes_));
+    return 1.0 - (1.0 - one) * (1.0 - one);
+  }
+
+  ERL_NIF_TERM Stats(ErlNifEnv* env) const {
+    ERL_NIF_TERM keys[] = {
+      enif_make_atom(env, "memory_bytes"),
+      enif_make_atom(env, "capacity"),
+      enif_make_atom(env, "hash_functions"),
+      enif_make_atom(env, "false_positive_rate"),
+      enif_make_atom(env, "checked_rows"),
+      enif_make_atom(env, "dropped_rows"),
+      enif_make_atom(env, "rotations")
+    };
+    ERL_NIF_TERM values[] = {
+      enif_make_uint64(env, (current_.size() + previous_.size()) * sizeof(uint64_t)),
+      enif_make_uint64(env, capacity_),
+      enif_make_uint64(env, probes_),
+      enif_make_double(env, EffectiveRate()),
+      enif_make_uint64(env, checked_rows),
+      enif_make_uint64(env, dropped_rows),
+      enif_make_uint64(env, rotations_)
+    };
+
+    ERL_NIF_TERM map;
+    enif_make_map_from_arrays(env, keys, values, sizeof(keys) / sizeof(keys[0]), &map);
+    return map;
+  }
+
+  std::mutex mutex;
+  uint64_t checked_rows = 0;
+  uint64_t dropped_rows = 0;
+
+private:
+  uint64_t capacity_;
+  uint64_t bits_ = 0;
+  uint32_t probes_ = 1;
+  std::chrono::steady_clock::duration half_window_;
+  std::chrono::steady_clock::time_point rotated_at_;
+  uint64_t rotations_ = 0;
+  std::vector<uint64_t> current_;
+  std::vector<uint64_t> previous_;
+};
+
+FINE_RESOURCE(RecentKeys);
+
+// Create a filter; see RecentKeys for the sizing
+fine::ResourcePtr<RecentKeys> dedup_create(
+    ErlNifEnv *env,
+    uint64_t capacity,
+    double false_positive_rate,
+    uint64_t window_ms,
+    uint64_t max_bytes) {
+  return fine::make_resource<RecentKeys>(capacity, false_positive_rate, window_ms, max_bytes);
+}
+FINE_NIF(dedup_create, 0);
+
+// Drop the rows whose key was seen within the window, including earlier
+// rows of this call and the keys in `in_flight`, without remembering any
+// `keys` are the key column lists and `columns` every column list to
+// filter, one element per row each; `in_flight` is the pending binary of
+// an unacknowledged insert. Returns {filtered_columns, kept_rows, pending}
+// where pending holds the kept rows' key hashes for dedup_commit/2.
+fine::Term dedup_check(
+    ErlNifEnv *env,
+    fine::ResourcePtr<RecentKeys> dedup,
+    std::vector<fine::Term> keys,
+    std::vector<fine::Term> columns,
+    ErlNifBinary in_flight) {
+  if (keys.empty()) {
+    throw std::invalid_argument("dedup needs at least one key column");
+  }
+  if (in_flight.size % sizeof(uint64_t) != 0) {
+    throw std::invalid_argument("in_flight must be a pending binary from dedup_check");
+  }
+
+  unsigned rows = 0;
+  if (!enif_get_list_length(env, keys[0], &rows)) {
+    throw std::invalid_argument("key columns must be lists");
+  }
+  for (const auto& list : columns) {
+    unsigned length = 0;
+    if (!enif_get_list_length(env, list, &length) || length != rows) {
+      throw std::invalid_argument("all columns must be lists of the same length");
+    }
+  }
+
+  // Hash each row's key, folding in one key column at a time
+  std::vector<ERL_NIF_TERM> tails(keys.begin(), keys.end());
+  std::vector<uint64_t> hashes(rows, 0);
+  for (ERL_NIF_TERM& tail : tails) {
+    for (unsigned r = 0; r < rows; r++) {
+      ERL_NIF_TERM head;
+      if (!enif_get_list_cell(env, tail, &head, &tail)) {
+        throw std::invalid_argument("all columns must be lists of the same length");
+      }
+      hashes[r] = mix64(hashes[r] ^ term_hash(head));
+    }
+  }
+
+  // Keys of this call and of the insert in flight, which the filter
+  // doesn't hold yet
+  std::unordered_set<uint64_t> pending_keys;
+  pending_keys.reserve(rows + in_flight.size / sizeof(uint64_t));
+  for (size_t i = 0; i < in_flight.size; i += sizeof(uint64_t)) {
+    uint64_t hash;
+    std::memcpy(&hash, in_flight.data + i, sizeof(hash));
+    pending_keys.insert(hash);
+  }
+
+  std::vector<uint8_t> keep(rows, 1);
+  std::vector<uint64_t> kept_hashes;
+  kept_hashes.reserve(rows);
+  uint64_t dropped = 0;
+  {
+    std::lock_guard<std::mutex> lock(dedup->mutex);
+    dedup->Rotate();
+    for (unsigned r = 0; r < rows; r++) {
+      if (dedup->Contains(hashes[r]) || !pending_keys.insert(hashes[r]).second) {
+        keep[r] = 0;
+        dropped++;
+      } else {
+        kept_hashes.push_back(hashes[r]);
+      }
+    }
+    dedup->checked_rows += rows;
+    dedup->dropped_rows += dropped;
+  }
+
+  std::vector<ERL_NIF_TERM> filtered;
+  filtered.reserve(columns.size());
+  if (dropped == 0) {
+    filtered.assign(columns.begin(), columns.end());
+  } else {
+    std::vector<ERL_NIF_TERM> kept;
+    kept.reserve(rows - dropped);
+    for (const auto& list : columns) {
+      ERL_NIF_TERM head;
+      ERL_NIF_TERM tail = list;
+      kept.clear();
+      for (unsigned r = 0; enif_get_list_cell(env, tail, &head, &tail); r++) {
+        if (keep[r]) {
+          kept.push_back(head);
+        }
+      }
+      filtered.push_back(enif_make_list_from_array(env, kept.data(), kept.size()));
+    }
+  }
+
+  ERL_NIF_TERM pending;
+  size_t pending_size = kept_hashes.size() * sizeof(uint64_t);
+  unsigned char* pending_data = enif_make_new_binary(env, pending_size, &pending);
+  if (pending_size > 0) {
+    std::memcpy(pending_data, kept_hashes.data(), pending_size);
+  }
+
+  return enif_make_tuple3(env,
+                          enif_make_list_from_array(env, filtered.data(), filtered.size()),
+                          enif_make_uint64(env, rows - dropped),
+                          pending);
+}
+FINE_NIF(dedup_check, ERL_NIF_DIRTY_JOB_CPU_BOUND);
+
+// Remember the keys of a pending binary from dedup_check/4, once the rows
+// it kept were inserted
+fine::Atom dedup_commit(ErlNifEnv *env, fine::ResourcePtr<RecentKeys> dedup, ErlNifBinary pending) {
+  if (pending.size % sizeof(uint64_t) != 0) {
+    throw std::invalid_argument("not a pending binary from dedup_check");
+  }
+
+  std::lock_guard<std::mutex> lock(dedup->mutex);
+  dedup->Rotate();
+  for (size_t i = 0; i < pending.size; i += sizeof(uint64_t)) {
+    uint64_t hash;
+    std::memcpy(&hash, pending.data + i, sizeof(hash));
+    dedup->Add(hash);
+  }
+  return fine::Atom("ok");
+}
+FINE_NIF(dedup_commit, ERL_NIF_DIRTY_JOB_CPU_BOUND);
+
+fine::Term dedup_stats(ErlNifEnv *env, fine::ResourcePtr<RecentKeys> dedup) {
+  std::lock_guard<std::mutex> lock(dedup->mutex);
+  return dedup->Stats(env);
+}
+FINE_NIF(dedup_stats, 0);
+
+// Forget every key
+fine::Atom dedup_reset(ErlNifEnv *env, fine::ResourcePtr<RecentKeys> dedup) {
+  std::lock_guard<std::mutex> lock(dedup->mutex);
+  dedup->Reset();
+  return fine::Atom("ok");
+}
+FINE_NIF(dedup_reset, 0);
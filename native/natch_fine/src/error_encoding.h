@@ -66,10 +66,15 @@ inline std::string encode_clickhouse_error(const std::exception& e) {
     error_json = "{\"type\":\"compression\",\"message\":\"" + escape_json_string(e.what()) + "\"}";
 
   } else if (const auto* sys_err = dynamic_cast<const std::system_error*>(&e)) {
-    // System errors (DNS, network, etc.)
+    // System errors (DNS, network, etc.). A receive that hit the socket's
+    // recv timeout fails with EAGAIN: the server is up but slow to answer.
+    const std::error_code& code = sys_err->code();
+    bool timeout = code == std::errc::resource_unavailable_try_again ||
+                   code == std::errc::operation_would_block;
     error_json = "{\"type\":\"connection\",";
     error_json += "\"message\":\"" + escape_json_string(sys_err->what()) + "\",";
-    error_json += "\"code\":" + std::to_string(sys_err->code().value()) + "}";
+    error_json += "\"code\":" + std::to_string(code.value());
+    error_json += timeout ? ",\"timeout\":true}" : "}";
 
   } else {
     // Unknown exception type
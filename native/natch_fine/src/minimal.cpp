@@ -6,6 +6,8 @@
 #include <stdexcept>
 #include <system_error>
 #include <map>
+#include "client_options.h"
+#include "probes.h"
 
 using namespace clickhouse;
 
@@ -110,55 +112,21 @@ fine::ResourcePtr<Client> client_create(
     uint64_t recv_timeout,
     uint64_t send_timeout) {
   try {
-    ClientOptions opts;
-    opts.SetHost(host);
-    opts.SetPort(static_cast<uint16_t>(port));
-
-    if (!database.empty()) {
-      opts.SetDefaultDatabase(database);
-    }
-
-    if (!user.empty()) {
-      opts.SetUser(user);
-    }
-
-    if (!password.empty()) {
-      opts.SetPassword(password);
-    }
-
-    if (compression) {
-      opts.SetCompressionMethod(CompressionMethod::LZ4);
-    }
-
-    if (ssl) {
-      // Enable SSL with default settings:
-      // - Use system CA certificates for verification
-      // - Verify peer certificate
-      // - Enable SNI
-      ClientOptions::SSLOptions ssl_opts;
-      ssl_opts.SetUseDefaultCALocations(true);
-      ssl_opts.SetUseSNI(true);
-      opts.SetSSLOptions(ssl_opts);
-    }
-
-    // Set socket-level timeouts
-    opts.SetConnectionConnectTimeout(std::chrono::milliseconds(connect_timeout));
-    opts.SetConnectionRecvTimeout(std::chrono::milliseconds(recv_timeout));
-    opts.SetConnectionSendTimeout(std::chrono::milliseconds(send_timeout));
-
+    ClientOptions opts = make_client_options(host, port, database, user, password, compression,
+                                             ssl, connect_timeout, recv_timeout, send_timeout);
     return fine::make_resource<Client>(opts);
   } catch (const std::exception& e) {
     // Use generic encoder to extract rich error information
     throw std::runtime_error(encode_clickhouse_error(e));
   }
 }
-FINE_NIF(client_create, 0);
+FINE_NIF(client_create, ERL_NIF_DIRTY_JOB_IO_BOUND);
 
 // Simple client creation (for PoC compatibility)
 fine::ResourcePtr<Client> create_client(ErlNifEnv *env) {
   return client_create(env, "localhost", 9000, "", "", "", false, false, 5000, 0, 0);
 }
-FINE_NIF(create_client, 0);
+FINE_NIF(create_client, ERL_NIF_DIRTY_JOB_IO_BOUND);
 
 // Ping the ClickHouse server
 std::string client_ping(ErlNifEnv *env, fine::ResourcePtr<Client> client) {
@@ -169,13 +137,13 @@ std::string client_ping(ErlNifEnv *env, fine::ResourcePtr<Client> client) {
     throw std::runtime_error(encode_clickhouse_error(e));
   }
 }
-FINE_NIF(client_ping, 0);
+FINE_NIF(client_ping, ERL_NIF_DIRTY_JOB_IO_BOUND);
 
 // Alias for backwards compatibility with PoC
 std::string ping(ErlNifEnv *env, fine::ResourcePtr<Client> client) {
   return client_ping(env, client);
 }
-FINE_NIF(ping, 0);
+FINE_NIF(ping, ERL_NIF_DIRTY_JOB_IO_BOUND);
 
 // Execute a query (DDL/DML without results)
 // Returns :ok atom on success
@@ -183,14 +151,17 @@ fine::Atom client_execute(
     ErlNifEnv *env,
     fine::ResourcePtr<Client> client,
     std::string sql) {
+  NATCH_PROBE1(execute__start, sql.c_str());
   try {
     client->Execute(sql);
-    return fine::Atom("ok");
   } catch (const std::exception& e) {
+    NATCH_PROBE1(execute__error, e.what());
     throw std::runtime_error(encode_clickhouse_error(e));
   }
+  NATCH_PROBE(execute__done);
+  return fine::Atom("ok");
 }
-FINE_NIF(client_execute, 0);
+FINE_NIF(client_execute, ERL_NIF_DIRTY_JOB_IO_BOUND);
 
 // Execute parameterized query
 // Returns :ok atom on success
@@ -198,14 +169,17 @@ fine::Atom client_execute_parameterized(
     ErlNifEnv *env,
     fine::ResourcePtr<Client> client,
     fine::ResourcePtr<Query> query) {
+  NATCH_PROBE1(execute__start, query->GetText().c_str());
   try {
     client->Execute(*query);
-    return fine::Atom("ok");
   } catch (const std::exception& e) {
+    NATCH_PROBE1(execute__error, e.what());
     throw std::runtime_error(encode_clickhouse_error(e));
   }
+  NATCH_PROBE(execute__done);
+  return fine::Atom("ok");
 }
-FINE_NIF(client_execute_parameterized, 0);
+FINE_NIF(client_execute_parameterized, ERL_NIF_DIRTY_JOB_IO_BOUND);
 
 // Reset connection
 // Returns :ok atom on success
@@ -217,7 +191,7 @@ fine::Atom client_reset_connection(ErlNifEnv *env, fine::ResourcePtr<Client> cli
     throw std::runtime_error(encode_clickhouse_error(e));
   }
 }
-FINE_NIF(client_reset_connection, 0);
+FINE_NIF(client_reset_connection, ERL_NIF_DIRTY_JOB_IO_BOUND);
 
 // Initialize the NIF module
 FINE_INIT("Elixir.Natch.Native");
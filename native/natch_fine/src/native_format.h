@@ -0,0 +1,73 @@
+#pragma once
+
+#include <clickhouse/block.h>
+#include <clickhouse/exceptions.h>
+#include <clickhouse/base/buffer.h>
+#include <clickhouse/base/input.h>
+#include <clickhouse/base/output.h>
+#include <clickhouse/base/wire_format.h>
+#include <clickhouse/columns/factory.h>
+#include <cstdint>
+#include <string>
+
+// Blocks in ClickHouse's Native format, as produced by `FORMAT Native`:
+//
+//   varint columns, varint rows,
+//   then per column: string name, string type, column data
+//
+// Column data is written with Column::Save, the same encoding the client
+// sends on the wire, so a serialized block loads back into identical
+// columns with CreateColumnByType + Column::Load.
+
+inline void write_native_block(const clickhouse::Block& block, clickhouse::OutputStream& output) {
+  clickhouse::WireFormat::WriteUInt64(output, block.GetColumnCount());
+  clickhouse::WireFormat::WriteUInt64(output, block.GetRowCount());
+
+  for (clickhouse::Block::Iterator it(block); it.IsValid(); it.Next()) {
+    clickhouse::WireFormat::WriteString(output, it.Name());
+    clickhouse::WireFormat::WriteString(output, it.Type()->GetName());
+    it.Column()->Save(&output);
+  }
+}
+
+// Replaces the contents of `out` with the encoded block
+inline void write_native_block(const clickhouse::Block& block, clickhouse::Buffer* out) {
+  out->clear();
+  clickhouse::BufferOutput output(out);
+  write_native_block(block, output);
+  output.Flush();
+}
+
+inline clickhouse::Block read_native_block(clickhouse::InputStream& input) {
+  uint64_t columns = 0;
+  uint64_t rows = 0;
+  if (!clickhouse::WireFormat::ReadUInt64(input, &columns) ||
+      !clickhouse::WireFormat::ReadUInt64(input, &rows)) {
+    throw clickhouse::ProtocolError("truncated Native block header");
+  }
+
+  clickhouse::Block block(columns, rows);
+  for (uint64_t i = 0; i < columns; i++) {
+    std::string name;
+    std::string type;
+    if (!clickhouse::WireFormat::ReadString(input, &name) ||
+        !clickhouse::WireFormat::ReadString(input, &type)) {
+      throw clickhouse::ProtocolError("truncated Native column header");
+    }
+
+    clickhouse::ColumnRef column = clickhouse::CreateColumnByType(type);
+    if (!column) {
+      throw clickhouse::ProtocolError("unsupported column type in Native block: " + type);
+    }
+    if (rows > 0 && !column->Load(&input, rows)) {
+      throw clickhouse::ProtocolError("truncated Native data for column " + name);
+    }
+    block.AppendColumn(name, column);
+  }
+  return block;
+}
+
+inline clickhouse::Block read_native_block(const uint8_t* data, size_t size) {
+  clickhouse::ArrayInput input(data, size);
+  return read_native_block(input);
+}
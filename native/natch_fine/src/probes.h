@@ -0,0 +1,30 @@
+#pragma once
+
+// USDT tracepoints (provider "natch") on the native hot paths, for
+// bpftrace/perf on live nodes without rebuilding. They are compiled in only
+// when the NIF is built with NATCH_ENABLE_USDT (see CMakeLists.txt).
+// Otherwise every probe expands to nothing and its arguments are not
+// evaluated; when compiled in, an unattached probe is a single nop.
+//
+//   query__start(sql)             query__done(rows)       query__error(message)
+//   block__receive(rows, columns)
+//   decode__start(rows, columns)  decode__done(rows)
+//   insert__start(table, rows)    insert__done(table)     insert__error(table, message)
+//   execute__start(sql)           execute__done()         execute__error(message)
+//
+// List them with `bpftrace -l 'usdt:priv/natch_fine.so:*'`, e.g.
+//
+//   bpftrace -e 'usdt:priv/natch_fine.so:natch:decode__start { @s[tid] = nsecs; }
+//                usdt:priv/natch_fine.so:natch:decode__done /@s[tid]/ {
+//                  @decode_us = hist((nsecs - @s[tid]) / 1000); delete(@s[tid]); }'
+
+#if defined(NATCH_ENABLE_USDT)
+#include <sys/sdt.h>
+#define NATCH_PROBE(name) DTRACE_PROBE(natch, name)
+#define NATCH_PROBE1(name, a) DTRACE_PROBE1(natch, name, a)
+#define NATCH_PROBE2(name, a, b) DTRACE_PROBE2(natch, name, a, b)
+#else
+#define NATCH_PROBE(name) ((void)0)
+#define NATCH_PROBE1(name, a) ((void)0)
+#define NATCH_PROBE2(name, a, b) ((void)0)
+#endif
@@ -0,0 +1,525 @@
+#pragma once
+
+#include <fine.hpp>
+#include <clickhouse/block.h>
+#include <clickhouse/columns/column.h>
+#include <clickhouse/columns/numeric.h>
+#include <clickhouse/columns/string.h>
+#include <clickhouse/columns/date.h>
+#include <clickhouse/columns/nullable.h>
+#include <clickhouse/columns/lowcardinality.h>
+#include <clickhouse/columns/enum.h>
+#include <clickhouse/types/types.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include "simd_kernels.h"
+
+// Client-side row filtering for SELECT (the `filter:` select option)
+//
+// Predicates are evaluated per block over the raw column buffers, ANDed
+// into a byte mask, and turned into a selection vector of passing row
+// indices. The decoder then builds terms only for selected rows.
+//
+// Comparisons follow SQL: NULL never compares true, only :is_nil matches it.
+
+// Indices of the rows of a block that passed every predicate, ascending
+using RowSelection = std::vector<uint32_t>;
+
+enum class FilterOp { Eq, Ne, Lt, Le, Gt, Ge, In, NotIn, IsNil, NotNil };
+
+struct FilterValue {
+  enum Kind { Integer, Float, String } kind = Integer;
+  __int128 integer = 0;
+  double real = 0.0;
+  std::string string;
+  // `integer` is Unix microseconds from a DateTime or NaiveDateTime, to be
+  // compared in the column's unit (see timestamps_at)
+  bool timestamp = false;
+};
+
+struct RowPredicate {
+  std::string column;
+  FilterOp op = FilterOp::Eq;
+  std::vector<FilterValue> values;
+};
+
+// Sets this small are scanned linearly; larger ones are binary searched
+constexpr size_t kLinearInSet = 16;
+
+inline FilterValue decode_filter_value(ErlNifEnv *env, ERL_NIF_TERM term) {
+  FilterValue value;
+  ErlNifSInt64 signed_value;
+  ErlNifUInt64 unsigned_value;
+  ErlNifBinary binary;
+  int arity;
+  const ERL_NIF_TERM* elements;
+
+  if (enif_get_tuple(env, term, &arity, &elements) && arity == 2 &&
+      enif_is_identical(elements[0], enif_make_atom(env, "unix_us")) &&
+      enif_get_int64(env, elements[1], &signed_value)) {
+    value.integer = signed_value;
+    value.timestamp = true;
+  } else if (enif_get_int64(env, term, &signed_value)) {
+    value.integer = signed_value;
+  } else if (enif_get_uint64(env, term, &unsigned_value)) {
+    value.integer = unsigned_value;
+  } else if (enif_get_double(env, term, &value.real)) {
+    value.kind = FilterValue::Float;
+  } else if (enif_inspect_binary(env, term, &binary)) {
+    value.kind = FilterValue::String;
+    value.string.assign(reinterpret_cast<const char*>(binary.data), binary.size);
+  } else {
+    throw std::invalid_argument("filter values must be integers, floats or binaries");
+  }
+  return value;
+}
+
+inline FilterOp decode_filter_op(ErlNifEnv *env, ERL_NIF_TERM term) {
+  char name[16];
+  if (enif_get_atom(env, term, name, sizeof(name), ERL_NIF_LATIN1) <= 0) {
+    throw std::invalid_argument("filter operator must be an atom");
+  }
+
+  std::string_view op(name);
+  if (op == "==") return FilterOp::Eq;
+  if (op == "!=") return FilterOp::Ne;
+  if (op == "<") return FilterOp::Lt;
+  if (op == "<=") return FilterOp::Le;
+  if (op == ">") return FilterOp::Gt;
+  if (op == ">=") return FilterOp::Ge;
+  if (op == "in") return FilterOp::In;
+  if (op == "not_in") return FilterOp::NotIn;
+  if (op == "is_nil") return FilterOp::IsNil;
+  if (op == "not_nil") return FilterOp::NotNil;
+  throw std::invalid_argument("unknown filter operator: " + std::string(op));
+}
+
+// Decode [{column, op, value}]; :in/:not_in take a list, :is_nil/:not_nil
+// take nil (Elixir normalizes the user-facing forms)
+inline std::vector<RowPredicate> decode_row_filter(ErlNifEnv *env, ERL_NIF_TERM term) {
+  std::vector<RowPredicate> predicates;
+  ERL_NIF_TERM head;
+  ERL_NIF_TERM tail = term;
+
+  while (enif_get_list_cell(env, tail, &head, &tail)) {
+    int arity;
+    const ERL_NIF_TERM* elements;
+    if (!enif_get_tuple(env, head, &arity, &elements) || arity != 3) {
+      throw std::invalid_argument("filter predicates must be {column, op, value} tuples");
+    }
+
+    RowPredicate predicate;
+    predicate.column = fine::decode<std::string>(env, elements[0]);
+    predicate.op = decode_filter_op(env, elements[1]);
+
+    if (predicate.op == FilterOp::In || predicate.op == FilterOp::NotIn) {
+      ERL_NIF_TERM value;
+      ERL_NIF_TERM values = elements[2];
+      while (enif_get_list_cell(env, values, &value, &values)) {
+        predicate.values.push_back(decode_filter_value(env, value));
+      }
+    } else if (predicate.op != FilterOp::IsNil && predicate.op != FilterOp::NotNil) {
+      predicate.values.push_back(decode_filter_value(env, elements[2]));
+    }
+    predicates.push_back(std::move(predicate));
+  }
+  return predicates;
+}
+
+// mask[i] &= (get(i) op value); the op switch sits outside the loops so
+// each loop is a plain compare the compiler can vectorize
+template <typename T, typename Get>
+inline void compare_rows(size_t n, Get get, FilterOp op, const T& value, uint8_t* mask) {
+  switch (op) {
+  case FilterOp::Eq:
+    for (size_t i = 0; i < n; i++) mask[i] &= get(i) == value;
+    break;
+  case FilterOp::Ne:
+    for (size_t i = 0; i < n; i++) mask[i] &= get(i) != value;
+    break;
+  case FilterOp::Lt:
+    for (size_t i = 0; i < n; i++) mask[i] &= get(i) < value;
+    break;
+  case FilterOp::Le:
+    for (size_t i = 0; i < n; i++) mask[i] &= get(i) <= value;
+    break;
+  case FilterOp::Gt:
+    for (size_t i = 0; i < n; i++) mask[i] &= get(i) > value;
+    break;
+  case FilterOp::Ge:
+    for (size_t i = 0; i < n; i++) mask[i] &= get(i) >= value;
+    break;
+  default:
+    throw std::invalid_argument("not a comparison operator");
+  }
+}
+
+// A column's contiguous values, as a Get. compare_rows sends these through
+// the dispatched kernel (simd_kernels.h) instead of the inline loop.
+template <typename T>
+struct ColumnValues {
+  const T* data;
+  T operator()(size_t i) const { return data[i]; }
+};
+
+template <typename T>
+inline void compare_rows(size_t n, ColumnValues<T> get, FilterOp op, const T& value, uint8_t* mask) {
+  CompareOp kernel_op;
+  switch (op) {
+  case FilterOp::Eq: kernel_op = CompareOp::Eq; break;
+  case FilterOp::Ne: kernel_op = CompareOp::Ne; break;
+  case FilterOp::Lt: kernel_op = CompareOp::Lt; break;
+  case FilterOp::Le: kernel_op = CompareOp::Le; break;
+  case FilterOp::Gt: kernel_op = CompareOp::Gt; break;
+  case FilterOp::Ge: kernel_op = CompareOp::Ge; break;
+  default: throw std::invalid_argument("not a comparison operator");
+  }
+  compare_mask<T>(get.data, n, kernel_op, value, mask);
+}
+
+template <typename T, typename Get>
+inline void in_set_rows(size_t n, Get get, std::vector<T> set, bool negate, uint8_t* mask) {
+  uint8_t flip = negate ? 1 : 0;
+  if (set.size() <= kLinearInSet) {
+    for (size_t i = 0; i < n; i++) {
+      auto x = get(i);
+      uint8_t hit = 0;
+      for (const T& v : set) {
+        hit |= x == v;
+      }
+      mask[i] &= hit ^ flip;
+    }
+    return;
+  }
+
+  std::sort(set.begin(), set.end());
+  for (size_t i = 0; i < n; i++) {
+    mask[i] &= static_cast<uint8_t>(std::binary_search(set.begin(), set.end(), get(i))) ^ flip;
+  }
+}
+
+// Result of `x op value` for every x when value lies above (or below) the
+// column type's range
+inline bool out_of_range_result(FilterOp op, bool above) {
+  switch (op) {
+  case FilterOp::Ne: return true;
+  case FilterOp::Lt:
+  case FilterOp::Le: return above;
+  case FilterOp::Gt:
+  case FilterOp::Ge: return !above;
+  default: return false;
+  }
+}
+
+// The operand as a T, if T can represent it exactly
+template <typename T>
+inline std::optional<T> integer_operand(const FilterValue& value) {
+  __int128 integer;
+  if (value.kind == FilterValue::Integer) {
+    integer = value.integer;
+  } else if (value.kind == FilterValue::Float && std::trunc(value.real) == value.real &&
+             std::abs(value.real) < 0x1p127) {
+    // Exact: an integral double below 2^127 fits __int128; the bounds
+    // check below is then against the type's real range
+    integer = static_cast<__int128>(value.real);
+  } else {
+    return std::nullopt;
+  }
+
+  if (integer < static_cast<__int128>(std::numeric_limits<T>::min()) ||
+      integer > static_cast<__int128>(std::numeric_limits<T>::max())) {
+    return std::nullopt;
+  }
+  return static_cast<T>(integer);
+}
+
+inline void require_numeric(const FilterValue& value, const std::string& column) {
+  if (value.kind == FilterValue::String) {
+    throw std::invalid_argument("filter on numeric column " + column + " needs a number");
+  }
+}
+
+// Integer columns compare in their own type: an operand outside the type's
+// range decides the predicate for the whole block without a scan
+template <typename T, typename Get>
+inline void filter_integers(size_t n, Get get, const RowPredicate& p, uint8_t* mask) {
+  if (p.op == FilterOp::In || p.op == FilterOp::NotIn) {
+    std::vector<T> set;
+    for (const FilterValue& value : p.values) {
+      require_numeric(value, p.column);
+      if (auto operand = integer_operand<T>(value)) {
+        set.push_back(*operand);
+      }
+    }
+    in_set_rows<T>(n, get, std::move(set), p.op == FilterOp::NotIn, mask);
+    return;
+  }
+
+  const FilterValue& value = p.values.front();
+  require_numeric(value, p.column);
+  if (value.kind == FilterValue::Float && std::trunc(value.real) != value.real) {
+    compare_rows<double>(n, [&](size_t i) { return static_cast<double>(get(i)); }, p.op,
+                         value.real, mask);
+    return;
+  }
+
+  if (auto operand = integer_operand<T>(value)) {
+    compare_rows<T>(n, get, p.op, *operand, mask);
+    return;
+  }
+
+  bool above = value.kind == FilterValue::Integer ? value.integer > 0 : value.real > 0;
+  if (!out_of_range_result(p.op, above)) {
+    std::memset(mask, 0, n);
+  }
+}
+
+template <typename Get>
+inline void filter_floats(size_t n, Get get, const RowPredicate& p, uint8_t* mask) {
+  auto as_double = [&](const FilterValue& value) {
+    require_numeric(value, p.column);
+    return value.kind == FilterValue::Float ? value.real : static_cast<double>(value.integer);
+  };
+
+  if (p.op == FilterOp::In || p.op == FilterOp::NotIn) {
+    std::vector<double> set;
+    for (const FilterValue& value : p.values) {
+      set.push_back(as_double(value));
+    }
+    in_set_rows<double>(n, [&](size_t i) { return static_cast<double>(get(i)); }, std::move(set),
+                        p.op == FilterOp::NotIn, mask);
+    return;
+  }
+  if constexpr (std::is_same_v<Get, ColumnValues<double>>) {
+    compare_rows<double>(n, get, p.op, as_double(p.values.front()), mask);
+  } else {
+    compare_rows<double>(n, [&](size_t i) { return static_cast<double>(get(i)); }, p.op,
+                         as_double(p.values.front()), mask);
+  }
+}
+
+template <typename Get>
+inline void filter_strings(size_t n, Get get, const RowPredicate& p, uint8_t* mask) {
+  for (const FilterValue& value : p.values) {
+    if (value.kind != FilterValue::String) {
+      throw std::invalid_argument("filter on string column " + p.column + " needs a binary");
+    }
+  }
+
+  if (p.op == FilterOp::In || p.op == FilterOp::NotIn) {
+    std::vector<std::string_view> set;
+    for (const FilterValue& value : p.values) {
+      set.push_back(value.string);
+    }
+    in_set_rows<std::string_view>(n, get, std::move(set), p.op == FilterOp::NotIn, mask);
+    return;
+  }
+  compare_rows<std::string_view>(n, get, p.op, std::string_view(p.values.front().string), mask);
+}
+
+template <typename ColumnType, typename T>
+inline void filter_vector(const clickhouse::ColumnRef& col, const RowPredicate& p, uint8_t* mask) {
+  auto& data = col->As<ColumnType>()->GetWritableData();
+  const T* values = data.data();
+  ColumnValues<T> get{values};
+  if constexpr (std::is_floating_point_v<T>) {
+    filter_floats(data.size(), get, p, mask);
+  } else {
+    filter_integers<T>(data.size(), get, p, mask);
+  }
+}
+
+// Compare enum names. Codes outside the enum, such as the 0 in the null
+// slots of a Nullable(Enum), read as "": those rows are masked out already.
+template <typename EnumColumn>
+inline void filter_enum(const clickhouse::ColumnRef& col, const RowPredicate& p, uint8_t* mask) {
+  auto enum_col = col->As<EnumColumn>();
+  auto enum_type = col->Type()->As<clickhouse::EnumType>();
+  filter_strings(enum_col->Size(), [&](size_t i) {
+    int16_t code = enum_col->At(i);
+    return enum_type->HasEnumValue(code) ? enum_type->GetEnumName(code) : std::string_view();
+  }, p, mask);
+}
+
+// `p` with its timestamp operands in units of 10^-precision seconds. An
+// operand that falls between two units becomes a float, so ordering
+// comparisons stay exact and equality matches nothing.
+inline RowPredicate timestamps_at(const RowPredicate& p, size_t precision) {
+  RowPredicate scaled = p;
+  for (FilterValue& value : scaled.values) {
+    if (!value.timestamp) {
+      continue;
+    }
+    value.timestamp = false;
+    if (precision >= 6) {
+      for (size_t i = 6; i < precision; i++) {
+        value.integer *= 10;
+      }
+      continue;
+    }
+    __int128 divisor = 1;
+    for (size_t i = precision; i < 6; i++) {
+      divisor *= 10;
+    }
+    if (value.integer % divisor != 0) {
+      value.kind = FilterValue::Float;
+      value.real = static_cast<double>(value.integer) / static_cast<double>(divisor);
+    } else {
+      value.integer /= divisor;
+    }
+  }
+  return scaled;
+}
+
+inline bool has_timestamps(const RowPredicate& p) {
+  return std::any_of(p.values.begin(), p.values.end(),
+                     [](const FilterValue& value) { return value.timestamp; });
+}
+
+// AND one predicate into mask (one byte per row of col)
+inline void apply_predicate(const clickhouse::ColumnRef& col, const RowPredicate& p, uint8_t* mask) {
+  using namespace clickhouse;
+  size_t n = col->Size();
+  Type::Code code = col->GetType().GetCode();
+
+  if (code == Type::Nullable) {
+    auto nullable = col->As<ColumnNullable>();
+    const uint8_t* nulls = nullable->Nulls()->As<ColumnUInt8>()->GetWritableData().data();
+    if (p.op == FilterOp::IsNil) {
+      and_mask(mask, nulls, n, 0);
+      return;
+    }
+    and_mask(mask, nulls, n, 1);
+    if (p.op != FilterOp::NotNil) {
+      apply_predicate(nullable->Nested(), p, mask);
+    }
+    return;
+  }
+
+  if (code == Type::LowCardinality) {
+    // Resolve dictionary entries once per row, then filter the views
+    thread_local std::vector<std::string_view> items;
+    thread_local std::vector<uint8_t> nulls;
+    auto lc = col->As<ColumnLowCardinality>();
+    items.assign(n, std::string_view());
+    nulls.assign(n, 0);
+    for (size_t i = 0; i < n; i++) {
+      auto item = lc->GetItem(i);
+      if (item.type == Type::Void) {
+        nulls[i] = 1;
+      } else if (item.type == Type::String) {
+        items[i] = item.get<std::string_view>();
+      } else {
+        throw std::invalid_argument("filter on column " + p.column + " is not supported");
+      }
+    }
+
+    if (p.op == FilterOp::IsNil) {
+      and_mask(mask, nulls.data(), n, 0);
+      return;
+    }
+    and_mask(mask, nulls.data(), n, 1);
+    if (p.op != FilterOp::NotNil) {
+      filter_strings(n, [](size_t i) { return items[i]; }, p, mask);
+    }
+    return;
+  }
+
+  // Non-nullable columns hold no NULLs
+  if (p.op == FilterOp::IsNil) {
+    std::memset(mask, 0, n);
+    return;
+  }
+  if (p.op == FilterOp::NotNil) {
+    return;
+  }
+
+  // DateTime64 compares raw ticks; every other column takes Unix seconds
+  if (has_timestamps(p)) {
+    size_t precision =
+        code == Type::DateTime64 ? col->Type()->As<DateTime64Type>()->GetPrecision() : 0;
+    apply_predicate(col, timestamps_at(p, precision), mask);
+    return;
+  }
+
+  switch (code) {
+  case Type::UInt64: filter_vector<ColumnUInt64, uint64_t>(col, p, mask); break;
+  case Type::UInt32: filter_vector<ColumnUInt32, uint32_t>(col, p, mask); break;
+  case Type::UInt16: filter_vector<ColumnUInt16, uint16_t>(col, p, mask); break;
+  case Type::UInt8: filter_vector<ColumnUInt8, uint8_t>(col, p, mask); break;
+  case Type::Int64: filter_vector<ColumnInt64, int64_t>(col, p, mask); break;
+  case Type::Int32: filter_vector<ColumnInt32, int32_t>(col, p, mask); break;
+  case Type::Int16: filter_vector<ColumnInt16, int16_t>(col, p, mask); break;
+  case Type::Int8: filter_vector<ColumnInt8, int8_t>(col, p, mask); break;
+  case Type::Float64: filter_vector<ColumnFloat64, double>(col, p, mask); break;
+  case Type::Float32: filter_vector<ColumnFloat32, float>(col, p, mask); break;
+  case Type::Date: {
+    // Days since epoch, as Elixir sends Date operands
+    auto date_col = col->As<ColumnDate>();
+    filter_integers<uint16_t>(n, [&](size_t i) { return date_col->RawAt(i); }, p, mask);
+    break;
+  }
+  case Type::DateTime: {
+    // Unix seconds
+    auto datetime_col = col->As<ColumnDateTime>();
+    filter_integers<int64_t>(n, [&](size_t i) { return static_cast<int64_t>(datetime_col->At(i)); },
+                             p, mask);
+    break;
+  }
+  case Type::DateTime64: {
+    // Raw ticks at the column's precision (DateTime operands are scaled above)
+    auto datetime_col = col->As<ColumnDateTime64>();
+    filter_integers<int64_t>(n, [&](size_t i) { return datetime_col->At(i); }, p, mask);
+    break;
+  }
+  case Type::String: {
+    auto string_col = col->As<ColumnString>();
+    filter_strings(n, [&](size_t i) { return string_col->At(i); }, p, mask);
+    break;
+  }
+  case Type::Enum8: filter_enum<ColumnEnum8>(col, p, mask); break;
+  case Type::Enum16: filter_enum<ColumnEnum16>(col, p, mask); break;
+  default:
+    throw std::invalid_argument("filter on column " + p.column + " of type " +
+                                col->Type()->GetName() + " is not supported");
+  }
+}
+
+// Evaluate `predicates` over `block`. Returns nullptr when every row
+// passes (decode the block as is), otherwise `rows` filled with the
+// passing row indices.
+inline const RowSelection* select_block_rows(const clickhouse::Block& block,
+                                             const std::vector<RowPredicate>& predicates,
+                                             RowSelection& rows) {
+  size_t row_count = block.GetRowCount();
+  if (predicates.empty() || row_count == 0) {
+    return nullptr;
+  }
+
+  thread_local std::vector<uint8_t> mask;
+  mask.assign(row_count, 1);
+
+  for (const RowPredicate& predicate : predicates) {
+    size_t c = 0;
+    while (c < block.GetColumnCount() && block.GetColumnName(c) != predicate.column) {
+      c++;
+    }
+    if (c == block.GetColumnCount()) {
+      throw std::invalid_argument("filter column " + predicate.column + " is not in the result");
+    }
+    apply_predicate(block[c], predicate, mask.data());
+  }
+
+  rows.resize(row_count);
+  rows.resize(mask_to_rows(mask.data(), row_count, rows.data()));
+  return rows.size() == row_count ? nullptr : &rows;
+}
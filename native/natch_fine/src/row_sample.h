@@ -0,0 +1,263 @@
+#pragma once
+
+#include <fine.hpp>
+#include <clickhouse/block.h>
+#include <clickhouse/columns/column.h>
+#include <clickhouse/columns/numeric.h>
+#include <clickhouse/columns/string.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "row_filter.h"
+
+// Sampling of SELECT results (the `sample:` select option)
+//
+// Every-Nth sampling narrows each block's selection as it streams past.
+// Reservoir sampling keeps a uniform sample of K rows across the whole
+// result: each taken row is copied out of its block into one growable column
+// per result column, so memory stays bounded by K rows however large the
+// result, and the sample is decoded once after the last block.
+
+struct SampleOptions {
+  enum Mode { None, Every, Reservoir } mode = None;
+  uint64_t size = 0;
+  // Reservoir only; random when unset
+  std::optional<uint64_t> seed;
+};
+
+// Decode {:every, n, nil} or {:reservoir, k, seed | nil}
+inline SampleOptions decode_row_sample(ErlNifEnv *env, ERL_NIF_TERM term) {
+  int arity;
+  const ERL_NIF_TERM* elements;
+  char mode[16];
+  SampleOptions sample;
+  ErlNifUInt64 size;
+
+  if (!enif_get_tuple(env, term, &arity, &elements) || arity != 3 ||
+      enif_get_atom(env, elements[0], mode, sizeof(mode), ERL_NIF_LATIN1) <= 0 ||
+      !enif_get_uint64(env, elements[1], &size) || size == 0) {
+    throw std::invalid_argument("sample must be {:every, n} or {:reservoir, k}");
+  }
+
+  std::string_view name(mode);
+  if (name == "every") {
+    sample.mode = SampleOptions::Every;
+  } else if (name == "reservoir") {
+    sample.mode = SampleOptions::Reservoir;
+  } else {
+    throw std::invalid_argument("sample must be {:every, n} or {:reservoir, k}");
+  }
+  sample.size = size;
+
+  ErlNifUInt64 seed;
+  if (enif_get_uint64(env, elements[2], &seed)) {
+    sample.seed = seed;
+  }
+  return sample;
+}
+
+// Copy one value between two columns of type ColumnType
+template <typename ColumnType>
+inline void append_value(clickhouse::Column& dst, const clickhouse::ColumnRef& src, size_t row) {
+  static_cast<ColumnType&>(dst).Append(static_cast<const ColumnType&>(*src).At(row));
+}
+
+// Append row `row` of `src` to `dst`, a column of the same type. Numbers
+// and strings are copied by value; other types go through a one-row slice.
+inline void append_row(clickhouse::Column& dst, const clickhouse::ColumnRef& src, size_t row) {
+  using namespace clickhouse;
+  switch (src->Type()->GetCode()) {
+  case Type::UInt8: return append_value<ColumnUInt8>(dst, src, row);
+  case Type::UInt16: return append_value<ColumnUInt16>(dst, src, row);
+  case Type::UInt32: return append_value<ColumnUInt32>(dst, src, row);
+  case Type::UInt64: return append_value<ColumnUInt64>(dst, src, row);
+  case Type::Int8: return append_value<ColumnInt8>(dst, src, row);
+  case Type::Int16: return append_value<ColumnInt16>(dst, src, row);
+  case Type::Int32: return append_value<ColumnInt32>(dst, src, row);
+  case Type::Int64: return append_value<ColumnInt64>(dst, src, row);
+  case Type::Float32: return append_value<ColumnFloat32>(dst, src, row);
+  case Type::Float64: return append_value<ColumnFloat64>(dst, src, row);
+  case Type::String: return append_value<ColumnString>(dst, src, row);
+  default: dst.Append(src->Slice(row, 1));
+  }
+}
+
+// Uniform sample of K rows over a stream of blocks, using Li's Algorithm L:
+// once the reservoir is full, the gap to the next taken row is drawn from
+// its distribution directly, so skipped rows cost nothing
+class RowReservoir {
+public:
+  RowReservoir(uint64_t k, std::optional<uint64_t> seed)
+      : k_(k), rng_(seed ? *seed : std::random_device{}()) {
+    slots_.reserve(std::min<uint64_t>(k_, 65536));
+  }
+
+  // Offer the rows of `block` listed in `rows` (nullptr = every row)
+  void Offer(const clickhouse::Block& block, const RowSelection* rows) {
+    size_t count = rows ? rows->size() : block.GetRowCount();
+    if (count > 0 && names_.empty()) {
+      for (size_t c = 0; c < block.GetColumnCount(); c++) {
+        names_.push_back(block.GetColumnName(c));
+        columns_.push_back(block[c]->CloneEmpty());
+      }
+    }
+
+    size_t i = 0;
+    while (i < count && seen_ < k_) {
+      slots_.push_back(Take(block, rows ? (*rows)[i] : i));
+      i++;
+      if (++seen_ == k_) {
+        w_ = std::exp(std::log(Uniform()) / k_);
+        next_ = seen_ + Gap();
+      }
+    }
+
+    while (i < count) {
+      uint64_t skip = next_ - seen_;
+      if (skip >= count - i) {
+        seen_ += count - i;
+        return;
+      }
+      i += skip;
+      seen_ += skip;
+
+      std::uniform_int_distribution<uint64_t> pick(0, k_ - 1);
+      slots_[pick(rng_)] = Take(block, rows ? (*rows)[i] : i);
+      if (stored_ - slots_.size() >= k_) {
+        Compact();
+      }
+      i++;
+      seen_++;
+      w_ *= std::exp(std::log(Uniform()) / k_);
+      next_ = seen_ + Gap();
+    }
+  }
+
+  // The sample as one block, rows in stream order
+  clickhouse::Block TakeSample() {
+    clickhouse::Block block;
+    if (slots_.empty()) {
+      return block;
+    }
+    Compact();
+    for (size_t c = 0; c < names_.size(); c++) {
+      block.AppendColumn(names_[c], columns_[c]);
+    }
+    slots_.clear();
+    columns_.clear();
+    stored_ = 0;
+    return block;
+  }
+
+private:
+  // A sampled row: its position in the stream and its row in columns_
+  struct Slot {
+    uint64_t position;
+    size_t row;
+  };
+
+  // Copy `row` of `block` to the end of columns_
+  Slot Take(const clickhouse::Block& block, size_t row) {
+    for (size_t c = 0; c < columns_.size(); c++) {
+      append_row(*columns_[c], block[c], row);
+    }
+    return Slot{seen_, stored_++};
+  }
+
+  // A replaced slot leaves its row behind in columns_. Rewrite the columns
+  // with only the sampled rows, in stream order, before the dead rows
+  // outnumber the live ones.
+  void Compact() {
+    std::sort(slots_.begin(), slots_.end(),
+              [](const Slot& a, const Slot& b) { return a.position < b.position; });
+
+    for (clickhouse::ColumnRef& column : columns_) {
+      clickhouse::ColumnRef live = column->CloneEmpty();
+      for (const Slot& slot : slots_) {
+        append_row(*live, column, slot.row);
+      }
+      column = live;
+    }
+    for (size_t i = 0; i < slots_.size(); i++) {
+      slots_[i].row = i;
+    }
+    stored_ = slots_.size();
+  }
+
+  // In (0, 1), so the logarithms stay finite
+  double Uniform() {
+    std::uniform_real_distribution<double> uniform(std::nextafter(0.0, 1.0), 1.0);
+    return uniform(rng_);
+  }
+
+  // Rows skipped before the next one is taken
+  uint64_t Gap() {
+    double gap = std::floor(std::log(Uniform()) / std::log1p(-w_));
+    return static_cast<uint64_t>(std::min(gap, 1e18));
+  }
+
+  uint64_t k_;
+  std::mt19937_64 rng_;
+  uint64_t seen_ = 0;
+  uint64_t next_ = 0;
+  double w_ = 1.0;
+  std::vector<std::string> names_;
+  std::vector<clickhouse::ColumnRef> columns_;
+  // Rows in columns_, live or replaced
+  size_t stored_ = 0;
+  std::vector<Slot> slots_;
+};
+
+// Per-query sampling state, fed each block's (filtered) selection
+class RowSampler {
+public:
+  explicit RowSampler(const SampleOptions& opts) : opts_(opts) {
+    if (opts_.mode == SampleOptions::Reservoir) {
+      reservoir_.emplace(opts_.size, opts_.seed);
+    }
+  }
+
+  // Narrow `rows` (nullptr = every row of the block) to the rows to decode
+  // now. Reservoir sampling holds its rows back, so it selects none.
+  const RowSelection* Select(const clickhouse::Block& block, const RowSelection* rows) {
+    size_t count = rows ? rows->size() : block.GetRowCount();
+
+    switch (opts_.mode) {
+    case SampleOptions::None:
+      return rows;
+    case SampleOptions::Every: {
+      selection_.clear();
+      for (size_t i = (opts_.size - seen_ % opts_.size) % opts_.size; i < count; i += opts_.size) {
+        selection_.push_back(rows ? (*rows)[i] : static_cast<uint32_t>(i));
+      }
+      seen_ += count;
+      return &selection_;
+    }
+    case SampleOptions::Reservoir:
+      reservoir_->Offer(block, rows);
+      selection_.clear();
+      return &selection_;
+    }
+    return rows;
+  }
+
+  // The reservoir sample once every block is in, if this query has one
+  std::optional<clickhouse::Block> TakeReservoir() {
+    if (!reservoir_) {
+      return std::nullopt;
+    }
+    return reservoir_->TakeSample();
+  }
+
+private:
+  SampleOptions opts_;
+  uint64_t seen_ = 0;
+  RowSelection selection_;
+  std::optional<RowReservoir> reservoir_;
+};
@@ -12,17 +12,131 @@
 #include <clickhouse/columns/map.h>
 #include <clickhouse/columns/lowcardinality.h>
 #include <clickhouse/columns/enum.h>
+#include <clickhouse/columns/factory.h>
 #include <clickhouse/types/types.h>
+#include <clickhouse/base/input.h>
+#include <clickhouse/base/wire_format.h>
+#include <clickhouse/exceptions.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <optional>
+#include <unordered_map>
 #include <vector>
 #include <memory>
-#include <sstream>
-#include <iomanip>
+#include "atoms.h"
+#include "decode_stats.h"
+#include "native_format.h"
+#include "probes.h"
+#include "row_filter.h"
+#include "row_sample.h"
+#include "term_buffers.h"
 
 using namespace clickhouse;
 
+// Cancellation and progress handle for one SELECT
+// Elixir cancels by setting `cancelled`; the select callback sees it at the
+// next block and tells the server to stop the query. The first block that
+// carries rows sends {:natch_first_block, ref} to the process that created
+// the token, so a caller can tell a slow query from one that is streaming.
+struct CancelToken {
+  std::atomic<bool> cancelled{false};
+  std::atomic<bool> first_block_seen{false};
+  ErlNifPid owner;
+  ErlNifEnv* ref_env;
+  ERL_NIF_TERM ref;
+
+  CancelToken(ErlNifEnv *env, ERL_NIF_TERM caller_ref) : ref_env(enif_alloc_env()) {
+    enif_self(env, &owner);
+    ref = enif_make_copy(ref_env, caller_ref);
+  }
+
+  ~CancelToken() { enif_free_env(ref_env); }
+
+  void NotifyFirstBlock(ErlNifEnv *env, const Block& block) {
+    if (block.GetRowCount() == 0 || first_block_seen.exchange(true)) {
+      return;
+    }
+    ErlNifEnv* msg_env = enif_alloc_env();
+    ERL_NIF_TERM msg = enif_make_tuple2(msg_env, enif_make_atom(msg_env, "natch_first_block"),
+                                        enif_make_copy(msg_env, ref));
+    enif_send(env, &owner, msg_env, msg);
+    enif_free_env(msg_env);
+  }
+};
+
+FINE_RESOURCE(CancelToken);
+
+// Per-query decode options, passed from Elixir as a map
+struct SelectOptions {
+  // Emit one shared binary per distinct String value within a block
+  bool intern_strings = false;
+  // Stop interning a block once distinct values exceed this share of rows
+  double intern_threshold = 0.5;
+  // Return per-type decode costs for this query alongside the result
+  bool decode_stats = false;
+  // Stop the query early when Elixir cancels it
+  std::optional<fine::ResourcePtr<CancelToken>> cancel_token;
+  // Drop rows that fail these predicates before building their terms
+  std::vector<RowPredicate> filter;
+  // Decode only every Nth row, or a reservoir sample, of what passes
+  SampleOptions sample;
+};
+
+static bool get_boolean_option(ErlNifEnv *env, ERL_NIF_TERM value, bool& out) {
+  if (enif_is_identical(value, fine::encode(env, atoms::true_))) {
+    out = true;
+    return true;
+  }
+  if (enif_is_identical(value, fine::encode(env, atoms::false_))) {
+    out = false;
+    return true;
+  }
+  return false;
+}
+
+// Decode %{intern_strings: boolean, intern_threshold: float,
+// decode_stats: boolean, cancel_token: token, filter: [predicate],
+// sample: {mode, n, seed}}; missing keys keep their defaults
+SelectOptions decode_select_options(ErlNifEnv *env, ERL_NIF_TERM term) {
+  SelectOptions opts;
+  if (!enif_is_map(env, term)) {
+    throw std::invalid_argument("Select options must be a map");
+  }
+
+  ERL_NIF_TERM value;
+  if (enif_get_map_value(env, term, fine::encode(env, atoms::intern_strings), &value) &&
+      !get_boolean_option(env, value, opts.intern_strings)) {
+    throw std::invalid_argument("intern_strings must be a boolean");
+  }
+  if (enif_get_map_value(env, term, fine::encode(env, atoms::decode_stats), &value) &&
+      !get_boolean_option(env, value, opts.decode_stats)) {
+    throw std::invalid_argument("decode_stats must be a boolean");
+  }
+  if (enif_get_map_value(env, term, fine::encode(env, atoms::intern_threshold), &value)) {
+    if (!enif_get_double(env, value, &opts.intern_threshold) ||
+        opts.intern_threshold < 0.0 || opts.intern_threshold > 1.0) {
+      throw std::invalid_argument("intern_threshold must be a float between 0.0 and 1.0");
+    }
+  }
+  if (enif_get_map_value(env, term, fine::encode(env, atoms::cancel_token), &value)) {
+    opts.cancel_token = fine::decode<fine::ResourcePtr<CancelToken>>(env, value);
+  }
+  if (enif_get_map_value(env, term, fine::encode(env, atoms::filter), &value)) {
+    opts.filter = decode_row_filter(env, value);
+  }
+  if (enif_get_map_value(env, term, fine::encode(env, atoms::sample), &value)) {
+    opts.sample = decode_row_sample(env, value);
+  }
+  return opts;
+}
+
 // Forward declaration
-ERL_NIF_TERM column_to_elixir_list(ErlNifEnv *env, ColumnRef col);
+void append_column_terms(ErlNifEnv *env, const ColumnRef& col, std::vector<ERL_NIF_TERM>& out,
+                         const SelectOptions& opts, const RowSelection* rows = nullptr);
 
 // Helper to format UUID to string (much faster than ostringstream)
 inline void format_uuid_to_buffer(const UUID& uuid, char* buffer) {
@@ -37,353 +151,358 @@ inline void format_uuid_to_buffer(const UUID& uuid, char* buffer) {
            (unsigned long long)(low & 0xFFFFFFFFFFFF));
 }
 
-// Helper to recursively convert a column to an Elixir list
-// This handles all column types including nested arrays
-ERL_NIF_TERM column_to_elixir_list(ErlNifEnv *env, ColumnRef col) {
-  size_t count = col->Size();
-  std::vector<ERL_NIF_TERM> values;
-  values.reserve(count);
+// Copy bytes into a fresh Elixir binary
+inline ERL_NIF_TERM make_binary_term(ErlNifEnv *env, std::string_view value) {
+  ERL_NIF_TERM term;
+  unsigned char* data = enif_make_new_binary(env, value.size(), &term);
+  std::memcpy(data, value.data(), value.size());
+  DecodeScope::CountBinary(value.size());
+  return term;
+}
 
-  // Optimized: Use Type::Code for O(1) type dispatch instead of cascade of As<T>() calls
-  Type::Code type_code = col->GetType().GetCode();
+// Grow geometrically so accumulating block after block stays amortised O(1)
+inline void reserve_terms(std::vector<ERL_NIF_TERM>& out, size_t extra) {
+  size_t needed = out.size() + extra;
+  if (needed > out.capacity()) {
+    out.reserve(std::max(needed, out.capacity() * 2));
+  }
+}
 
-  switch (type_code) {
-  case Type::UInt64: {
-    auto uint64_col = col->As<ColumnUInt64>();
-    for (size_t i = 0; i < count; i++) {
-      values.push_back(enif_make_uint64(env, uint64_col->At(i)));
-    }
-    break;
+// Append `n` copies of the same term (null runs, repeated values)
+inline void fill_terms(std::vector<ERL_NIF_TERM>& out, size_t n, ERL_NIF_TERM term) {
+  out.insert(out.end(), n, term);
+}
+
+// Length of the run of bytes equal to `value` starting at `begin`
+inline size_t byte_run_length(const uint8_t* begin, const uint8_t* end, uint8_t value) {
+  const uint8_t* p = begin;
+  // Null maps hold only 0/1, so the run ends at the first byte of the other value
+  const void* next = std::memchr(p, value ^ 1, end - p);
+  return (next ? static_cast<const uint8_t*>(next) : end) - begin;
+}
+
+// Row of the column behind the i-th output term
+inline size_t row_at(const RowSelection* rows, size_t i) {
+  return rows ? (*rows)[i] : i;
+}
+
+template <typename ColumnType, typename MakeTerm>
+inline void append_each(const ColumnRef& col, const RowSelection* rows,
+                        std::vector<ERL_NIF_TERM>& out, MakeTerm make_term) {
+  auto typed = col->As<ColumnType>();
+  size_t count = rows ? rows->size() : typed->Size();
+  for (size_t i = 0; i < count; i++) {
+    out.push_back(make_term(typed->At(row_at(rows, i))));
   }
-  case Type::UInt32: {
-    auto uint32_col = col->As<ColumnUInt32>();
-    for (size_t i = 0; i < count; i++) {
-      values.push_back(enif_make_uint64(env, uint32_col->At(i)));
+}
+
+// Rows sampled before deciding whether interning a block pays off
+constexpr size_t kInternProbeRows = 1024;
+
+// Decode a String column emitting one binary per distinct value
+// The first kInternProbeRows rows are hashed unconditionally; if they hold
+// more distinct values than opts.intern_threshold allows, hashing stops and
+// the rest of the block decodes as plain strings. Keys point into the
+// column's storage, which outlives the decode.
+inline void append_interned_strings(ErlNifEnv *env, ColumnString& col, const RowSelection* rows,
+                                    std::vector<ERL_NIF_TERM>& out, const SelectOptions& opts) {
+  thread_local std::unordered_map<std::string_view, ERL_NIF_TERM> interned;
+  interned.clear();
+
+  size_t count = rows ? rows->size() : col.Size();
+  size_t probe = std::min(count, kInternProbeRows);
+  size_t i = 0;
+  for (; i < probe; i++) {
+    std::string_view value = col.At(row_at(rows, i));
+    auto [it, inserted] = interned.try_emplace(value, 0);
+    if (inserted) {
+      it->second = make_binary_term(env, value);
     }
-    break;
+    out.push_back(it->second);
   }
-  case Type::UInt16: {
-    auto uint16_col = col->As<ColumnUInt16>();
-    for (size_t i = 0; i < count; i++) {
-      values.push_back(enif_make_uint64(env, uint16_col->At(i)));
+
+  if (interned.size() > opts.intern_threshold * probe) {
+    for (; i < count; i++) {
+      out.push_back(make_binary_term(env, col.At(row_at(rows, i))));
     }
-    break;
-  }
-  case Type::UInt8: {
-    auto uint8_col = col->As<ColumnUInt8>();
-    for (size_t i = 0; i < count; i++) {
-      values.push_back(enif_make_uint64(env, uint8_col->At(i)));
+  } else {
+    for (; i < count; i++) {
+      std::string_view value = col.At(row_at(rows, i));
+      auto [it, inserted] = interned.try_emplace(value, 0);
+      if (inserted) {
+        it->second = make_binary_term(env, value);
+      }
+      out.push_back(it->second);
     }
-    break;
   }
-  case Type::Int64: {
-    auto int64_col = col->As<ColumnInt64>();
-    for (size_t i = 0; i < count; i++) {
-      values.push_back(enif_make_int64(env, int64_col->At(i)));
+  interned.clear();
+}
+
+// Return enum names as strings; a run of the same code reuses one binary
+// instead of repeating the name lookup
+template <typename EnumColumn>
+inline void append_enum_names(ErlNifEnv *env, const ColumnRef& col, const RowSelection* rows,
+                              std::vector<ERL_NIF_TERM>& out) {
+  auto enum_col = col->As<EnumColumn>();
+  size_t count = rows ? rows->size() : enum_col->Size();
+  ERL_NIF_TERM previous_term = 0;
+  for (size_t i = 0; i < count; i++) {
+    size_t row = row_at(rows, i);
+    if (i == 0 || enum_col->At(row) != enum_col->At(row_at(rows, i - 1))) {
+      previous_term = make_binary_term(env, enum_col->NameAt(row));
     }
-    break;
+    out.push_back(previous_term);
   }
-  case Type::Int32: {
-    auto int32_col = col->As<ColumnInt32>();
-    for (size_t i = 0; i < count; i++) {
-      values.push_back(enif_make_int64(env, int32_col->At(i)));
-    }
+}
+
+// Nested types of a Nullable whose decoder fails on the default value a
+// null slot holds: an Enum's 0 is usually not one of its members
+inline bool decodes_null_slots(Type::Code code) {
+  return code != Type::Enum8 && code != Type::Enum16;
+}
+
+// Decode every row of a column into Elixir terms, appended to `out`
+// This is the single decoder behind all SELECT result shapes. Callers append
+// straight into their accumulators; nested types decode their children into
+// pooled scratch buffers (see term_buffers.h) so steady-state queries reuse
+// the same memory block after block.
+//
+// With `rows` (see row_filter.h) only those rows are decoded, in order,
+// at every level of nesting: no term is built for a row left out.
+void append_column_terms(ErlNifEnv *env, const ColumnRef& col, std::vector<ERL_NIF_TERM>& out,
+                         const SelectOptions& opts, const RowSelection* rows) {
+  Type::Code code = col->GetType().GetCode();
+  size_t count = rows ? rows->size() : col->Size();
+  DecodeScope scope(code, count);
+  reserve_terms(out, count);
+
+  // Use Type::Code for O(1) type dispatch instead of cascade of As<T>() calls
+  switch (code) {
+  case Type::UInt64:
+    append_each<ColumnUInt64>(col, rows, out, [env](uint64_t v) { return enif_make_uint64(env, v); });
     break;
-  }
-  case Type::Int16: {
-    auto int16_col = col->As<ColumnInt16>();
-    for (size_t i = 0; i < count; i++) {
-      values.push_back(enif_make_int64(env, int16_col->At(i)));
-    }
+  case Type::UInt32:
+    append_each<ColumnUInt32>(col, rows, out, [env](uint32_t v) { return enif_make_uint64(env, v); });
     break;
-  }
-  case Type::Int8: {
-    auto int8_col = col->As<ColumnInt8>();
-    for (size_t i = 0; i < count; i++) {
-      values.push_back(enif_make_int64(env, int8_col->At(i)));
-    }
+  case Type::UInt16:
+    append_each<ColumnUInt16>(col, rows, out, [env](uint16_t v) { return enif_make_uint64(env, v); });
     break;
-  }
-  case Type::Float64: {
-    auto float64_col = col->As<ColumnFloat64>();
-    for (size_t i = 0; i < count; i++) {
-      values.push_back(enif_make_double(env, float64_col->At(i)));
-    }
+  case Type::UInt8:
+    append_each<ColumnUInt8>(col, rows, out, [env](uint8_t v) { return enif_make_uint64(env, v); });
     break;
-  }
-  case Type::Float32: {
-    auto float32_col = col->As<ColumnFloat32>();
-    for (size_t i = 0; i < count; i++) {
-      values.push_back(enif_make_double(env, float32_col->At(i)));
-    }
+  case Type::Int64:
+    append_each<ColumnInt64>(col, rows, out, [env](int64_t v) { return enif_make_int64(env, v); });
+    break;
+  case Type::Int32:
+    append_each<ColumnInt32>(col, rows, out, [env](int32_t v) { return enif_make_int64(env, v); });
+    break;
+  case Type::Int16:
+    append_each<ColumnInt16>(col, rows, out, [env](int16_t v) { return enif_make_int64(env, v); });
+    break;
+  case Type::Int8:
+    append_each<ColumnInt8>(col, rows, out, [env](int8_t v) { return enif_make_int64(env, v); });
+    break;
+  case Type::Float64:
+    append_each<ColumnFloat64>(col, rows, out, [env](double v) { return enif_make_double(env, v); });
+    break;
+  case Type::Float32:
+    append_each<ColumnFloat32>(col, rows, out, [env](float v) { return enif_make_double(env, v); });
     break;
-  }
   case Type::String: {
+    // Consecutive equal strings share one binary (constant runs, sparse
+    // columns whose null slots hold "")
     auto string_col = col->As<ColumnString>();
-    for (size_t i = 0; i < count; i++) {
-      std::string_view val_view = string_col->At(i);
-      ErlNifBinary bin;
-      enif_alloc_binary(val_view.size(), &bin);
-      std::memcpy(bin.data, val_view.data(), val_view.size());
-      values.push_back(enif_make_binary(env, &bin));
+    if (opts.intern_strings) {
+      append_interned_strings(env, *string_col, rows, out, opts);
+      break;
     }
-    break;
-  }
-  case Type::DateTime: {
-    auto datetime_col = col->As<ColumnDateTime>();
+
+    std::string_view previous;
+    ERL_NIF_TERM previous_term = 0;
     for (size_t i = 0; i < count; i++) {
-      values.push_back(enif_make_uint64(env, datetime_col->At(i)));
+      std::string_view value = string_col->At(row_at(rows, i));
+      if (previous_term == 0 || value != previous) {
+        previous = value;
+        previous_term = make_binary_term(env, value);
+      }
+      out.push_back(previous_term);
     }
     break;
   }
-  case Type::DateTime64: {
-    auto datetime64_col = col->As<ColumnDateTime64>();
-    for (size_t i = 0; i < count; i++) {
-      values.push_back(enif_make_int64(env, datetime64_col->At(i)));
-    }
+  case Type::DateTime:
+    append_each<ColumnDateTime>(col, rows, out, [env](time_t v) { return enif_make_uint64(env, v); });
+    break;
+  case Type::DateTime64:
+    append_each<ColumnDateTime64>(col, rows, out, [env](int64_t v) { return enif_make_int64(env, v); });
     break;
-  }
   case Type::Date: {
     auto date_col = col->As<ColumnDate>();
     for (size_t i = 0; i < count; i++) {
-      values.push_back(enif_make_uint64(env, date_col->RawAt(i)));
+      out.push_back(enif_make_uint64(env, date_col->RawAt(row_at(rows, i))));
     }
     break;
   }
-  case Type::UUID: {
-    auto uuid_col = col->As<ColumnUUID>();
-    for (size_t i = 0; i < count; i++) {
-      UUID uuid = uuid_col->At(i);
+  case Type::UUID:
+    append_each<ColumnUUID>(col, rows, out, [env](const UUID& uuid) {
       char uuid_buf[37];
       format_uuid_to_buffer(uuid, uuid_buf);
-      ErlNifBinary bin;
-      enif_alloc_binary(36, &bin);
-      std::memcpy(bin.data, uuid_buf, 36);
-      values.push_back(enif_make_binary(env, &bin));
-    }
+      return make_binary_term(env, std::string_view(uuid_buf, 36));
+    });
     break;
-  }
   case Type::Decimal:
   case Type::Decimal32:
   case Type::Decimal64:
-  case Type::Decimal128: {
-    auto decimal_col = col->As<ColumnDecimal>();
-    for (size_t i = 0; i < count; i++) {
-      Int128 value = decimal_col->At(i);
-      int64_t scaled_value = static_cast<int64_t>(value);
-      values.push_back(enif_make_int64(env, scaled_value));
-    }
+  case Type::Decimal128:
+    // Scaled integer; Elixir divides by 10^scale (assumes value fits in int64)
+    append_each<ColumnDecimal>(col, rows, out, [env](const Int128& v) {
+      return enif_make_int64(env, static_cast<int64_t>(v));
+    });
     break;
-  }
   case Type::Array: {
+    // ColumnArray keeps its element column and offsets protected, so rows
+    // are read one slice at a time; the element scratch buffer is shared
+    // across rows
     auto array_col = col->As<ColumnArray>();
-    // Recursively handle nested arrays
+    ScratchTerms elements(0);
     for (size_t i = 0; i < count; i++) {
-      auto nested = array_col->GetAsColumn(i);
-      values.push_back(column_to_elixir_list(env, nested));
+      elements->clear();
+      append_column_terms(env, array_col->GetAsColumn(row_at(rows, i)), *elements, opts);
+      out.push_back(enif_make_list_from_array(env, elements->data(), elements->size()));
     }
     break;
   }
   case Type::Tuple: {
+    // Decode the selected rows of each element column into one flat buffer
+    // (element-major), then gather tuples by index
     auto tuple_col = col->As<ColumnTuple>();
-    // Handle tuple columns - return Elixir tuples
     size_t tuple_size = tuple_col->TupleSize();
-
-    // Optimized: Pre-convert each element column ONCE, then index directly
-    std::vector<std::vector<ERL_NIF_TERM>> element_columns;
-    element_columns.reserve(tuple_size);
-
+    ScratchTerms elements(tuple_size * count);
     for (size_t j = 0; j < tuple_size; j++) {
-      auto element_col = tuple_col->At(j);
-      // Convert entire element column to Elixir list, then extract to vector
-      ERL_NIF_TERM elem_list = column_to_elixir_list(env, element_col);
-      std::vector<ERL_NIF_TERM> elem_vec;
-      elem_vec.reserve(count);
-      ERL_NIF_TERM tail = elem_list;
-      for (size_t i = 0; i < count; i++) {
-        ERL_NIF_TERM head;
-        if (enif_get_list_cell(env, tail, &head, &tail)) {
-          elem_vec.push_back(head);
-        } else {
-          elem_vec.push_back(enif_make_atom(env, "error"));
-        }
-      }
-      element_columns.push_back(std::move(elem_vec));
+      append_column_terms(env, tuple_col->At(j), *elements, opts, rows);
     }
 
-    // Now build tuples by indexing pre-converted columns
+    ScratchTerms tuple_elements(tuple_size);
+    tuple_elements->resize(tuple_size);
     for (size_t i = 0; i < count; i++) {
-      std::vector<ERL_NIF_TERM> tuple_elements;
-      tuple_elements.reserve(tuple_size);
       for (size_t j = 0; j < tuple_size; j++) {
-        tuple_elements.push_back(element_columns[j][i]);
+        (*tuple_elements)[j] = (*elements)[j * count + i];
       }
-      values.push_back(enif_make_tuple_from_array(env, tuple_elements.data(), tuple_elements.size()));
+      out.push_back(enif_make_tuple_from_array(env, tuple_elements->data(), tuple_size));
     }
     break;
   }
   case Type::Map: {
+    // ColumnMap keeps its Array(Tuple(K, V)) private, so rows are read one at
+    // a time; key/value scratch buffers are shared across rows
     auto map_col = col->As<ColumnMap>();
-    // Handle map columns - return Elixir maps
-    // Map is stored as Array(Tuple(K, V)) where Tuple is columnar
+    ScratchTerms key_terms(0);
+    ScratchTerms value_terms(0);
     for (size_t i = 0; i < count; i++) {
-      // Get the i-th map's tuples as a ColumnTuple
-      auto kv_tuples = map_col->GetAsColumn(i);
-
-      // This is a ColumnTuple with 2 columns: keys and values
-      if (auto tuple_col = kv_tuples->As<ColumnTuple>()) {
-        // Get the keys and values columns
-        auto keys_col = tuple_col->At(0);
-        auto values_col = tuple_col->At(1);
-
-        // The number of key-value pairs is the size of the keys/values columns
-        size_t map_size = keys_col->Size();
-
-        // Optimized: Convert columns to vectors directly, then build map in O(M)
-        std::vector<ERL_NIF_TERM> key_terms;
-        std::vector<ERL_NIF_TERM> value_terms;
-        key_terms.reserve(map_size);
-        value_terms.reserve(map_size);
-
-        // Convert keys column to vector
-        ERL_NIF_TERM keys_list = column_to_elixir_list(env, keys_col);
-        ERL_NIF_TERM key_tail = keys_list;
-        for (size_t j = 0; j < map_size; j++) {
-          ERL_NIF_TERM key;
-          if (enif_get_list_cell(env, key_tail, &key, &key_tail)) {
-            key_terms.push_back(key);
-          }
-        }
-
-        // Convert values column to vector
-        ERL_NIF_TERM values_list = column_to_elixir_list(env, values_col);
-        ERL_NIF_TERM value_tail = values_list;
-        for (size_t j = 0; j < map_size; j++) {
-          ERL_NIF_TERM value;
-          if (enif_get_list_cell(env, value_tail, &value, &value_tail)) {
-            value_terms.push_back(value);
-          }
-        }
-
-        // Build map in O(M) with enif_make_map_from_arrays
-        ERL_NIF_TERM elixir_map;
-        enif_make_map_from_arrays(env, key_terms.data(), value_terms.data(), map_size, &elixir_map);
-
-        values.push_back(elixir_map);
-      } else {
+      auto kv_tuples = map_col->GetAsColumn(row_at(rows, i));
+      auto tuple_col = kv_tuples->As<ColumnTuple>();
+      if (!tuple_col) {
         // Fallback for unexpected structure
-        values.push_back(enif_make_new_map(env));
+        out.push_back(enif_make_new_map(env));
+        continue;
       }
+
+      key_terms->clear();
+      value_terms->clear();
+      append_column_terms(env, tuple_col->At(0), *key_terms, opts);
+      append_column_terms(env, tuple_col->At(1), *value_terms, opts);
+
+      // Build map in O(M) with enif_make_map_from_arrays
+      ERL_NIF_TERM elixir_map;
+      enif_make_map_from_arrays(env, key_terms->data(), value_terms->data(),
+                                key_terms->size(), &elixir_map);
+      out.push_back(elixir_map);
     }
     break;
   }
-  case Type::Enum8: {
-    auto enum8_col = col->As<ColumnEnum8>();
-    // Handle Enum8 columns - return string names
-    for (size_t i = 0; i < count; i++) {
-      std::string_view name = enum8_col->NameAt(i);
-      ErlNifBinary bin;
-      enif_alloc_binary(name.size(), &bin);
-      std::memcpy(bin.data, name.data(), name.size());
-      values.push_back(enif_make_binary(env, &bin));
-    }
+  case Type::Enum8:
+    append_enum_names<ColumnEnum8>(env, col, rows, out);
     break;
-  }
-  case Type::Enum16: {
-    auto enum16_col = col->As<ColumnEnum16>();
-    // Handle Enum16 columns - return string names
-    for (size_t i = 0; i < count; i++) {
-      std::string_view name = enum16_col->NameAt(i);
-      ErlNifBinary bin;
-      enif_alloc_binary(name.size(), &bin);
-      std::memcpy(bin.data, name.data(), name.size());
-      values.push_back(enif_make_binary(env, &bin));
-    }
+  case Type::Enum16:
+    append_enum_names<ColumnEnum16>(env, col, rows, out);
     break;
-  }
   case Type::LowCardinality: {
+    // GetItem looks up the dictionary index and returns the value
     auto lc_col = col->As<ColumnLowCardinality>();
-    // Handle LowCardinality columns - decode values from dictionary
-    // For each row, get the decoded value by calling GetItem
-    // GetItem internally looks up the dictionary index and returns the value
     for (size_t i = 0; i < count; i++) {
-      auto item = lc_col->GetItem(i);
-
-      // Convert ItemView to Elixir term based on type
+      auto item = lc_col->GetItem(row_at(rows, i));
       if (item.type == Type::String) {
-        auto val = item.get<std::string_view>();
-        ErlNifBinary bin;
-        enif_alloc_binary(val.size(), &bin);
-        std::memcpy(bin.data, val.data(), val.size());
-        values.push_back(enif_make_binary(env, &bin));
+        out.push_back(make_binary_term(env, item.get<std::string_view>()));
       } else if (item.type == Type::Void) {
         // Null value
-        values.push_back(enif_make_atom(env, "nil"));
+        out.push_back(fine::encode(env, atoms::nil));
       } else {
-        // For other types, would need more handling
-        // For now, throw an error
         throw std::runtime_error("Unsupported LowCardinality inner type");
       }
     }
     break;
   }
   case Type::Nullable: {
+    // Walk the null map run by run: null runs are filled with the interned
+    // nil in bulk, value runs are copied from the nested column, which is
+    // decoded in one pass (null slots hold default values) unless every row
+    // is null
     auto nullable_col = col->As<ColumnNullable>();
-    auto nested = nullable_col->Nested();
-
-    // Optimized: Check nested type ONCE outside loop, then direct extraction
-    if (auto uint64_col = nested->As<ColumnUInt64>()) {
-      for (size_t i = 0; i < count; i++) {
-        if (nullable_col->IsNull(i)) {
-          values.push_back(enif_make_atom(env, "nil"));
-        } else {
-          values.push_back(enif_make_uint64(env, uint64_col->At(i)));
-        }
-      }
-    } else if (auto int64_col = nested->As<ColumnInt64>()) {
+    auto& null_map = nullable_col->Nulls()->As<ColumnUInt8>()->GetWritableData();
+    const uint8_t* nulls = null_map.data();
+    const uint8_t* nulls_end = nulls + count;
+    ERL_NIF_TERM nil = fine::encode(env, atoms::nil);
+
+    if (!decodes_null_slots(nullable_col->Nested()->GetType().GetCode())) {
+      // Decode only the non-null rows of the nested column
+      RowSelection present;
+      present.reserve(count);
       for (size_t i = 0; i < count; i++) {
-        if (nullable_col->IsNull(i)) {
-          values.push_back(enif_make_atom(env, "nil"));
-        } else {
-          values.push_back(enif_make_int64(env, int64_col->At(i)));
+        size_t row = row_at(rows, i);
+        if (!nulls[row]) {
+          present.push_back(static_cast<uint32_t>(row));
         }
       }
-    } else if (auto float64_col = nested->As<ColumnFloat64>()) {
+      ScratchTerms nested(present.size());
+      append_column_terms(env, nullable_col->Nested(), *nested, opts, &present);
+      size_t next = 0;
       for (size_t i = 0; i < count; i++) {
-        if (nullable_col->IsNull(i)) {
-          values.push_back(enif_make_atom(env, "nil"));
-        } else {
-          values.push_back(enif_make_double(env, float64_col->At(i)));
-        }
+        out.push_back(nulls[row_at(rows, i)] ? nil : (*nested)[next++]);
       }
-    } else if (auto string_col = nested->As<ColumnString>()) {
+      break;
+    }
+
+    if (rows) {
+      // Selected rows are scattered, so check the null map row by row
+      ScratchTerms nested(count);
+      append_column_terms(env, nullable_col->Nested(), *nested, opts, rows);
       for (size_t i = 0; i < count; i++) {
-        if (nullable_col->IsNull(i)) {
-          values.push_back(enif_make_atom(env, "nil"));
-        } else {
-          std::string_view val_view = string_col->At(i);
-          ErlNifBinary bin;
-          enif_alloc_binary(val_view.size(), &bin);
-          std::memcpy(bin.data, val_view.data(), val_view.size());
-          values.push_back(enif_make_binary(env, &bin));
-        }
+        out.push_back(nulls[(*rows)[i]] ? nil : (*nested)[i]);
       }
-    } else {
-      // Fallback for complex/uncommon types: use Slice approach
-      for (size_t i = 0; i < count; i++) {
-        if (nullable_col->IsNull(i)) {
-          values.push_back(enif_make_atom(env, "nil"));
-        } else {
-          auto single_value_col = nested->Slice(i, 1);
-          ERL_NIF_TERM elem_list = column_to_elixir_list(env, single_value_col);
-          ERL_NIF_TERM head, tail;
-          if (enif_get_list_cell(env, elem_list, &head, &tail)) {
-            values.push_back(head);
-          } else {
-            values.push_back(enif_make_atom(env, "error"));
-          }
-        }
+      break;
+    }
+
+    if (std::memchr(nulls, 0, count) == nullptr) {
+      fill_terms(out, count, nil);
+      break;
+    }
+    if (std::memchr(nulls, 1, count) == nullptr) {
+      append_column_terms(env, nullable_col->Nested(), out, opts);
+      break;
+    }
+
+    ScratchTerms nested(count);
+    append_column_terms(env, nullable_col->Nested(), *nested, opts);
+
+    size_t i = 0;
+    while (i < count) {
+      uint8_t is_null = nulls[i];
+      size_t run = byte_run_length(nulls + i, nulls_end, is_null);
+      if (is_null) {
+        fill_terms(out, run, nil);
+      } else {
+        out.insert(out.end(), nested->begin() + i, nested->begin() + i + run);
       }
+      i += run;
     }
     break;
   }
@@ -391,317 +510,481 @@ ERL_NIF_TERM column_to_elixir_list(ErlNifEnv *env, ColumnRef col) {
     // Unsupported or unknown type
     throw std::runtime_error("Unsupported column type in column_to_elixir_list");
   }
-
-  return enif_make_list_from_array(env, values.data(), values.size());
 }
 
-// Helper to convert Block to maps and append to output vector
-void block_to_maps_impl(ErlNifEnv *env, std::shared_ptr<Block> block, std::vector<ERL_NIF_TERM>& out_maps) {
-  size_t col_count = block->GetColumnCount();
-  size_t row_count = block->GetRowCount();
+// Helper to recursively convert a column to an Elixir list
+// This handles all column types including nested arrays
+ERL_NIF_TERM column_to_elixir_list(ErlNifEnv *env, ColumnRef col, const SelectOptions& opts = {}) {
+  ScratchTerms values(col->Size());
+  append_column_terms(env, col, *values, opts);
+  return enif_make_list_from_array(env, values->data(), values->size());
+}
 
-  if (row_count == 0) {
-    return;  // Nothing to add
+// Direct decoding of Native-format bytes (see native_format.h)
+//
+// Column data in a Native block is the same encoding the server sends on
+// the wire. For plain types it is read straight from the bytes into terms,
+// skipping the Column objects a block would otherwise be loaded into:
+// numerics, Date/DateTime/DateTime64 and UUID are fixed-width little-endian
+// values, String is a varint length then the bytes, Nullable is a null map
+// then the nested data, Array is cumulative UInt64 offsets then the
+// flattened elements. Anything else (LowCardinality, Enum, Tuple, Map,
+// Decimal, ...) falls back to Column::Load and append_column_terms, so both
+// paths produce identical terms.
+
+// Whether `type` (and everything nested in it) is read directly
+static bool wire_decodable(const TypeRef& type) {
+  switch (type->GetCode()) {
+  case Type::UInt8: case Type::UInt16: case Type::UInt32: case Type::UInt64:
+  case Type::Int8: case Type::Int16: case Type::Int32: case Type::Int64:
+  case Type::Float32: case Type::Float64:
+  case Type::String: case Type::Date: case Type::DateTime: case Type::DateTime64:
+  case Type::UUID:
+    return true;
+  case Type::Nullable:
+    return wire_decodable(type->As<NullableType>()->GetNestedType());
+  case Type::Array:
+    return wire_decodable(type->As<ArrayType>()->GetItemType());
+  default:
+    return false;
   }
+}
 
-  // Extract column names and data
-  std::vector<std::string> col_names;
-  std::vector<std::vector<ERL_NIF_TERM>> col_data;
+// The next `size` bytes of the input, in place
+inline const uint8_t* wire_take(ArrayInput& input, size_t size) {
+  const void* data = nullptr;
+  if (size > 0 && input.Next(&data, size) != size) {
+    throw ProtocolError("truncated Native column data");
+  }
+  return static_cast<const uint8_t*>(data);
+}
 
-  for (size_t c = 0; c < col_count; c++) {
-    col_names.push_back(block->GetColumnName(c));
+// Counts come from the data, so check that `count` values of `width` bytes
+// fit in what is left before multiplying or sizing anything by them
+inline void wire_require(ArrayInput& input, uint64_t count, size_t width) {
+  if (count > input.Avail() / width) {
+    throw ProtocolError("truncated Native column data");
+  }
+}
 
-    ColumnRef col = (*block)[c];
-    std::vector<ERL_NIF_TERM> column_values;
-    column_values.reserve(row_count);
+template <typename T, typename MakeTerm>
+inline void wire_each(ArrayInput& input, size_t count, std::vector<ERL_NIF_TERM>& out,
+                      MakeTerm make_term) {
+  wire_require(input, count, sizeof(T));
+  const uint8_t* data = wire_take(input, count * sizeof(T));
+  for (size_t i = 0; i < count; i++) {
+    T value;
+    std::memcpy(&value, data + i * sizeof(T), sizeof(T));
+    out.push_back(make_term(value));
+  }
+}
 
-    // Extract column data based on type
-    if (auto uint64_col = col->As<ColumnUInt64>()) {
-      for (size_t i = 0; i < row_count; i++) {
-        column_values.push_back(enif_make_uint64(env, uint64_col->At(i)));
-      }
-    } else if (auto uint32_col = col->As<ColumnUInt32>()) {
-      for (size_t i = 0; i < row_count; i++) {
-        column_values.push_back(enif_make_uint64(env, uint32_col->At(i)));
-      }
-    } else if (auto uint16_col = col->As<ColumnUInt16>()) {
-      for (size_t i = 0; i < row_count; i++) {
-        column_values.push_back(enif_make_uint64(env, uint16_col->At(i)));
-      }
-    } else if (auto uint8_col = col->As<ColumnUInt8>()) {
-      for (size_t i = 0; i < row_count; i++) {
-        column_values.push_back(enif_make_uint64(env, uint8_col->At(i)));
-      }
-    } else if (auto int64_col = col->As<ColumnInt64>()) {
-      for (size_t i = 0; i < row_count; i++) {
-        column_values.push_back(enif_make_int64(env, int64_col->At(i)));
-      }
-    } else if (auto int32_col = col->As<ColumnInt32>()) {
-      for (size_t i = 0; i < row_count; i++) {
-        column_values.push_back(enif_make_int64(env, int32_col->At(i)));
-      }
-    } else if (auto int16_col = col->As<ColumnInt16>()) {
-      for (size_t i = 0; i < row_count; i++) {
-        column_values.push_back(enif_make_int64(env, int16_col->At(i)));
-      }
-    } else if (auto int8_col = col->As<ColumnInt8>()) {
-      for (size_t i = 0; i < row_count; i++) {
-        column_values.push_back(enif_make_int64(env, int8_col->At(i)));
-      }
-    } else if (auto float64_col = col->As<ColumnFloat64>()) {
-      for (size_t i = 0; i < row_count; i++) {
-        column_values.push_back(enif_make_double(env, float64_col->At(i)));
-      }
-    } else if (auto float32_col = col->As<ColumnFloat32>()) {
-      for (size_t i = 0; i < row_count; i++) {
-        column_values.push_back(enif_make_double(env, float32_col->At(i)));
-      }
-    } else if (auto string_col = col->As<ColumnString>()) {
-      for (size_t i = 0; i < row_count; i++) {
-        std::string_view val_view = string_col->At(i);
-        ErlNifBinary bin;
-        enif_alloc_binary(val_view.size(), &bin);
-        std::memcpy(bin.data, val_view.data(), val_view.size());
-        column_values.push_back(enif_make_binary(env, &bin));
-      }
-    } else if (auto datetime_col = col->As<ColumnDateTime>()) {
-      for (size_t i = 0; i < row_count; i++) {
-        column_values.push_back(enif_make_uint64(env, datetime_col->At(i)));
-      }
-    } else if (auto datetime64_col = col->As<ColumnDateTime64>()) {
-      for (size_t i = 0; i < row_count; i++) {
-        column_values.push_back(enif_make_int64(env, datetime64_col->At(i)));
-      }
-    } else if (auto date_col = col->As<ColumnDate>()) {
-      for (size_t i = 0; i < row_count; i++) {
-        column_values.push_back(enif_make_uint64(env, date_col->RawAt(i)));
-      }
-    } else if (auto uuid_col = col->As<ColumnUUID>()) {
-      for (size_t i = 0; i < row_count; i++) {
-        UUID uuid = uuid_col->At(i);
-        char uuid_buf[37];
-        format_uuid_to_buffer(uuid, uuid_buf);
-        ErlNifBinary bin;
-        enif_alloc_binary(36, &bin);
-        std::memcpy(bin.data, uuid_buf, 36);
-        column_values.push_back(enif_make_binary(env, &bin));
-      }
-    } else if (auto decimal_col = col->As<ColumnDecimal>()) {
-      for (size_t i = 0; i < row_count; i++) {
-        Int128 value = decimal_col->At(i);
-        // Convert Int128 to int64 for Elixir (assumes value fits in int64)
-        // Elixir will convert back to Decimal by dividing by 10^scale
-        int64_t scaled_value = static_cast<int64_t>(value);
-        column_values.push_back(enif_make_int64(env, scaled_value));
-      }
-    } else if (auto array_col = col->As<ColumnArray>()) {
-      // Handle array columns - recursively converts nested arrays to Elixir lists
-      for (size_t i = 0; i < row_count; i++) {
-        auto nested = array_col->GetAsColumn(i);
-        column_values.push_back(column_to_elixir_list(env, nested));
+// Decode `count` values of a wire_decodable type from `input` into `out`
+void append_wire_terms(ErlNifEnv *env, const TypeRef& type, size_t count, ArrayInput& input,
+                       std::vector<ERL_NIF_TERM>& out) {
+  Type::Code code = type->GetCode();
+  // Every wire_decodable type takes at least one byte per value
+  wire_require(input, count, 1);
+  DecodeScope scope(code, count);
+  reserve_terms(out, count);
+
+  switch (code) {
+  case Type::UInt64:
+    wire_each<uint64_t>(input, count, out, [env](uint64_t v) { return enif_make_uint64(env, v); });
+    break;
+  case Type::UInt32:
+  case Type::DateTime:
+    wire_each<uint32_t>(input, count, out, [env](uint32_t v) { return enif_make_uint64(env, v); });
+    break;
+  case Type::UInt16:
+  case Type::Date:
+    wire_each<uint16_t>(input, count, out, [env](uint16_t v) { return enif_make_uint64(env, v); });
+    break;
+  case Type::UInt8:
+    wire_each<uint8_t>(input, count, out, [env](uint8_t v) { return enif_make_uint64(env, v); });
+    break;
+  case Type::Int64:
+  case Type::DateTime64:
+    wire_each<int64_t>(input, count, out, [env](int64_t v) { return enif_make_int64(env, v); });
+    break;
+  case Type::Int32:
+    wire_each<int32_t>(input, count, out, [env](int32_t v) { return enif_make_int64(env, v); });
+    break;
+  case Type::Int16:
+    wire_each<int16_t>(input, count, out, [env](int16_t v) { return enif_make_int64(env, v); });
+    break;
+  case Type::Int8:
+    wire_each<int8_t>(input, count, out, [env](int8_t v) { return enif_make_int64(env, v); });
+    break;
+  case Type::Float64:
+    wire_each<double>(input, count, out, [env](double v) { return enif_make_double(env, v); });
+    break;
+  case Type::Float32:
+    wire_each<float>(input, count, out, [env](float v) { return enif_make_double(env, v); });
+    break;
+  case Type::String: {
+    // Consecutive equal strings share one binary, as in append_column_terms
+    std::string_view previous;
+    ERL_NIF_TERM previous_term = 0;
+    for (size_t i = 0; i < count; i++) {
+      uint64_t length;
+      if (!WireFormat::ReadUInt64(input, &length)) {
+        throw ProtocolError("truncated Native column data");
       }
-    } else if (auto map_col = col->As<ColumnMap>()) {
-      // Handle map columns - use column_to_elixir_list for complex nested structure
-      for (size_t i = 0; i < row_count; i++) {
-        auto kv_tuples = map_col->GetAsColumn(i);
-
-        if (auto tuple_col = kv_tuples->As<ColumnTuple>()) {
-          auto keys_col = tuple_col->At(0);
-          auto values_col = tuple_col->At(1);
-          size_t map_size = keys_col->Size();
-
-          // Optimized: Convert columns to vectors directly, then build map in O(M)
-          std::vector<ERL_NIF_TERM> key_terms;
-          std::vector<ERL_NIF_TERM> value_terms;
-          key_terms.reserve(map_size);
-          value_terms.reserve(map_size);
-
-          // Convert keys column to vector
-          ERL_NIF_TERM keys_list = column_to_elixir_list(env, keys_col);
-          ERL_NIF_TERM key_tail = keys_list;
-          for (size_t j = 0; j < map_size; j++) {
-            ERL_NIF_TERM key;
-            if (enif_get_list_cell(env, key_tail, &key, &key_tail)) {
-              key_terms.push_back(key);
-            }
-          }
-
-          // Convert values column to vector
-          ERL_NIF_TERM values_list = column_to_elixir_list(env, values_col);
-          ERL_NIF_TERM value_tail = values_list;
-          for (size_t j = 0; j < map_size; j++) {
-            ERL_NIF_TERM value;
-            if (enif_get_list_cell(env, value_tail, &value, &value_tail)) {
-              value_terms.push_back(value);
-            }
-          }
-
-          // Build map in O(M) with enif_make_map_from_arrays
-          ERL_NIF_TERM elixir_map;
-          enif_make_map_from_arrays(env, key_terms.data(), value_terms.data(), map_size, &elixir_map);
-
-          column_values.push_back(elixir_map);
-        } else {
-          column_values.push_back(enif_make_new_map(env));
-        }
+      std::string_view value(reinterpret_cast<const char*>(wire_take(input, length)), length);
+      if (previous_term == 0 || value != previous) {
+        previous = value;
+        previous_term = make_binary_term(env, value);
       }
-    } else if (auto tuple_col = col->As<ColumnTuple>()) {
-      // Handle tuple columns - use column_to_elixir_list for complex logic
-      size_t tuple_size = tuple_col->TupleSize();
+      out.push_back(previous_term);
+    }
+    break;
+  }
+  case Type::UUID: {
+    // Two UInt64 halves per value, high first
+    wire_require(input, count, 16);
+    const uint8_t* data = wire_take(input, count * 16);
+    char uuid_buf[37];
+    for (size_t i = 0; i < count; i++) {
+      UUID uuid;
+      std::memcpy(&uuid.first, data + i * 16, 8);
+      std::memcpy(&uuid.second, data + i * 16 + 8, 8);
+      format_uuid_to_buffer(uuid, uuid_buf);
+      out.push_back(make_binary_term(env, std::string_view(uuid_buf, 36)));
+    }
+    break;
+  }
+  case Type::Nullable: {
+    const uint8_t* nulls = wire_take(input, count);
+    ERL_NIF_TERM nil = fine::encode(env, atoms::nil);
+    TypeRef nested_type = type->As<NullableType>()->GetNestedType();
 
-      // Optimized: Pre-convert each element column ONCE, then index directly
-      std::vector<std::vector<ERL_NIF_TERM>> element_columns;
-      element_columns.reserve(tuple_size);
+    if (std::memchr(nulls, 1, count) == nullptr) {
+      append_wire_terms(env, nested_type, count, input, out);
+      break;
+    }
+    ScratchTerms nested(count);
+    append_wire_terms(env, nested_type, count, input, *nested);
+    for (size_t i = 0; i < count; i++) {
+      out.push_back(nulls[i] ? nil : (*nested)[i]);
+    }
+    break;
+  }
+  case Type::Array: {
+    // Offsets are cumulative: row i holds elements [offsets[i-1], offsets[i])
+    wire_require(input, count, sizeof(uint64_t));
+    const uint8_t* offsets = wire_take(input, count * sizeof(uint64_t));
+    uint64_t total = 0;
+    if (count > 0) {
+      std::memcpy(&total, offsets + (count - 1) * sizeof(uint64_t), sizeof(uint64_t));
+    }
+    wire_require(input, total, 1);
+    ScratchTerms elements(total);
+    append_wire_terms(env, type->As<ArrayType>()->GetItemType(), total, input, *elements);
 
-      for (size_t j = 0; j < tuple_size; j++) {
-        auto element_col = tuple_col->At(j);
-        // Convert entire element column to Elixir list, then extract to vector
-        ERL_NIF_TERM elem_list = column_to_elixir_list(env, element_col);
-        std::vector<ERL_NIF_TERM> elem_vec;
-        elem_vec.reserve(row_count);
-        ERL_NIF_TERM tail = elem_list;
-        for (size_t i = 0; i < row_count; i++) {
-          ERL_NIF_TERM head;
-          if (enif_get_list_cell(env, tail, &head, &tail)) {
-            elem_vec.push_back(head);
-          } else {
-            elem_vec.push_back(enif_make_atom(env, "error"));
-          }
-        }
-        element_columns.push_back(std::move(elem_vec));
+    uint64_t begin = 0;
+    for (size_t i = 0; i < count; i++) {
+      uint64_t end;
+      std::memcpy(&end, offsets + i * sizeof(uint64_t), sizeof(uint64_t));
+      if (end < begin || end > total) {
+        throw ProtocolError("invalid Array offsets in Native column data");
       }
+      out.push_back(enif_make_list_from_array(env, elements->data() + begin, end - begin));
+      begin = end;
+    }
+    break;
+  }
+  default:
+    throw std::runtime_error("Unsupported column type in append_wire_terms");
+  }
+}
 
-      // Now build tuples by indexing pre-converted columns
-      for (size_t i = 0; i < row_count; i++) {
-        std::vector<ERL_NIF_TERM> tuple_elements;
-        tuple_elements.reserve(tuple_size);
-        for (size_t j = 0; j < tuple_size; j++) {
-          tuple_elements.push_back(element_columns[j][i]);
-        }
-        column_values.push_back(enif_make_tuple_from_array(env, tuple_elements.data(), tuple_elements.size()));
-      }
-    } else if (auto enum8_col = col->As<ColumnEnum8>()) {
-      // Handle Enum8 columns
-      for (size_t i = 0; i < row_count; i++) {
-        std::string_view name = enum8_col->NameAt(i);
-        ErlNifBinary bin;
-        enif_alloc_binary(name.size(), &bin);
-        std::memcpy(bin.data, name.data(), name.size());
-        column_values.push_back(enif_make_binary(env, &bin));
-      }
-    } else if (auto enum16_col = col->As<ColumnEnum16>()) {
-      // Handle Enum16 columns
-      for (size_t i = 0; i < row_count; i++) {
-        std::string_view name = enum16_col->NameAt(i);
-        ErlNifBinary bin;
-        enif_alloc_binary(name.size(), &bin);
-        std::memcpy(bin.data, name.data(), name.size());
-        column_values.push_back(enif_make_binary(env, &bin));
-      }
-    } else if (auto lc_col = col->As<ColumnLowCardinality>()) {
-      // Handle LowCardinality columns
-      for (size_t i = 0; i < row_count; i++) {
-        auto item = lc_col->GetItem(i);
-        if (item.type == Type::String) {
-          auto val = item.get<std::string_view>();
-          ErlNifBinary bin;
-          enif_alloc_binary(val.size(), &bin);
-          std::memcpy(bin.data, val.data(), val.size());
-          column_values.push_back(enif_make_binary(env, &bin));
-        } else if (item.type == Type::Void) {
-          column_values.push_back(enif_make_atom(env, "nil"));
-        } else {
-          throw std::runtime_error("Unsupported LowCardinality inner type");
-        }
-      }
-    } else if (auto nullable_col = col->As<ColumnNullable>()) {
-      auto nested = nullable_col->Nested();
-
-      // Optimized: Check nested type ONCE outside loop, then direct extraction
-      if (auto uint64_col = nested->As<ColumnUInt64>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          if (nullable_col->IsNull(i)) {
-            column_values.push_back(enif_make_atom(env, "nil"));
-          } else {
-            column_values.push_back(enif_make_uint64(env, uint64_col->At(i)));
-          }
-        }
-      } else if (auto int64_col = nested->As<ColumnInt64>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          if (nullable_col->IsNull(i)) {
-            column_values.push_back(enif_make_atom(env, "nil"));
-          } else {
-            column_values.push_back(enif_make_int64(env, int64_col->At(i)));
-          }
-        }
-      } else if (auto float64_col = nested->As<ColumnFloat64>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          if (nullable_col->IsNull(i)) {
-            column_values.push_back(enif_make_atom(env, "nil"));
-          } else {
-            column_values.push_back(enif_make_double(env, float64_col->At(i)));
-          }
-        }
-      } else if (auto string_col = nested->As<ColumnString>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          if (nullable_col->IsNull(i)) {
-            column_values.push_back(enif_make_atom(env, "nil"));
-          } else {
-            std::string_view val_view = string_col->At(i);
-            ErlNifBinary bin;
-            enif_alloc_binary(val_view.size(), &bin);
-            std::memcpy(bin.data, val_view.data(), val_view.size());
-            column_values.push_back(enif_make_binary(env, &bin));
-          }
-        }
-      } else {
-        // Fallback for complex/uncommon types: use Slice approach
-        for (size_t i = 0; i < row_count; i++) {
-          if (nullable_col->IsNull(i)) {
-            column_values.push_back(enif_make_atom(env, "nil"));
-          } else {
-            auto single_value_col = nested->Slice(i, 1);
-            ERL_NIF_TERM elem_list = column_to_elixir_list(env, single_value_col);
-            ERL_NIF_TERM head, tail;
-            if (enif_get_list_cell(env, elem_list, &head, &tail)) {
-              column_values.push_back(head);
-            } else {
-              column_values.push_back(enif_make_atom(env, "error"));
-            }
-          }
-        }
+// Decode one Native block from `input`: column names into `names`, each
+// column's values appended to `out` (column-major). Returns the row count.
+size_t append_native_block_terms(ErlNifEnv *env, ArrayInput& input,
+                                 std::vector<std::string>& names,
+                                 std::vector<ERL_NIF_TERM>& out) {
+  uint64_t columns = 0;
+  uint64_t rows = 0;
+  if (!WireFormat::ReadUInt64(input, &columns) || !WireFormat::ReadUInt64(input, &rows)) {
+    throw ProtocolError("truncated Native block header");
+  }
+
+  // Each column header takes at least two bytes and each value at least
+  // one, so larger counts cannot be backed by the input (and would
+  // overflow columns * rows)
+  if (columns > input.Avail() / 2 ||
+      (rows > 0 && (columns == 0 || rows > input.Avail() / columns))) {
+    throw ProtocolError("truncated Native block: header counts exceed the data");
+  }
+
+  names.clear();
+  reserve_terms(out, columns * rows);
+  for (uint64_t c = 0; c < columns; c++) {
+    std::string name;
+    std::string type_name;
+    if (!WireFormat::ReadString(input, &name) || !WireFormat::ReadString(input, &type_name)) {
+      throw ProtocolError("truncated Native column header");
+    }
+
+    // An empty column of the type parses the type name and, for the
+    // fallback, is what the data loads into
+    ColumnRef column = CreateColumnByType(type_name);
+    if (!column) {
+      throw ProtocolError("unsupported column type in Native block: " + type_name);
+    }
+    if (wire_decodable(column->Type())) {
+      append_wire_terms(env, column->Type(), rows, input, out);
+    } else {
+      if (rows > 0 && !column->Load(&input, rows)) {
+        throw ProtocolError("truncated Native data for column " + name);
       }
+      append_column_terms(env, column, out, SelectOptions{});
     }
+    names.push_back(std::move(name));
+  }
+  return rows;
+}
+
+// Per-query row selection: the filter, then sampling
+class RowSelector {
+public:
+  explicit RowSelector(const SelectOptions& opts) : opts_(opts), sampler_(opts.sample) {}
 
-    col_data.push_back(column_values);
+  // Rows of `block` to decode now; nullptr for all of them
+  const RowSelection* Select(const Block& block) {
+    return sampler_.Select(block, select_block_rows(block, opts_.filter, filtered_));
   }
 
-  // Pre-create column name atoms once (major optimization)
-  std::vector<ERL_NIF_TERM> key_atoms;
-  key_atoms.reserve(col_count);
-  for (size_t c = 0; c < col_count; c++) {
-    key_atoms.push_back(enif_make_atom(env, col_names[c].c_str()));
+  // A reservoir sample is decoded once, after the last block
+  std::optional<Block> TakeReservoir() {
+    return sampler_.TakeReservoir();
   }
 
-  // Build maps in local vector first for better cache locality
-  std::vector<ERL_NIF_TERM> rows;
-  rows.reserve(row_count);
+private:
+  const SelectOptions& opts_;
+  RowSelection filtered_;
+  RowSampler sampler_;
+};
 
-  // Build maps row by row, reusing the pre-created key atoms
-  for (size_t r = 0; r < row_count; r++) {
-    ERL_NIF_TERM values[col_count];
+// Build one map per row from column-major decoded values, reusing the
+// pre-created key atoms
+void append_row_maps(ErlNifEnv *env, const std::vector<ERL_NIF_TERM>& key_atoms,
+                     const std::vector<ERL_NIF_TERM>& col_data, size_t row_count,
+                     std::vector<ERL_NIF_TERM>& out_maps) {
+  size_t col_count = key_atoms.size();
+  ScratchTerms values(col_count);
+  values->resize(col_count);
+  reserve_terms(out_maps, row_count);
 
+  for (size_t r = 0; r < row_count; r++) {
     for (size_t c = 0; c < col_count; c++) {
-      values[c] = col_data[c][r];
+      (*values)[c] = col_data[c * row_count + r];
     }
 
     ERL_NIF_TERM map;
-    enif_make_map_from_arrays(env, key_atoms.data(), values, col_count, &map);
-    rows.push_back(map);
+    enif_make_map_from_arrays(env, key_atoms.data(), values->data(), col_count, &map);
+    out_maps.push_back(map);
+  }
+}
+
+// Helper to convert Block to maps and append to output vector
+// Only `rows` are converted when given (see RowSelector)
+void block_to_maps_impl(ErlNifEnv *env, const Block& block, std::vector<ERL_NIF_TERM>& out_maps,
+                        const SelectOptions& opts, const RowSelection* rows = nullptr) {
+  size_t col_count = block.GetColumnCount();
+  size_t row_count = rows ? rows->size() : block.GetRowCount();
+
+  if (row_count == 0) {
+    return;  // Nothing to add
+  }
+
+  // Decode all columns into one column-major scratch buffer
+  NATCH_PROBE2(decode__start, row_count, col_count);
+  ScratchTerms col_data(col_count * row_count);
+  for (size_t c = 0; c < col_count; c++) {
+    append_column_terms(env, block[c], *col_data, opts, rows);
   }
 
-  // Append all rows at once to output vector
-  out_maps.insert(out_maps.end(), rows.begin(), rows.end());
+  // Pre-create column name atoms once (major optimization)
+  ScratchTerms key_atoms(col_count);
+  for (size_t c = 0; c < col_count; c++) {
+    key_atoms->push_back(enif_make_atom(env, block.GetColumnName(c).c_str()));
+  }
+
+  append_row_maps(env, *key_atoms, *col_data, row_count, out_maps);
+  NATCH_PROBE1(decode__done, row_count);
+}
+
+// ClickHouse name for the type codes the decoder handles
+static const char* type_code_name(size_t code) {
+  switch (static_cast<Type::Code>(code)) {
+  case Type::UInt64: return "UInt64";
+  case Type::UInt32: return "UInt32";
+  case Type::UInt16: return "UInt16";
+  case Type::UInt8: return "UInt8";
+  case Type::Int64: return "Int64";
+  case Type::Int32: return "Int32";
+  case Type::Int16: return "Int16";
+  case Type::Int8: return "Int8";
+  case Type::Float64: return "Float64";
+  case Type::Float32: return "Float32";
+  case Type::String: return "String";
+  case Type::DateTime: return "DateTime";
+  case Type::DateTime64: return "DateTime64";
+  case Type::Date: return "Date";
+  case Type::UUID: return "UUID";
+  case Type::Decimal: return "Decimal";
+  case Type::Decimal32: return "Decimal32";
+  case Type::Decimal64: return "Decimal64";
+  case Type::Decimal128: return "Decimal128";
+  case Type::Array: return "Array";
+  case Type::Tuple: return "Tuple";
+  case Type::Map: return "Map";
+  case Type::Enum8: return "Enum8";
+  case Type::Enum16: return "Enum16";
+  case Type::LowCardinality: return "LowCardinality";
+  case Type::Nullable: return "Nullable";
+  default: return "Other";
+  }
+}
+
+// Build %{"TypeName" => %{values: n, nanoseconds: n, binary_bytes: n}} for
+// every type that decoded at least one value
+static ERL_NIF_TERM decode_stats_to_map(ErlNifEnv *env, const DecodeTally& stats) {
+  ERL_NIF_TERM result = enif_make_new_map(env);
+  ERL_NIF_TERM keys[] = {
+    fine::encode(env, atoms::values),
+    fine::encode(env, atoms::nanoseconds),
+    fine::encode(env, atoms::binary_bytes)
+  };
+
+  for (size_t code = 0; code < DecodeStats::kMaxCodes; code++) {
+    const DecodeTally::Counters& counters = stats.codes[code];
+    if (counters.values == 0) {
+      continue;
+    }
+
+    ERL_NIF_TERM values[] = {
+      enif_make_uint64(env, counters.values),
+      enif_make_uint64(env, counters.nanoseconds),
+      enif_make_uint64(env, counters.binary_bytes)
+    };
+    ERL_NIF_TERM entry;
+    enif_make_map_from_arrays(env, keys, values, 3, &entry);
+    enif_make_map_put(env, result, make_binary_term(env, type_code_name(code)), entry, &result);
+  }
+  return result;
+}
+
+// Collects one query's decode stats when opts.decode_stats is set
+// Attach() then returns {result, stats} instead of the bare result. The
+// query's counts are added to the process-wide ones when it ends.
+class QueryStatsCollector {
+public:
+  explicit QueryStatsCollector(const SelectOptions& opts)
+      : enabled_(opts.decode_stats), guard_(enabled_ ? &stats_ : nullptr) {}
+
+  ~QueryStatsCollector() {
+    if (enabled_) {
+      DecodeStats::Global().Add(stats_);
+    }
+  }
+
+  QueryStatsCollector(const QueryStatsCollector&) = delete;
+  QueryStatsCollector& operator=(const QueryStatsCollector&) = delete;
+
+  ERL_NIF_TERM Attach(ErlNifEnv *env, ERL_NIF_TERM result) {
+    if (!enabled_) {
+      return result;
+    }
+    return enif_make_tuple2(env, result, decode_stats_to_map(env, stats_));
+  }
+
+private:
+  DecodeTally stats_;
+  bool enabled_;
+  DecodeScope::QueryGuard guard_;
+};
+
+// Block callback wrapper honouring opts.cancel_token
+// Returns false (stop the query) once the token is cancelled.
+template <typename OnBlock>
+auto cancelable_callback(ErlNifEnv *env, const SelectOptions& opts, OnBlock& on_block) {
+  return [env, &opts, &on_block](const Block &block) {
+    CancelToken& token = **opts.cancel_token;
+    if (token.cancelled.load(std::memory_order_relaxed)) {
+      return false;
+    }
+    on_block(block);
+    token.NotifyFirstBlock(env, block);
+    return !token.cancelled.load(std::memory_order_relaxed);
+  };
+}
+
+// Cancelled queries return partial data; surface them as an error instead
+inline void check_not_cancelled(const SelectOptions& opts) {
+  if (opts.cancel_token && (*opts.cancel_token)->cancelled.load()) {
+    throw std::runtime_error("Query cancelled");
+  }
+}
+
+// Wrap on_block with the block__receive probe, counting rows for query__done
+template <typename OnBlock>
+auto traced_callback(OnBlock& on_block, uint64_t& rows) {
+  return [&on_block, &rows](const Block &block) {
+    NATCH_PROBE2(block__receive, block.GetRowCount(), block.GetColumnCount());
+    rows += block.GetRowCount();
+    on_block(block);
+  };
+}
+
+// Run a SELECT, feeding every block to on_block
+template <typename OnBlock>
+void run_select(ErlNifEnv *env, Client& client, const std::string& sql, const SelectOptions& opts,
+                OnBlock on_block) {
+  uint64_t rows = 0;
+  auto traced = traced_callback(on_block, rows);
+  NATCH_PROBE1(query__start, sql.c_str());
+  try {
+    if (opts.cancel_token) {
+      client.SelectCancelable(sql, cancelable_callback(env, opts, traced));
+    } else {
+      client.Select(sql, traced);
+    }
+    check_not_cancelled(opts);
+  } catch (const std::exception& e) {
+    NATCH_PROBE1(query__error, e.what());
+    throw;
+  }
+  NATCH_PROBE1(query__done, rows);
+}
+
+template <typename OnBlock>
+void run_select(ErlNifEnv *env, Client& client, Query& query, const SelectOptions& opts,
+                OnBlock on_block) {
+  uint64_t rows = 0;
+  auto traced = traced_callback(on_block, rows);
+
+  // Set callback on the Query object before calling Select. Query invokes
+  // both callback kinds, so clear whichever one this call doesn't use.
+  if (opts.cancel_token) {
+    query.OnData(nullptr);
+    query.OnDataCancelable(cancelable_callback(env, opts, traced));
+  } else {
+    query.OnDataCancelable(nullptr);
+    query.OnData(traced);
+  }
+
+  NATCH_PROBE1(query__start, query.GetText().c_str());
+  try {
+    client.Select(query);
+    check_not_cancelled(opts);
+  } catch (const std::exception& e) {
+    NATCH_PROBE1(query__error, e.what());
+    throw;
+  }
+  NATCH_PROBE1(query__done, rows);
 }
 
 // Wrapper struct to return list of maps from FINE NIF
@@ -733,54 +1016,57 @@ namespace fine {
 SelectResult client_select(
     ErlNifEnv *env,
     fine::ResourcePtr<Client> client,
-    std::string query) {
+    std::string query,
+    fine::Term options) {
+
+  SelectOptions opts = decode_select_options(env, options);
+  QueryStatsCollector query_stats(opts);
 
   // Collect all result maps immediately in the callback
-  std::vector<ERL_NIF_TERM> all_maps;
+  ScratchTerms all_maps(0);
+  RowSelector selector(opts);
 
-  client->Select(query, [&](const Block &block) {
+  run_select(env, *client, query, opts, [&](const Block &block) {
     // Convert this block to maps and append directly to all_maps
-    auto block_ptr = std::make_shared<Block>(block);
-    block_to_maps_impl(env, block_ptr, all_maps);
+    block_to_maps_impl(env, block, *all_maps, opts, selector.Select(block));
   });
-
-  // Build final list from all maps
-  if (all_maps.empty()) {
-    return SelectResult(enif_make_list(env, 0));
+  if (auto sample = selector.TakeReservoir()) {
+    block_to_maps_impl(env, *sample, *all_maps, opts);
   }
 
-  return SelectResult(enif_make_list_from_array(env, all_maps.data(), all_maps.size()));
+  ERL_NIF_TERM rows = enif_make_list_from_array(env, all_maps->data(), all_maps->size());
+  return SelectResult(query_stats.Attach(env, rows));
 }
 
-FINE_NIF(client_select, 0);
+FINE_NIF(client_select, ERL_NIF_DIRTY_JOB_IO_BOUND);
 
 // Execute parameterized SELECT query and return list of maps
 SelectResult client_select_parameterized(
     ErlNifEnv *env,
     fine::ResourcePtr<Client> client,
-    fine::ResourcePtr<Query> query) {
+    fine::ResourcePtr<Query> query,
+    fine::Term options) {
+
+  SelectOptions opts = decode_select_options(env, options);
+  QueryStatsCollector query_stats(opts);
 
   // Collect all result maps immediately in the callback
-  std::vector<ERL_NIF_TERM> all_maps;
+  ScratchTerms all_maps(0);
+  RowSelector selector(opts);
 
-  // Set callback on the Query object before calling Select
-  query->OnData([&](const Block &block) {
+  run_select(env, *client, *query, opts, [&](const Block &block) {
     // Convert this block to maps and append directly to all_maps
-    auto block_ptr = std::make_shared<Block>(block);
-    block_to_maps_impl(env, block_ptr, all_maps);
+    block_to_maps_impl(env, block, *all_maps, opts, selector.Select(block));
   });
-
-  client->Select(*query);
-
-  // Build final list from all maps
-  if (all_maps.empty()) {
-    return SelectResult(enif_make_list(env, 0));
+  if (auto sample = selector.TakeReservoir()) {
+    block_to_maps_impl(env, *sample, *all_maps, opts);
   }
 
-  return SelectResult(enif_make_list_from_array(env, all_maps.data(), all_maps.size()));
+  ERL_NIF_TERM rows = enif_make_list_from_array(env, all_maps->data(), all_maps->size());
+  return SelectResult(query_stats.Attach(env, rows));
 }
 
-FINE_NIF(client_select_parameterized, 0);
+FINE_NIF(client_select_parameterized, ERL_NIF_DIRTY_JOB_IO_BOUND);
 
 // Wrapper struct to return columnar map from FINE NIF
 struct ColumnarResult {
@@ -806,19 +1092,43 @@ namespace fine {
   };
 }
 
-// Execute SELECT query and return columnar format: %{column_name => [values]}
-ColumnarResult client_select_cols(
-    ErlNifEnv *env,
-    fine::ResourcePtr<Client> client,
-    std::string query) {
+// Accumulates SELECT blocks into per-column term buffers
+// Buffers come from the thread's pool and go back to it once the result
+// lists are built, so repeated queries reuse the same allocations
+class ColumnarAccumulator {
+public:
+  explicit ColumnarAccumulator(const SelectOptions& opts) : opts_(opts), selector_(opts_) {}
 
-  // Pre-create column structure on first block (indexed vectors for O(1) access)
-  std::vector<std::string> col_names;
-  std::vector<ERL_NIF_TERM> key_atoms;
-  std::vector<std::vector<ERL_NIF_TERM>> all_columns;
-  bool first_block = true;
+  ~ColumnarAccumulator() {
+    for (auto& column : columns_) {
+      TermBufferPool::Local().Release(std::move(column));
+    }
+  }
+
+  void AddBlock(ErlNifEnv *env, const Block &block) {
+    AddRows(env, block, selector_.Select(block));
+  }
+
+  // Build Elixir map: %{column_name => [values]}
+  ERL_NIF_TERM ToMap(ErlNifEnv *env) {
+    if (auto sample = selector_.TakeReservoir()) {
+      AddRows(env, *sample, nullptr);
+    }
+
+    size_t num_columns = columns_.size();
+    ScratchTerms values(num_columns);
+
+    for (size_t c = 0; c < num_columns; c++) {
+      values->push_back(enif_make_list_from_array(env, columns_[c].data(), columns_[c].size()));
+    }
+
+    ERL_NIF_TERM columns_map;
+    enif_make_map_from_arrays(env, key_atoms_.data(), values->data(), num_columns, &columns_map);
+    return columns_map;
+  }
 
-  client->Select(query, [&](const Block &block) {
+private:
+  void AddRows(ErlNifEnv *env, const Block &block, const RowSelection* rows) {
     size_t col_count = block.GetColumnCount();
     size_t row_count = block.GetRowCount();
 
@@ -827,621 +1137,254 @@ ColumnarResult client_select_cols(
     }
 
     // Initialize column structure on first block
-    if (first_block) {
-      col_names.reserve(col_count);
-      key_atoms.reserve(col_count);
-      all_columns.reserve(col_count);
+    if (columns_.empty()) {
+      key_atoms_.reserve(col_count);
+      columns_.reserve(col_count);
 
       for (size_t c = 0; c < col_count; c++) {
-        std::string col_name = block.GetColumnName(c);
-        col_names.push_back(col_name);
-        key_atoms.push_back(enif_make_atom(env, col_name.c_str()));
-
+        key_atoms_.push_back(enif_make_atom(env, block.GetColumnName(c).c_str()));
         // Estimate capacity: assume 10 blocks total (heuristic)
-        std::vector<ERL_NIF_TERM> col_vec;
-        col_vec.reserve(row_count * 10);
-        all_columns.push_back(std::move(col_vec));
+        columns_.push_back(TermBufferPool::Local().Acquire(row_count * 10));
       }
+    }
 
-      first_block = false;
+    if (rows && rows->empty()) {
+      return;
     }
 
-    // Extract each column's data using index-based access
+    // Decode each column straight onto its accumulated values
+    NATCH_PROBE2(decode__start, rows ? rows->size() : row_count, col_count);
     for (size_t c = 0; c < col_count; c++) {
-      ColumnRef col = block[c];
-      std::vector<ERL_NIF_TERM> column_values;
-      column_values.reserve(row_count);
-
-      // Extract column data based on type (reuse logic from block_to_maps_impl)
-      if (auto uint64_col = col->As<ColumnUInt64>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          column_values.push_back(enif_make_uint64(env, uint64_col->At(i)));
-        }
-      } else if (auto uint32_col = col->As<ColumnUInt32>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          column_values.push_back(enif_make_uint64(env, uint32_col->At(i)));
-        }
-      } else if (auto uint16_col = col->As<ColumnUInt16>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          column_values.push_back(enif_make_uint64(env, uint16_col->At(i)));
-        }
-      } else if (auto uint8_col = col->As<ColumnUInt8>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          column_values.push_back(enif_make_uint64(env, uint8_col->At(i)));
-        }
-      } else if (auto int64_col = col->As<ColumnInt64>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          column_values.push_back(enif_make_int64(env, int64_col->At(i)));
-        }
-      } else if (auto int32_col = col->As<ColumnInt32>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          column_values.push_back(enif_make_int64(env, int32_col->At(i)));
-        }
-      } else if (auto int16_col = col->As<ColumnInt16>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          column_values.push_back(enif_make_int64(env, int16_col->At(i)));
-        }
-      } else if (auto int8_col = col->As<ColumnInt8>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          column_values.push_back(enif_make_int64(env, int8_col->At(i)));
-        }
-      } else if (auto float64_col = col->As<ColumnFloat64>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          column_values.push_back(enif_make_double(env, float64_col->At(i)));
-        }
-      } else if (auto float32_col = col->As<ColumnFloat32>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          column_values.push_back(enif_make_double(env, float32_col->At(i)));
-        }
-      } else if (auto string_col = col->As<ColumnString>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          std::string_view val_view = string_col->At(i);
-          ErlNifBinary bin;
-          enif_alloc_binary(val_view.size(), &bin);
-          std::memcpy(bin.data, val_view.data(), val_view.size());
-          column_values.push_back(enif_make_binary(env, &bin));
-        }
-      } else if (auto datetime_col = col->As<ColumnDateTime>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          column_values.push_back(enif_make_uint64(env, datetime_col->At(i)));
-        }
-      } else if (auto datetime64_col = col->As<ColumnDateTime64>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          column_values.push_back(enif_make_int64(env, datetime64_col->At(i)));
-        }
-      } else if (auto date_col = col->As<ColumnDate>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          column_values.push_back(enif_make_uint64(env, date_col->RawAt(i)));
-        }
-      } else if (auto uuid_col = col->As<ColumnUUID>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          UUID uuid = uuid_col->At(i);
-          char uuid_buf[37];
-          format_uuid_to_buffer(uuid, uuid_buf);
-          ErlNifBinary bin;
-          enif_alloc_binary(36, &bin);
-          std::memcpy(bin.data, uuid_buf, 36);
-          column_values.push_back(enif_make_binary(env, &bin));
-        }
-      } else if (auto decimal_col = col->As<ColumnDecimal>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          Int128 value = decimal_col->At(i);
-          int64_t scaled_value = static_cast<int64_t>(value);
-          column_values.push_back(enif_make_int64(env, scaled_value));
-        }
-      } else if (auto array_col = col->As<ColumnArray>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          auto nested = array_col->GetAsColumn(i);
-          column_values.push_back(column_to_elixir_list(env, nested));
-        }
-      } else if (auto map_col = col->As<ColumnMap>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          auto kv_tuples = map_col->GetAsColumn(i);
-          if (auto tuple_col = kv_tuples->As<ColumnTuple>()) {
-            auto keys_col = tuple_col->At(0);
-            auto values_col = tuple_col->At(1);
-            size_t map_size = keys_col->Size();
-
-            // Optimized: Convert columns to vectors directly, then build map in O(M)
-            std::vector<ERL_NIF_TERM> key_terms;
-            std::vector<ERL_NIF_TERM> value_terms;
-            key_terms.reserve(map_size);
-            value_terms.reserve(map_size);
-
-            // Convert keys column to vector
-            ERL_NIF_TERM keys_list = column_to_elixir_list(env, keys_col);
-            ERL_NIF_TERM key_tail = keys_list;
-            for (size_t j = 0; j < map_size; j++) {
-              ERL_NIF_TERM key;
-              if (enif_get_list_cell(env, key_tail, &key, &key_tail)) {
-                key_terms.push_back(key);
-              }
-            }
-
-            // Convert values column to vector
-            ERL_NIF_TERM values_list = column_to_elixir_list(env, values_col);
-            ERL_NIF_TERM value_tail = values_list;
-            for (size_t j = 0; j < map_size; j++) {
-              ERL_NIF_TERM value;
-              if (enif_get_list_cell(env, value_tail, &value, &value_tail)) {
-                value_terms.push_back(value);
-              }
-            }
-
-            // Build map in O(M) with enif_make_map_from_arrays
-            ERL_NIF_TERM elixir_map;
-            enif_make_map_from_arrays(env, key_terms.data(), value_terms.data(), map_size, &elixir_map);
-
-            column_values.push_back(elixir_map);
-          } else {
-            column_values.push_back(enif_make_new_map(env));
-          }
-        }
-      } else if (auto tuple_col = col->As<ColumnTuple>()) {
-        size_t tuple_size = tuple_col->TupleSize();
-
-        // Optimized: Pre-convert each element column ONCE, then index directly
-        std::vector<std::vector<ERL_NIF_TERM>> element_columns;
-        element_columns.reserve(tuple_size);
-
-        for (size_t j = 0; j < tuple_size; j++) {
-          auto element_col = tuple_col->At(j);
-          // Convert entire element column to Elixir list, then extract to vector
-          ERL_NIF_TERM elem_list = column_to_elixir_list(env, element_col);
-          std::vector<ERL_NIF_TERM> elem_vec;
-          elem_vec.reserve(row_count);
-          ERL_NIF_TERM tail = elem_list;
-          for (size_t i = 0; i < row_count; i++) {
-            ERL_NIF_TERM head;
-            if (enif_get_list_cell(env, tail, &head, &tail)) {
-              elem_vec.push_back(head);
-            } else {
-              elem_vec.push_back(enif_make_atom(env, "error"));
-            }
-          }
-          element_columns.push_back(std::move(elem_vec));
-        }
+      append_column_terms(env, block[c], columns_[c], opts_, rows);
+    }
+    NATCH_PROBE1(decode__done, rows ? rows->size() : row_count);
+  }
 
-        // Now build tuples by indexing pre-converted columns
-        for (size_t i = 0; i < row_count; i++) {
-          std::vector<ERL_NIF_TERM> tuple_elements;
-          tuple_elements.reserve(tuple_size);
-          for (size_t j = 0; j < tuple_size; j++) {
-            tuple_elements.push_back(element_columns[j][i]);
-          }
-          column_values.push_back(enif_make_tuple_from_array(env, tuple_elements.data(), tuple_elements.size()));
-        }
-      } else if (auto enum8_col = col->As<ColumnEnum8>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          std::string_view name = enum8_col->NameAt(i);
-          ErlNifBinary bin;
-          enif_alloc_binary(name.size(), &bin);
-          std::memcpy(bin.data, name.data(), name.size());
-          column_values.push_back(enif_make_binary(env, &bin));
-        }
-      } else if (auto enum16_col = col->As<ColumnEnum16>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          std::string_view name = enum16_col->NameAt(i);
-          ErlNifBinary bin;
-          enif_alloc_binary(name.size(), &bin);
-          std::memcpy(bin.data, name.data(), name.size());
-          column_values.push_back(enif_make_binary(env, &bin));
-        }
-      } else if (auto lc_col = col->As<ColumnLowCardinality>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          auto item = lc_col->GetItem(i);
-          if (item.type == Type::String) {
-            auto val = item.get<std::string_view>();
-            ErlNifBinary bin;
-            enif_alloc_binary(val.size(), &bin);
-            std::memcpy(bin.data, val.data(), val.size());
-            column_values.push_back(enif_make_binary(env, &bin));
-          } else if (item.type == Type::Void) {
-            column_values.push_back(enif_make_atom(env, "nil"));
-          } else {
-            throw std::runtime_error("Unsupported LowCardinality inner type");
-          }
-        }
-      } else if (auto nullable_col = col->As<ColumnNullable>()) {
-        auto nested = nullable_col->Nested();
-
-        // Optimized: Check nested type ONCE outside loop, then direct extraction
-        if (auto uint64_col = nested->As<ColumnUInt64>()) {
-          for (size_t i = 0; i < row_count; i++) {
-            if (nullable_col->IsNull(i)) {
-              column_values.push_back(enif_make_atom(env, "nil"));
-            } else {
-              column_values.push_back(enif_make_uint64(env, uint64_col->At(i)));
-            }
-          }
-        } else if (auto int64_col = nested->As<ColumnInt64>()) {
-          for (size_t i = 0; i < row_count; i++) {
-            if (nullable_col->IsNull(i)) {
-              column_values.push_back(enif_make_atom(env, "nil"));
-            } else {
-              column_values.push_back(enif_make_int64(env, int64_col->At(i)));
-            }
-          }
-        } else if (auto float64_col = nested->As<ColumnFloat64>()) {
-          for (size_t i = 0; i < row_count; i++) {
-            if (nullable_col->IsNull(i)) {
-              column_values.push_back(enif_make_atom(env, "nil"));
-            } else {
-              column_values.push_back(enif_make_double(env, float64_col->At(i)));
-            }
-          }
-        } else if (auto string_col = nested->As<ColumnString>()) {
-          for (size_t i = 0; i < row_count; i++) {
-            if (nullable_col->IsNull(i)) {
-              column_values.push_back(enif_make_atom(env, "nil"));
-            } else {
-              std::string_view val_view = string_col->At(i);
-              ErlNifBinary bin;
-              enif_alloc_binary(val_view.size(), &bin);
-              std::memcpy(bin.data, val_view.data(), val_view.size());
-              column_values.push_back(enif_make_binary(env, &bin));
-            }
-          }
-        } else {
-          // Fallback for complex/uncommon types: use Slice approach
-          for (size_t i = 0; i < row_count; i++) {
-            if (nullable_col->IsNull(i)) {
-              column_values.push_back(enif_make_atom(env, "nil"));
-            } else {
-              auto single_value_col = nested->Slice(i, 1);
-              ERL_NIF_TERM elem_list = column_to_elixir_list(env, single_value_col);
-              ERL_NIF_TERM head, tail;
-              if (enif_get_list_cell(env, elem_list, &head, &tail)) {
-                column_values.push_back(head);
-              } else {
-                column_values.push_back(enif_make_atom(env, "error"));
-              }
-            }
-          }
-        }
-      }
+  SelectOptions opts_;
+  RowSelector selector_;
+  std::vector<ERL_NIF_TERM> key_atoms_;
+  std::vector<std::vector<ERL_NIF_TERM>> columns_;
+};
 
-      // Append this block's column values to accumulated data (indexed access - O(1))
-      all_columns[c].insert(
-        all_columns[c].end(),
-        column_values.begin(),
-        column_values.end()
-      );
-    }
-  });
+// Execute SELECT query and return columnar format: %{column_name => [values]}
+ColumnarResult client_select_cols(
+    ErlNifEnv *env,
+    fine::ResourcePtr<Client> client,
+    std::string query,
+    fine::Term options) {
 
-  // Build Elixir map: %{column_name => [values]}
-  // Atoms already created during first block processing
-  size_t num_columns = all_columns.size();
-  std::vector<ERL_NIF_TERM> values;
-  values.reserve(num_columns);
+  SelectOptions opts = decode_select_options(env, options);
+  QueryStatsCollector query_stats(opts);
 
-  for (size_t c = 0; c < num_columns; c++) {
-    values.push_back(enif_make_list_from_array(env, all_columns[c].data(), all_columns[c].size()));
-  }
+  ColumnarAccumulator accumulator(opts);
 
-  ERL_NIF_TERM columns_map;
-  enif_make_map_from_arrays(env, key_atoms.data(), values.data(), num_columns, &columns_map);
+  run_select(env, *client, query, opts, [&](const Block &block) {
+    accumulator.AddBlock(env, block);
+  });
 
-  return ColumnarResult(columns_map);
+  return ColumnarResult(query_stats.Attach(env, accumulator.ToMap(env)));
 }
 
-FINE_NIF(client_select_cols, 0);
+FINE_NIF(client_select_cols, ERL_NIF_DIRTY_JOB_IO_BOUND);
 
 // Execute parameterized SELECT query and return columnar format
 ColumnarResult client_select_cols_parameterized(
     ErlNifEnv *env,
     fine::ResourcePtr<Client> client,
-    fine::ResourcePtr<Query> query) {
+    fine::ResourcePtr<Query> query,
+    fine::Term options) {
 
-  // Pre-create column structure on first block (indexed vectors for O(1) access)
-  std::vector<std::string> col_names;
-  std::vector<ERL_NIF_TERM> key_atoms;
-  std::vector<std::vector<ERL_NIF_TERM>> all_columns;
-  bool first_block = true;
+  SelectOptions opts = decode_select_options(env, options);
+  QueryStatsCollector query_stats(opts);
 
-  // Set callback on the Query object before calling Select
-  query->OnData([&](const Block &block) {
-    size_t col_count = block.GetColumnCount();
-    size_t row_count = block.GetRowCount();
+  ColumnarAccumulator accumulator(opts);
 
-    if (row_count == 0) {
+  run_select(env, *client, *query, opts, [&](const Block &block) {
+    accumulator.AddBlock(env, block);
+  });
+
+  return ColumnarResult(query_stats.Attach(env, accumulator.ToMap(env)));
+}
+
+FINE_NIF(client_select_cols_parameterized, ERL_NIF_DIRTY_JOB_IO_BOUND);
+
+// Collects each result block serialized in Native format (see
+// native_format.h), for callers that store or forward blocks without
+// decoding them. One scratch buffer is reused across blocks.
+class NativeBlockCollector {
+public:
+  void AddBlock(ErlNifEnv *env, const Block& block) {
+    // Keep the empty header block that precedes the data aside: it is only
+    // sent when no data block follows
+    if (block.GetRowCount() == 0) {
+      if (!header_ && block.GetColumnCount() > 0) {
+        header_ = block;
+      }
       return;
     }
+    Append(env, block);
+  }
 
-    // Initialize column structure on first block
-    if (first_block) {
-      col_names.reserve(col_count);
-      key_atoms.reserve(col_count);
-      all_columns.reserve(col_count);
+  // An empty result is its header: 0 rows, but the column names and types
+  ERL_NIF_TERM ToList(ErlNifEnv *env) {
+    if (blocks_.empty() && header_) {
+      Append(env, *header_);
+    }
+    return enif_make_list_from_array(env, blocks_.data(), blocks_.size());
+  }
 
-      for (size_t c = 0; c < col_count; c++) {
-        std::string col_name = block.GetColumnName(c);
-        col_names.push_back(col_name);
-        key_atoms.push_back(enif_make_atom(env, col_name.c_str()));
+private:
+  void Append(ErlNifEnv *env, const Block& block) {
+    write_native_block(block, &buffer_);
 
-        // Estimate capacity: assume 10 blocks total (heuristic)
-        std::vector<ERL_NIF_TERM> col_vec;
-        col_vec.reserve(row_count * 10);
-        all_columns.push_back(std::move(col_vec));
-      }
+    ERL_NIF_TERM term;
+    unsigned char* data = enif_make_new_binary(env, buffer_.size(), &term);
+    std::memcpy(data, buffer_.data(), buffer_.size());
+    blocks_.push_back(term);
+  }
 
-      first_block = false;
-    }
+  Buffer buffer_;
+  std::vector<ERL_NIF_TERM> blocks_;
+  std::optional<Block> header_;
+};
 
-    // Extract each column's data using index-based access
-    for (size_t c = 0; c < col_count; c++) {
-      ColumnRef col = block[c];
-      std::vector<ERL_NIF_TERM> column_values;
-      column_values.reserve(row_count);
-
-      // Extract column data based on type (reuse logic from client_select_cols)
-      if (auto uint64_col = col->As<ColumnUInt64>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          column_values.push_back(enif_make_uint64(env, uint64_col->At(i)));
-        }
-      } else if (auto uint32_col = col->As<ColumnUInt32>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          column_values.push_back(enif_make_uint64(env, uint32_col->At(i)));
-        }
-      } else if (auto uint16_col = col->As<ColumnUInt16>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          column_values.push_back(enif_make_uint64(env, uint16_col->At(i)));
-        }
-      } else if (auto uint8_col = col->As<ColumnUInt8>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          column_values.push_back(enif_make_uint64(env, uint8_col->At(i)));
-        }
-      } else if (auto int64_col = col->As<ColumnInt64>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          column_values.push_back(enif_make_int64(env, int64_col->At(i)));
-        }
-      } else if (auto int32_col = col->As<ColumnInt32>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          column_values.push_back(enif_make_int64(env, int32_col->At(i)));
-        }
-      } else if (auto int16_col = col->As<ColumnInt16>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          column_values.push_back(enif_make_int64(env, int16_col->At(i)));
-        }
-      } else if (auto int8_col = col->As<ColumnInt8>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          column_values.push_back(enif_make_int64(env, int8_col->At(i)));
-        }
-      } else if (auto float64_col = col->As<ColumnFloat64>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          column_values.push_back(enif_make_double(env, float64_col->At(i)));
-        }
-      } else if (auto float32_col = col->As<ColumnFloat32>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          column_values.push_back(enif_make_double(env, float32_col->At(i)));
-        }
-      } else if (auto string_col = col->As<ColumnString>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          std::string_view val_view = string_col->At(i);
-          ErlNifBinary bin;
-          enif_alloc_binary(val_view.size(), &bin);
-          std::memcpy(bin.data, val_view.data(), val_view.size());
-          column_values.push_back(enif_make_binary(env, &bin));
-        }
-      } else if (auto datetime_col = col->As<ColumnDateTime>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          column_values.push_back(enif_make_uint64(env, datetime_col->At(i)));
-        }
-      } else if (auto datetime64_col = col->As<ColumnDateTime64>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          column_values.push_back(enif_make_int64(env, datetime64_col->At(i)));
-        }
-      } else if (auto date_col = col->As<ColumnDate>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          column_values.push_back(enif_make_uint64(env, date_col->RawAt(i)));
-        }
-      } else if (auto uuid_col = col->As<ColumnUUID>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          UUID uuid = uuid_col->At(i);
-          char uuid_buf[37];
-          format_uuid_to_buffer(uuid, uuid_buf);
-          ErlNifBinary bin;
-          enif_alloc_binary(36, &bin);
-          std::memcpy(bin.data, uuid_buf, 36);
-          column_values.push_back(enif_make_binary(env, &bin));
-        }
-      } else if (auto decimal_col = col->As<ColumnDecimal>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          Int128 value = decimal_col->At(i);
-          int64_t scaled_value = static_cast<int64_t>(value);
-          column_values.push_back(enif_make_int64(env, scaled_value));
-        }
-      } else if (auto array_col = col->As<ColumnArray>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          auto nested = array_col->GetAsColumn(i);
-          column_values.push_back(column_to_elixir_list(env, nested));
-        }
-      } else if (auto map_col = col->As<ColumnMap>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          auto kv_tuples = map_col->GetAsColumn(i);
-          if (auto tuple_col = kv_tuples->As<ColumnTuple>()) {
-            auto keys_col = tuple_col->At(0);
-            auto values_col = tuple_col->At(1);
-            size_t map_size = keys_col->Size();
-
-            std::vector<ERL_NIF_TERM> key_terms;
-            std::vector<ERL_NIF_TERM> value_terms;
-            key_terms.reserve(map_size);
-            value_terms.reserve(map_size);
-
-            ERL_NIF_TERM keys_list = column_to_elixir_list(env, keys_col);
-            ERL_NIF_TERM key_tail = keys_list;
-            for (size_t j = 0; j < map_size; j++) {
-              ERL_NIF_TERM key;
-              if (enif_get_list_cell(env, key_tail, &key, &key_tail)) {
-                key_terms.push_back(key);
-              }
-            }
-
-            ERL_NIF_TERM values_list = column_to_elixir_list(env, values_col);
-            ERL_NIF_TERM value_tail = values_list;
-            for (size_t j = 0; j < map_size; j++) {
-              ERL_NIF_TERM value;
-              if (enif_get_list_cell(env, value_tail, &value, &value_tail)) {
-                value_terms.push_back(value);
-              }
-            }
-
-            ERL_NIF_TERM elixir_map;
-            enif_make_map_from_arrays(env, key_terms.data(), value_terms.data(), map_size, &elixir_map);
-
-            column_values.push_back(elixir_map);
-          } else {
-            column_values.push_back(enif_make_new_map(env));
-          }
-        }
-      } else if (auto tuple_col = col->As<ColumnTuple>()) {
-        size_t tuple_size = tuple_col->TupleSize();
-
-        std::vector<std::vector<ERL_NIF_TERM>> element_columns;
-        element_columns.reserve(tuple_size);
-
-        for (size_t j = 0; j < tuple_size; j++) {
-          auto element_col = tuple_col->At(j);
-          ERL_NIF_TERM elem_list = column_to_elixir_list(env, element_col);
-          std::vector<ERL_NIF_TERM> elem_vec;
-          elem_vec.reserve(row_count);
-          ERL_NIF_TERM tail = elem_list;
-          for (size_t i = 0; i < row_count; i++) {
-            ERL_NIF_TERM head;
-            if (enif_get_list_cell(env, tail, &head, &tail)) {
-              elem_vec.push_back(head);
-            } else {
-              elem_vec.push_back(enif_make_atom(env, "error"));
-            }
-          }
-          element_columns.push_back(std::move(elem_vec));
-        }
+// Execute SELECT query and return its blocks as Native-format binaries
+fine::Term client_select_native(
+    ErlNifEnv *env,
+    fine::ResourcePtr<Client> client,
+    std::string query,
+    fine::Term options) {
 
-        for (size_t i = 0; i < row_count; i++) {
-          std::vector<ERL_NIF_TERM> tuple_elements;
-          tuple_elements.reserve(tuple_size);
-          for (size_t j = 0; j < tuple_size; j++) {
-            tuple_elements.push_back(element_columns[j][i]);
-          }
-          column_values.push_back(enif_make_tuple_from_array(env, tuple_elements.data(), tuple_elements.size()));
-        }
-      } else if (auto enum8_col = col->As<ColumnEnum8>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          std::string_view name = enum8_col->NameAt(i);
-          ErlNifBinary bin;
-          enif_alloc_binary(name.size(), &bin);
-          std::memcpy(bin.data, name.data(), name.size());
-          column_values.push_back(enif_make_binary(env, &bin));
-        }
-      } else if (auto enum16_col = col->As<ColumnEnum16>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          std::string_view name = enum16_col->NameAt(i);
-          ErlNifBinary bin;
-          enif_alloc_binary(name.size(), &bin);
-          std::memcpy(bin.data, name.data(), name.size());
-          column_values.push_back(enif_make_binary(env, &bin));
-        }
-      } else if (auto lc_col = col->As<ColumnLowCardinality>()) {
-        for (size_t i = 0; i < row_count; i++) {
-          auto item = lc_col->GetItem(i);
-          if (item.type == Type::String) {
-            auto val = item.get<std::string_view>();
-            ErlNifBinary bin;
-            enif_alloc_binary(val.size(), &bin);
-            std::memcpy(bin.data, val.data(), val.size());
-            column_values.push_back(enif_make_binary(env, &bin));
-          } else if (item.type == Type::Void) {
-            column_values.push_back(enif_make_atom(env, "nil"));
-          } else {
-            throw std::runtime_error("Unsupported LowCardinality inner type");
-          }
-        }
-      } else if (auto nullable_col = col->As<ColumnNullable>()) {
-        auto nested = nullable_col->Nested();
-
-        if (auto uint64_col = nested->As<ColumnUInt64>()) {
-          for (size_t i = 0; i < row_count; i++) {
-            if (nullable_col->IsNull(i)) {
-              column_values.push_back(enif_make_atom(env, "nil"));
-            } else {
-              column_values.push_back(enif_make_uint64(env, uint64_col->At(i)));
-            }
-          }
-        } else if (auto int64_col = nested->As<ColumnInt64>()) {
-          for (size_t i = 0; i < row_count; i++) {
-            if (nullable_col->IsNull(i)) {
-              column_values.push_back(enif_make_atom(env, "nil"));
-            } else {
-              column_values.push_back(enif_make_int64(env, int64_col->At(i)));
-            }
-          }
-        } else if (auto float64_col = nested->As<ColumnFloat64>()) {
-          for (size_t i = 0; i < row_count; i++) {
-            if (nullable_col->IsNull(i)) {
-              column_values.push_back(enif_make_atom(env, "nil"));
-            } else {
-              column_values.push_back(enif_make_double(env, float64_col->At(i)));
-            }
-          }
-        } else if (auto string_col = nested->As<ColumnString>()) {
-          for (size_t i = 0; i < row_count; i++) {
-            if (nullable_col->IsNull(i)) {
-              column_values.push_back(enif_make_atom(env, "nil"));
-            } else {
-              std::string_view val_view = string_col->At(i);
-              ErlNifBinary bin;
-              enif_alloc_binary(val_view.size(), &bin);
-              std::memcpy(bin.data, val_view.data(), val_view.size());
-              column_values.push_back(enif_make_binary(env, &bin));
-            }
-          }
-        } else {
-          // Fallback for complex/uncommon types
-          for (size_t i = 0; i < row_count; i++) {
-            if (nullable_col->IsNull(i)) {
-              column_values.push_back(enif_make_atom(env, "nil"));
-            } else {
-              auto single_value_col = nested->Slice(i, 1);
-              ERL_NIF_TERM elem_list = column_to_elixir_list(env, single_value_col);
-              ERL_NIF_TERM head, tail;
-              if (enif_get_list_cell(env, elem_list, &head, &tail)) {
-                column_values.push_back(head);
-              } else {
-                column_values.push_back(enif_make_atom(env, "error"));
-              }
-            }
-          }
-        }
-      }
+  SelectOptions opts = decode_select_options(env, options);
+  NativeBlockCollector collector;
 
-      // Append this block's column values to accumulated data
-      all_columns[c].insert(
-        all_columns[c].end(),
-        column_values.begin(),
-        column_values.end()
-      );
-    }
+  run_select(env, *client, query, opts, [&](const Block &block) {
+    collector.AddBlock(env, block);
   });
-  // Execute the query with the configured callback
-  client->Select(*query);
 
+  return collector.ToList(env);
+}
 
-  // Build Elixir map: %{column_name => [values]}
-  size_t num_columns = all_columns.size();
-  std::vector<ERL_NIF_TERM> values;
-  values.reserve(num_columns);
+FINE_NIF(client_select_native, ERL_NIF_DIRTY_JOB_IO_BOUND);
+
+// Execute parameterized SELECT query and return Native-format binaries
+fine::Term client_select_native_parameterized(
+    ErlNifEnv *env,
+    fine::ResourcePtr<Client> client,
+    fine::ResourcePtr<Query> query,
+    fine::Term options) {
+
+  SelectOptions opts = decode_select_options(env, options);
+  NativeBlockCollector collector;
+
+  run_select(env, *client, *query, opts, [&](const Block &block) {
+    collector.AddBlock(env, block);
+  });
+
+  return collector.ToList(env);
+}
+
+FINE_NIF(client_select_native_parameterized, ERL_NIF_DIRTY_JOB_IO_BOUND);
+
+// Decode Native-format bytes (one or more blocks, as from `FORMAT Native` or
+// write_native_block) into terms without a connection: a list of row maps,
+// or %{column_name => [values]} when `as_columns` is true
+fine::Term native_decode(ErlNifEnv *env, ErlNifBinary data, bool as_columns) {
+  ArrayInput input(data.data, data.size);
+  std::vector<std::string> names;
+  std::vector<ERL_NIF_TERM> key_atoms;
+  std::vector<std::vector<ERL_NIF_TERM>> columns;
+  ScratchTerms col_data(0);
+  ScratchTerms all_maps(0);
 
-  for (size_t c = 0; c < num_columns; c++) {
-    values.push_back(enif_make_list_from_array(env, all_columns[c].data(), all_columns[c].size()));
+  while (!input.Exhausted()) {
+    col_data->clear();
+    size_t rows = append_native_block_terms(env, input, names, *col_data);
+
+    if (key_atoms.empty()) {
+      for (const std::string& name : names) {
+        key_atoms.push_back(enif_make_atom(env, name.c_str()));
+      }
+      columns.resize(names.size());
+    } else if (names.size() != key_atoms.size()) {
+      throw ProtocolError("Native blocks with different columns");
+    }
+
+    if (as_columns) {
+      for (size_t c = 0; c < names.size(); c++) {
+        auto begin = col_data->begin() + c * rows;
+        reserve_terms(columns[c], rows);
+        columns[c].insert(columns[c].end(), begin, begin + rows);
+      }
+    } else if (rows > 0) {
+      append_row_maps(env, key_atoms, *col_data, rows, *all_maps);
+    }
   }
 
-  ERL_NIF_TERM columns_map;
-  enif_make_map_from_arrays(env, key_atoms.data(), values.data(), num_columns, &columns_map);
+  if (!as_columns) {
+    return enif_make_list_from_array(env, all_maps->data(), all_maps->size());
+  }
 
-  return ColumnarResult(columns_map);
+  std::vector<ERL_NIF_TERM> lists;
+  lists.reserve(columns.size());
+  for (const auto& column : columns) {
+    lists.push_back(enif_make_list_from_array(env, column.data(), column.size()));
+  }
+  ERL_NIF_TERM result;
+  if (!enif_make_map_from_arrays(env, key_atoms.data(), lists.data(), lists.size(), &result)) {
+    throw std::invalid_argument("duplicate column names in Native block");
+  }
+  return result;
 }
 
-FINE_NIF(client_select_cols_parameterized, 0);
+FINE_NIF(native_decode, ERL_NIF_DIRTY_JOB_CPU_BOUND);
+
+// Report scratch buffer pool activity across all threads
+// allocations counts buffers that had to be malloc'd; reuses counts pool hits
+fine::Term select_buffer_stats(ErlNifEnv *env) {
+  ERL_NIF_TERM keys[] = {
+    enif_make_atom(env, "allocations"),
+    enif_make_atom(env, "reuses"),
+    enif_make_atom(env, "retained_bytes")
+  };
+  ERL_NIF_TERM values[] = {
+    enif_make_uint64(env, TermBufferPool::allocations.load()),
+    enif_make_uint64(env, TermBufferPool::reuses.load()),
+    enif_make_int64(env, TermBufferPool::retained_bytes.load())
+  };
+
+  ERL_NIF_TERM stats;
+  enif_make_map_from_arrays(env, keys, values, 3, &stats);
+  return stats;
+}
+
+FINE_NIF(select_buffer_stats, 0);
+
+// Report cumulative decode cost per ClickHouse type across all queries
+fine::Term select_decode_stats(ErlNifEnv *env) {
+  return decode_stats_to_map(env, DecodeStats::Global().Snapshot());
+}
+
+FINE_NIF(select_decode_stats, 0);
+
+fine::Atom select_decode_stats_reset(ErlNifEnv *env) {
+  DecodeStats::Global().Reset();
+  return fine::Atom("ok");
+}
+
+FINE_NIF(select_decode_stats_reset, 0);
+
+// Create a cancel token; first-block notifications carry `ref`
+fine::ResourcePtr<CancelToken> cancel_token_create(ErlNifEnv *env, fine::Term ref) {
+  return fine::make_resource<CancelToken>(env, ref);
+}
+
+FINE_NIF(cancel_token_create, 0);
+
+// Cancel the query using this token at its next block
+fine::Atom cancel_token_cancel(ErlNifEnv *env, fine::ResourcePtr<CancelToken> token) {
+  token->cancelled.store(true);
+  return fine::Atom("ok");
+}
 
+FINE_NIF(cancel_token_cancel, 0);
@@ -0,0 +1,246 @@
+#include <fine.hpp>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include "cpu_dispatch.h"
+#include "simd_kernels.h"
+
+#if NATCH_X86_DISPATCH
+#include <immintrin.h>
+#define NATCH_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define NATCH_INLINE inline __attribute__((always_inline))
+#else
+#define NATCH_INLINE inline
+#endif
+
+// Pick the level when the library loads rather than on the first query
+static CpuDispatch& dispatch_at_load = CpuDispatch::Global();
+
+namespace {
+
+// ============================================================================
+// Kernel bodies
+// ============================================================================
+//
+// Plain loops the compiler vectorizes. Each is inlined into one wrapper per
+// target below, so the same source is compiled for every instruction set.
+
+template <typename T>
+NATCH_INLINE void compare_mask_body(const T* values, size_t n, CompareOp op, T value,
+                                    uint8_t* mask) {
+  switch (op) {
+  case CompareOp::Eq:
+    for (size_t i = 0; i < n; i++) mask[i] &= values[i] == value;
+    break;
+  case CompareOp::Ne:
+    for (size_t i = 0; i < n; i++) mask[i] &= values[i] != value;
+    break;
+  case CompareOp::Lt:
+    for (size_t i = 0; i < n; i++) mask[i] &= values[i] < value;
+    break;
+  case CompareOp::Le:
+    for (size_t i = 0; i < n; i++) mask[i] &= values[i] <= value;
+    break;
+  case CompareOp::Gt:
+    for (size_t i = 0; i < n; i++) mask[i] &= values[i] > value;
+    break;
+  case CompareOp::Ge:
+    for (size_t i = 0; i < n; i++) mask[i] &= values[i] >= value;
+    break;
+  }
+}
+
+NATCH_INLINE void and_mask_body(uint8_t* mask, const uint8_t* bytes, size_t n, uint8_t flip) {
+  for (size_t i = 0; i < n; i++) mask[i] &= bytes[i] ^ flip;
+}
+
+// Branch-free: every index is written, the count only advances on a hit
+NATCH_INLINE size_t mask_to_rows_tail(const uint8_t* mask, size_t begin, size_t n,
+                                      uint32_t* rows, size_t count) {
+  for (size_t i = begin; i < n; i++) {
+    rows[count] = static_cast<uint32_t>(i);
+    count += mask[i] != 0;
+  }
+  return count;
+}
+
+// Append begin + the position of each set bit of `bits`
+NATCH_INLINE size_t append_set_bits(uint64_t bits, size_t begin, uint32_t* rows, size_t count) {
+  while (bits) {
+    rows[count++] = static_cast<uint32_t>(begin + __builtin_ctzll(bits));
+    bits &= bits - 1;
+  }
+  return count;
+}
+
+// ============================================================================
+// Per-target variants
+// ============================================================================
+
+template <typename T>
+void compare_mask_scalar(const T* values, size_t n, CompareOp op, T value, uint8_t* mask) {
+  compare_mask_body(values, n, op, value, mask);
+}
+
+#if NATCH_X86_DISPATCH
+
+template <typename T>
+NATCH_TARGET("sse4.2")
+void compare_mask_sse42(const T* values, size_t n, CompareOp op, T value, uint8_t* mask) {
+  compare_mask_body(values, n, op, value, mask);
+}
+
+template <typename T>
+NATCH_TARGET("avx2")
+void compare_mask_avx2(const T* values, size_t n, CompareOp op, T value, uint8_t* mask) {
+  compare_mask_body(values, n, op, value, mask);
+}
+
+template <typename T>
+NATCH_TARGET("avx512f,avx512bw,avx512vl")
+void compare_mask_avx512(const T* values, size_t n, CompareOp op, T value, uint8_t* mask) {
+  compare_mask_body(values, n, op, value, mask);
+}
+
+NATCH_TARGET("sse4.2")
+void and_mask_sse42(uint8_t* mask, const uint8_t* bytes, size_t n, uint8_t flip) {
+  and_mask_body(mask, bytes, n, flip);
+}
+
+NATCH_TARGET("avx2")
+void and_mask_avx2(uint8_t* mask, const uint8_t* bytes, size_t n, uint8_t flip) {
+  and_mask_body(mask, bytes, n, flip);
+}
+
+NATCH_TARGET("avx512f,avx512bw,avx512vl")
+void and_mask_avx512(uint8_t* mask, const uint8_t* bytes, size_t n, uint8_t flip) {
+  and_mask_body(mask, bytes, n, flip);
+}
+
+// The compaction does not vectorize on its own: test a register of mask
+// bytes at once and only visit the set ones, so sparse masks cost one
+// compare per 16, 32 or 64 rows
+
+NATCH_TARGET("sse4.2")
+size_t mask_to_rows_sse42(const uint8_t* mask, size_t n, uint32_t* rows) {
+  const __m128i zero = _mm_setzero_si128();
+  size_t count = 0;
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask + i));
+    uint32_t zeros = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, zero)));
+    count = append_set_bits(~zeros & 0xFFFFu, i, rows, count);
+  }
+  return mask_to_rows_tail(mask, i, n, rows, count);
+}
+
+NATCH_TARGET("avx2")
+size_t mask_to_rows_avx2(const uint8_t* mask, size_t n, uint32_t* rows) {
+  const __m256i zero = _mm256_setzero_si256();
+  size_t count = 0;
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(mask + i));
+    uint32_t zeros = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, zero)));
+    count = append_set_bits(~zeros, i, rows, count);
+  }
+  return mask_to_rows_tail(mask, i, n, rows, count);
+}
+
+NATCH_TARGET("avx512f,avx512bw,avx512vl")
+size_t mask_to_rows_avx512(const uint8_t* mask, size_t n, uint32_t* rows) {
+  size_t count = 0;
+  size_t i = 0;
+  for (; i + 64 <= n; i += 64) {
+    __m512i bytes = _mm512_loadu_si512(mask + i);
+    count = append_set_bits(_mm512_test_epi8_mask(bytes, bytes), i, rows, count);
+  }
+  return mask_to_rows_tail(mask, i, n, rows, count);
+}
+
+#endif  // NATCH_X86_DISPATCH
+
+}  // namespace
+
+// ============================================================================
+// Dispatch
+// ============================================================================
+
+template <typename T>
+void compare_mask(const T* values, size_t n, CompareOp op, T value, uint8_t* mask) {
+  switch (CpuDispatch::Global().Level()) {
+#if NATCH_X86_DISPATCH
+  case CpuLevel::AVX512: return compare_mask_avx512(values, n, op, value, mask);
+  case CpuLevel::AVX2: return compare_mask_avx2(values, n, op, value, mask);
+  case CpuLevel::SSE42: return compare_mask_sse42(values, n, op, value, mask);
+#endif
+  default: return compare_mask_scalar(values, n, op, value, mask);
+  }
+}
+
+template void compare_mask<uint8_t>(const uint8_t*, size_t, CompareOp, uint8_t, uint8_t*);
+template void compare_mask<uint16_t>(const uint16_t*, size_t, CompareOp, uint16_t, uint8_t*);
+template void compare_mask<uint32_t>(const uint32_t*, size_t, CompareOp, uint32_t, uint8_t*);
+template void compare_mask<uint64_t>(const uint64_t*, size_t, CompareOp, uint64_t, uint8_t*);
+template void compare_mask<int8_t>(const int8_t*, size_t, CompareOp, int8_t, uint8_t*);
+template void compare_mask<int16_t>(const int16_t*, size_t, CompareOp, int16_t, uint8_t*);
+template void compare_mask<int32_t>(const int32_t*, size_t, CompareOp, int32_t, uint8_t*);
+template void compare_mask<int64_t>(const int64_t*, size_t, CompareOp, int64_t, uint8_t*);
+template void compare_mask<double>(const double*, size_t, CompareOp, double, uint8_t*);
+
+void and_mask(uint8_t* mask, const uint8_t* bytes, size_t n, uint8_t flip) {
+  switch (CpuDispatch::Global().Level()) {
+#if NATCH_X86_DISPATCH
+  case CpuLevel::AVX512: return and_mask_avx512(mask, bytes, n, flip);
+  case CpuLevel::AVX2: return and_mask_avx2(mask, bytes, n, flip);
+  case CpuLevel::SSE42: return and_mask_sse42(mask, bytes, n, flip);
+#endif
+  default: return and_mask_body(mask, bytes, n, flip);
+  }
+}
+
+size_t mask_to_rows(const uint8_t* mask, size_t n, uint32_t* rows) {
+  switch (CpuDispatch::Global().Level()) {
+#if NATCH_X86_DISPATCH
+  case CpuLevel::AVX512: return mask_to_rows_avx512(mask, n, rows);
+  case CpuLevel::AVX2: return mask_to_rows_avx2(mask, n, rows);
+  case CpuLevel::SSE42: return mask_to_rows_sse42(mask, n, rows);
+#endif
+  default: return mask_to_rows_tail(mask, 0, n, rows, 0);
+  }
+}
+
+// ============================================================================
+// NIFs
+// ============================================================================
+
+// %{level: active, detected: highest the CPU supports}, as level names
+fine::Term cpu_level(ErlNifEnv *env) {
+  CpuDispatch& dispatch = CpuDispatch::Global();
+  ERL_NIF_TERM keys[] = {enif_make_atom(env, "level"), enif_make_atom(env, "detected")};
+  ERL_NIF_TERM values[] = {enif_make_atom(env, cpu_level_name(dispatch.Level())),
+                           enif_make_atom(env, cpu_level_name(dispatch.Detected()))};
+  ERL_NIF_TERM result;
+  enif_make_map_from_arrays(env, keys, values, 2, &result);
+  return result;
+}
+
+FINE_NIF(cpu_level, 0);
+
+// Use the kernels for `level` from the next call on, process-wide
+fine::Atom cpu_level_set(ErlNifEnv *env, std::string level) {
+  CpuLevel requested;
+  if (!parse_cpu_level(level, requested)) {
+    throw std::invalid_argument("unknown CPU level: " + level);
+  }
+  if (!dispatch_at_load.Set(requested)) {
+    throw std::invalid_argument("CPU level " + level + " is not supported by this CPU (highest: " +
+                                cpu_level_name(dispatch_at_load.Detected()) + ")");
+  }
+  return fine::Atom("ok");
+}
+
+FINE_NIF(cpu_level_set, 0);
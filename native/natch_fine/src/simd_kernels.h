@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Row filter loops, compiled per ISA and dispatched on CpuDispatch
+// (cpu_dispatch.h). Results are identical at every level.
+
+enum class CompareOp { Eq, Ne, Lt, Le, Gt, Ge };
+
+// mask[i] &= (values[i] op value), for the integer types and double
+template <typename T>
+void compare_mask(const T* values, size_t n, CompareOp op, T value, uint8_t* mask);
+
+// mask[i] &= bytes[i] ^ flip, with bytes and flip each 0 or 1
+void and_mask(uint8_t* mask, const uint8_t* bytes, size_t n, uint8_t flip);
+
+// Write the indices of the nonzero bytes of mask, ascending, to rows
+// (room for n); returns how many
+size_t mask_to_rows(const uint8_t* mask, size_t n, uint32_t* rows);
@@ -0,0 +1,655 @@
+#include <fine.hpp>
+#include <clickhouse/client.h>
+#include <clickhouse/block.h>
+#include <clickhouse/exceptions.h>
+#include <clickhouse/base/buffer.h>
+#include <clickhouse/base/input.h>
+#include <clickhouse/base/output.h>
+#include <clickhouse/base/wire_format.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include "client_options.h"
+#include "error_encoding.h"
+#include "native_format.h"
+
+using namespace clickhouse;
+
+// Forward declare BlockResource from block.cpp
+struct BlockResource {
+  std::shared_ptr<Block> ptr;
+
+  BlockResource() : ptr(std::make_shared<Block>()) {}
+  BlockResource(std::shared_ptr<Block> p) : ptr(p) {}
+};
+
+FINE_RESOURCE(BlockResource);
+
+namespace {
+
+// File layout: a header page, then a ring of records.
+//
+// head and tail are logical byte offsets that only grow; a record lives at
+// offset % capacity. Records never straddle the end of the ring: when one
+// does not fit, a wrap marker fills the rest and it starts at offset 0.
+// Each record is an 8-byte RecordHeader followed by the payload (table
+// name, then a Native block), padded to 8 bytes.
+constexpr uint64_t kSpoolMagic = 0x314c4f4f50534e4eULL;  // "NNSPOOL1"
+constexpr uint32_t kSpoolVersion = 1;
+constexpr size_t kHeaderSize = 4096;
+constexpr size_t kMinCapacity = 4096;
+constexpr size_t kRecordAlign = 8;
+constexpr uint32_t kWrapMarker = 0xFFFFFFFF;
+
+constexpr auto kMinBackoff = std::chrono::milliseconds(100);
+constexpr auto kMaxBackoff = std::chrono::milliseconds(10000);
+
+struct SpoolHeader {
+  uint64_t magic;
+  uint32_t version;
+  uint32_t reserved;
+  uint64_t capacity;
+  uint64_t head;
+  uint64_t tail;
+};
+
+struct RecordHeader {
+  uint32_t length;
+  uint32_t crc;
+};
+
+static_assert(sizeof(RecordHeader) == kRecordAlign, "record header must keep records aligned");
+
+uint32_t crc32(const uint8_t* data, size_t size) {
+  static const auto table = [] {
+    std::array<uint32_t, 256> t{};
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t c = i;
+      for (int k = 0; k < 8; k++) {
+        c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+      }
+      t[i] = c;
+    }
+    return t;
+  }();
+
+  uint32_t crc = 0xFFFFFFFFu;
+  for (size_t i = 0; i < size; i++) {
+    crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+  }
+  return crc ^ 0xFFFFFFFFu;
+}
+
+size_t align_record(size_t size) {
+  return (size + kRecordAlign - 1) & ~(kRecordAlign - 1);
+}
+
+// Server errors worth retrying: overload, memory pressure, read-only
+// replicas and lost connections to Keeper. Anything else (unknown table,
+// type mismatch) will fail the same way forever, so the batch is dropped.
+bool is_retriable_server_error(int code) {
+  switch (code) {
+    case 159:  // TIMEOUT_EXCEEDED
+    case 202:  // TOO_MANY_SIMULTANEOUS_QUERIES
+    case 209:  // SOCKET_TIMEOUT
+    case 210:  // NETWORK_ERROR
+    case 241:  // MEMORY_LIMIT_EXCEEDED
+    case 242:  // TABLE_IS_READ_ONLY
+    case 252:  // TOO_MANY_PARTS
+    case 319:  // UNKNOWN_STATUS_OF_INSERT
+    case 425:  // SYSTEM_ERROR
+    case 999:  // KEEPER_EXCEPTION
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool same_structure(const Block& a, const Block& b) {
+  if (a.GetColumnCount() != b.GetColumnCount()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.GetColumnCount(); i++) {
+    if (a.GetColumnName(i) != b.GetColumnName(i) ||
+        a[i]->Type()->GetName() != b[i]->Type()->GetName()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+// Durable insert spool: a memory-mapped, append-only ring on disk
+//
+// Appends serialize the block in the caller and copy it into the mapping,
+// so an insert is acknowledged at memory speed. A background thread drains
+// records to ClickHouse in batches (consecutive records for the same table
+// are merged into one INSERT), retries with backoff while the server is
+// unreachable, and advances `head` only after the server acknowledged. On
+// open, records between `head` and `tail` are checked and replayed, so
+// delivery is at-least-once: a crash between INSERT and advancing `head`
+// sends that batch again.
+class SpoolLog {
+public:
+  SpoolLog(const std::string& path, ClientOptions client_options, uint64_t capacity,
+           uint64_t batch_bytes, uint64_t linger_ms, bool sync)
+      : client_options_(std::move(client_options)),
+        batch_bytes_(std::max<uint64_t>(batch_bytes, 1)),
+        linger_(linger_ms),
+        sync_(sync) {
+    try {
+      Open(path, capacity);
+    } catch (...) {
+      Release();
+      throw;
+    }
+  }
+
+  ~SpoolLog() {
+    if (map_ != nullptr) {
+      SyncRange(map_, map_size_);
+    }
+    Release();
+  }
+
+  SpoolLog(const SpoolLog&) = delete;
+  SpoolLog& operator=(const SpoolLog&) = delete;
+
+  // Returns false when the ring has no room for the record
+  bool Append(const std::string& table, const Block& block) {
+    thread_local Buffer payload;
+    payload.clear();
+    {
+      BufferOutput output(&payload);
+      WireFormat::WriteString(output, table);
+      write_native_block(block, output);
+      output.Flush();
+    }
+
+    size_t record_size = align_record(sizeof(RecordHeader) + payload.size());
+    if (payload.size() >= kWrapMarker || record_size > capacity_) {
+      throw ValidationError("block of " + std::to_string(payload.size()) +
+                            " bytes does not fit in a spool of " + std::to_string(capacity_) +
+                            " bytes");
+    }
+    RecordHeader record{static_cast<uint32_t>(payload.size()),
+                        crc32(payload.data(), payload.size())};
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_) {
+      throw ValidationError("spool is closed");
+    }
+
+    uint64_t tail = header_->tail;
+    size_t offset = tail % capacity_;
+    size_t to_end = capacity_ - offset;
+    size_t needed = record_size > to_end ? to_end + record_size : record_size;
+    if (capacity_ - (tail - header_->head) < needed) {
+      return false;
+    }
+
+    if (record_size > to_end) {
+      RecordHeader wrap{kWrapMarker, 0};
+      std::memcpy(data_ + offset, &wrap, sizeof(wrap));
+      tail += to_end;
+      offset = 0;
+    }
+
+    std::memcpy(data_ + offset, &record, sizeof(record));
+    std::memcpy(data_ + offset + sizeof(record), payload.data(), payload.size());
+    if (sync_) {
+      SyncRange(data_ + offset, record_size);
+    }
+
+    // The record is complete before tail covers it
+    std::atomic_thread_fence(std::memory_order_release);
+    header_->tail = tail + record_size;
+    if (sync_) {
+      SyncRange(map_, sizeof(SpoolHeader));
+    }
+
+    appended_records_.fetch_add(1, std::memory_order_relaxed);
+    wake_.notify_one();
+    return true;
+  }
+
+  // Ask DrainLoop to return; false if it already was. Undrained records
+  // stay on disk for the next open.
+  bool Stop() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopping_) {
+        return false;
+      }
+      stopping_ = true;
+    }
+    wake_.notify_all();
+    return true;
+  }
+
+  void Sync() { SyncRange(map_, map_size_); }
+
+  ERL_NIF_TERM Stats(ErlNifEnv* env) {
+    uint64_t pending;
+    std::string last_error;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      pending = header_->tail - header_->head;
+      last_error = last_error_;
+    }
+
+    ERL_NIF_TERM error_term;
+    if (last_error.empty()) {
+      error_term = enif_make_atom(env, "nil");
+    } else {
+      unsigned char* bytes = enif_make_new_binary(env, last_error.size(), &error_term);
+      std::memcpy(bytes, last_error.data(), last_error.size());
+    }
+
+    ERL_NIF_TERM keys[] = {
+      enif_make_atom(env, "capacity_bytes"),
+      enif_make_atom(env, "pending_bytes"),
+      enif_make_atom(env, "appended_records"),
+      enif_make_atom(env, "drained_records"),
+      enif_make_atom(env, "drained_batches"),
+      enif_make_atom(env, "rejected_records"),
+      enif_make_atom(env, "recovered_records"),
+      enif_make_atom(env, "retries"),
+      enif_make_atom(env, "last_error")
+    };
+    ERL_NIF_TERM values[] = {
+      enif_make_uint64(env, capacity_),
+      enif_make_uint64(env, pending),
+      enif_make_uint64(env, appended_records_.load()),
+      enif_make_uint64(env, drained_records_.load()),
+      enif_make_uint64(env, drained_batches_.load()),
+      enif_make_uint64(env, rejected_records_.load()),
+      enif_make_uint64(env, recovered_records_),
+      enif_make_uint64(env, retries_.load()),
+      error_term
+    };
+
+    ERL_NIF_TERM stats;
+    enif_make_map_from_arrays(env, keys, values, 9, &stats);
+    return stats;
+  }
+
+  // Body of the drain thread; returns once Stop() is called
+  void DrainLoop() {
+    auto backoff = kMinBackoff;
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (true) {
+      wake_.wait(lock, [this] { return stopping_ || header_->tail != header_->head; });
+      if (stopping_) {
+        return;
+      }
+
+      // Give small appends a moment to accumulate into one INSERT
+      if (linger_.count() > 0 && header_->tail - header_->head < batch_bytes_) {
+        wake_.wait_for(lock, linger_, [this] {
+          return stopping_ || header_->tail - header_->head >= batch_bytes_;
+        });
+        if (stopping_) {
+          return;
+        }
+      }
+
+      uint64_t head = header_->head;
+      uint64_t tail = header_->tail;
+      lock.unlock();
+      // Appends only write past tail, so [head, tail) is stable here
+      std::string error;
+      uint64_t next = DrainBatch(head, tail, &error);
+      lock.lock();
+
+      if (!error.empty()) {
+        last_error_ = error;
+      }
+
+      if (next != head) {
+        header_->head = next;
+        if (sync_) {
+          SyncRange(map_, sizeof(SpoolHeader));
+        }
+        backoff = kMinBackoff;
+      } else {
+        retries_.fetch_add(1, std::memory_order_relaxed);
+        wake_.wait_for(lock, backoff, [this] { return stopping_; });
+        backoff = std::min(backoff * 2, kMaxBackoff);
+      }
+    }
+  }
+
+private:
+  void Release() {
+    if (map_ != nullptr) {
+      munmap(map_, map_size_);
+      map_ = nullptr;
+    }
+    if (fd_ >= 0) {
+      close(fd_);
+      fd_ = -1;
+    }
+  }
+
+  void Open(const std::string& path, uint64_t capacity) {
+    fd_ = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+      throw std::runtime_error("open " + path + ": " + std::strerror(errno));
+    }
+    if (flock(fd_, LOCK_EX | LOCK_NB) != 0) {
+      throw ValidationError("spool file is in use: " + path);
+    }
+
+    struct stat st;
+    if (fstat(fd_, &st) != 0) {
+      throw std::runtime_error("stat " + path + ": " + std::strerror(errno));
+    }
+
+    bool fresh = st.st_size == 0;
+    if (fresh) {
+      capacity = std::max<uint64_t>(align_record(capacity), kMinCapacity);
+      if (ftruncate(fd_, kHeaderSize + capacity) != 0) {
+        throw std::runtime_error("truncate " + path + ": " + std::strerror(errno));
+      }
+      map_size_ = kHeaderSize + capacity;
+    } else if (static_cast<size_t>(st.st_size) < kHeaderSize + kMinCapacity) {
+      throw ValidationError("not a spool file: " + path);
+    } else {
+      map_size_ = st.st_size;
+    }
+
+    void* map = mmap(nullptr, map_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (map == MAP_FAILED) {
+      throw std::runtime_error("mmap " + path + ": " + std::strerror(errno));
+    }
+    map_ = static_cast<uint8_t*>(map);
+    header_ = reinterpret_cast<SpoolHeader*>(map_);
+    data_ = map_ + kHeaderSize;
+
+    if (fresh) {
+      *header_ = SpoolHeader{kSpoolMagic, kSpoolVersion, 0, capacity, 0, 0};
+      SyncRange(map_, sizeof(SpoolHeader));
+    } else if (header_->magic != kSpoolMagic || header_->version != kSpoolVersion ||
+               header_->capacity + kHeaderSize != map_size_ ||
+               header_->tail < header_->head ||
+               header_->tail - header_->head > header_->capacity) {
+      throw ValidationError("not a spool file: " + path);
+    }
+
+    capacity_ = header_->capacity;
+    Recover();
+  }
+
+  // Count the records left by the last run; a torn or corrupt record ends
+  // the log there
+  void Recover() {
+    uint64_t pos = header_->head;
+    while (pos < header_->tail) {
+      size_t offset = pos % capacity_;
+      RecordHeader record;
+      std::memcpy(&record, data_ + offset, sizeof(record));
+
+      if (record.length == kWrapMarker) {
+        pos += capacity_ - offset;
+        continue;
+      }
+
+      size_t record_size = align_record(sizeof(record) + record.length);
+      if (record_size > capacity_ - offset || pos + record_size > header_->tail ||
+          crc32(data_ + offset + sizeof(record), record.length) != record.crc) {
+        header_->tail = pos;
+        break;
+      }
+
+      recovered_records_++;
+      pos += record_size;
+    }
+  }
+
+  // Insert the records at head as one batch. Returns the new head, or
+  // `head` itself when the batch must be retried.
+  //
+  // A merged batch the server rejects for good may hold a single bad
+  // record. Its records are then sent one INSERT each, up to `isolate_until_`,
+  // so only the records that fail on their own are dropped.
+  uint64_t DrainBatch(uint64_t head, uint64_t tail, std::string* error) {
+    std::string table;
+    Block batch;
+    size_t records = 0;
+    size_t bytes = 0;
+    uint64_t pos = head;
+
+    while (pos < tail && bytes < batch_bytes_ && (records == 0 || pos >= isolate_until_)) {
+      size_t offset = pos % capacity_;
+      RecordHeader record;
+      std::memcpy(&record, data_ + offset, sizeof(record));
+
+      if (record.length == kWrapMarker) {
+        pos += capacity_ - offset;
+        continue;
+      }
+
+      size_t record_size = align_record(sizeof(record) + record.length);
+      std::string record_table;
+      Block block;
+      try {
+        ArrayInput input(data_ + offset + sizeof(record), record.length);
+        if (!WireFormat::ReadString(input, &record_table)) {
+          throw ProtocolError("truncated spool record");
+        }
+        block = read_native_block(input);
+      } catch (const std::exception& e) {
+        if (records > 0) {
+          break;
+        }
+        // Undecodable and first in line: drop it so it cannot stall the spool
+        *error = encode_clickhouse_error(e);
+        rejected_records_.fetch_add(1, std::memory_order_relaxed);
+        return pos + record_size;
+      }
+
+      if (records == 0) {
+        table = std::move(record_table);
+        batch = std::move(block);
+      } else if (record_table != table || !same_structure(batch, block)) {
+        break;
+      } else {
+        for (size_t i = 0; i < batch.GetColumnCount(); i++) {
+          batch[i]->Append(block[i]);
+        }
+        batch.RefreshRowCount();
+      }
+
+      records++;
+      bytes += record.length;
+      pos += record_size;
+    }
+
+    if (records == 0) {
+      // Only a wrap marker was pending
+      return pos;
+    }
+
+    try {
+      if (!client_) {
+        client_ = std::make_unique<Client>(client_options_);
+      }
+      client_->Insert(table, batch);
+    } catch (const ServerException& e) {
+      *error = encode_clickhouse_error(e);
+      if (is_retriable_server_error(e.GetCode())) {
+        return head;
+      }
+      if (records > 1) {
+        isolate_until_ = pos;
+        return DrainBatch(head, tail, error);
+      }
+      rejected_records_.fetch_add(records, std::memory_order_relaxed);
+      return pos;
+    } catch (const std::exception& e) {
+      // Connection lost or server down: reconnect on the next attempt
+      *error = encode_clickhouse_error(e);
+      client_.reset();
+      return head;
+    }
+
+    drained_records_.fetch_add(records, std::memory_order_relaxed);
+    drained_batches_.fetch_add(1, std::memory_order_relaxed);
+    return pos;
+  }
+
+  void SyncRange(void* start, size_t length) {
+    // msync wants a page-aligned start
+    uintptr_t page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    uintptr_t address = reinterpret_cast<uintptr_t>(start);
+    uintptr_t aligned = address & ~(page - 1);
+    msync(reinterpret_cast<void*>(aligned), length + (address - aligned), MS_SYNC);
+  }
+
+  ClientOptions client_options_;
+  // Only touched by the drain thread
+  std::unique_ptr<Client> client_;
+  uint64_t isolate_until_ = 0;
+  uint64_t batch_bytes_;
+  std::chrono::milliseconds linger_;
+  bool sync_;
+
+  int fd_ = -1;
+  uint8_t* map_ = nullptr;
+  size_t map_size_ = 0;
+  SpoolHeader* header_ = nullptr;
+  uint8_t* data_ = nullptr;
+  uint64_t capacity_ = 0;
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  bool stopping_ = false;
+  std::string last_error_;
+
+  std::atomic<uint64_t> appended_records_{0};
+  std::atomic<uint64_t> drained_records_{0};
+  std::atomic<uint64_t> drained_batches_{0};
+  std::atomic<uint64_t> rejected_records_{0};
+  std::atomic<uint64_t> retries_{0};
+  uint64_t recovered_records_ = 0;
+};
+
+// NIF resource: a SpoolLog and the thread draining it
+//
+// The thread holds its own reference to the log. A spool dropped without
+// spool_close/1 is stopped and its thread detached instead of joined, as
+// the destructor runs wherever the resource is garbage collected and must
+// not wait out an INSERT. The file is unmapped and unlocked once the
+// thread lets go of the log.
+class Spool {
+public:
+  Spool(const std::string& path, ClientOptions client_options, uint64_t capacity,
+        uint64_t batch_bytes, uint64_t linger_ms, bool sync)
+      : log_(std::make_shared<SpoolLog>(path, std::move(client_options), capacity, batch_bytes,
+                                        linger_ms, sync)),
+        drainer_([log = log_] { log->DrainLoop(); }) {}
+
+  ~Spool() {
+    log_->Stop();
+    if (drainer_.joinable()) {
+      drainer_.detach();
+    }
+  }
+
+  Spool(const Spool&) = delete;
+  Spool& operator=(const Spool&) = delete;
+
+  bool Append(const std::string& table, const Block& block) { return log_->Append(table, block); }
+
+  ERL_NIF_TERM Stats(ErlNifEnv* env) { return log_->Stats(env); }
+
+  // Stop draining and wait for the thread, finishing an INSERT in progress
+  void Close() {
+    if (!log_->Stop()) {
+      return;
+    }
+    drainer_.join();
+    log_->Sync();
+  }
+
+private:
+  std::shared_ptr<SpoolLog> log_;
+  std::thread drainer_;
+};
+
+FINE_RESOURCE(Spool);
+
+// Open (or create) a spool file and start draining it to ClickHouse
+// Args: path, the client_create connection arguments, then capacity in
+//       bytes (only used when creating the file), batch_bytes, linger_ms
+//       and sync (msync every append)
+fine::ResourcePtr<Spool> spool_open(
+    ErlNifEnv *env,
+    std::string path,
+    std::string host,
+    uint64_t port,
+    std::string database,
+    std::string user,
+    std::string password,
+    bool compression,
+    bool ssl,
+    uint64_t connect_timeout,
+    uint64_t recv_timeout,
+    uint64_t send_timeout,
+    uint64_t capacity,
+    uint64_t batch_bytes,
+    uint64_t linger_ms,
+    bool sync) {
+  try {
+    ClientOptions opts = make_client_options(host, port, database, user, password, compression,
+                                             ssl, connect_timeout, recv_timeout, send_timeout);
+    return fine::make_resource<Spool>(path, opts, capacity, batch_bytes, linger_ms, sync);
+  } catch (const std::exception& e) {
+    throw std::runtime_error(encode_clickhouse_error(e));
+  }
+}
+FINE_NIF(spool_open, ERL_NIF_DIRTY_JOB_IO_BOUND);
+
+// Append a block for `table`; returns :spool_full when there is no room
+fine::Atom spool_append(
+    ErlNifEnv *env,
+    fine::ResourcePtr<Spool> spool,
+    std::string table,
+    fine::ResourcePtr<BlockResource> block_res) {
+  try {
+    return spool->Append(table, *block_res->ptr) ? fine::Atom("ok") : fine::Atom("spool_full");
+  } catch (const std::exception& e) {
+    throw std::runtime_error(encode_clickhouse_error(e));
+  }
+}
+FINE_NIF(spool_append, ERL_NIF_DIRTY_JOB_IO_BOUND);
+
+fine::Term spool_stats(ErlNifEnv *env, fine::ResourcePtr<Spool> spool) {
+  return spool->Stats(env);
+}
+FINE_NIF(spool_stats, 0);
+
+// Stop draining; may wait for an INSERT in progress
+fine::Atom spool_close(ErlNifEnv *env, fine::ResourcePtr<Spool> spool) {
+  spool->Close();
+  return fine::Atom("ok");
+}
+FINE_NIF(spool_close, ERL_NIF_DIRTY_JOB_IO_BOUND);
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <erl_nif.h>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Pool of ERL_NIF_TERM scratch vectors reused across blocks and queries.
+//
+// Only the term buffers the decoders fill are pooled. The socket and
+// decompression buffers and the column storage belong to clickhouse-cpp,
+// which has no allocator hook. bench/select_buffers_bench.exs counts the
+// allocator calls of both from outside the VM.
+//
+// SELECT NIFs run on dirty I/O scheduler threads, which live as long as the
+// VM, so a thread-local pool keeps its buffers between queries without any
+// locking. Buffers are bucketed by power-of-two capacity: a buffer in class k
+// holds at least 2^k terms, so any request up to 2^k can reuse it.
+class TermBufferPool {
+public:
+  static constexpr size_t kMinClass = 6;    // 64 terms
+  static constexpr size_t kMaxClass = 20;   // 1M terms (8 MiB); larger are freed
+  static constexpr size_t kPerClass = 2;
+  static constexpr size_t kMaxRetainedBytes = 32 * 1024 * 1024;
+
+  // Process-wide counters, read by select_buffer_stats/0
+  static inline std::atomic<uint64_t> allocations{0};
+  static inline std::atomic<uint64_t> reuses{0};
+  static inline std::atomic<int64_t> retained_bytes{0};
+
+  static TermBufferPool& Local() {
+    thread_local TermBufferPool pool;
+    return pool;
+  }
+
+  ~TermBufferPool() {
+    retained_bytes.fetch_sub(static_cast<int64_t>(retained_), std::memory_order_relaxed);
+  }
+
+  std::vector<ERL_NIF_TERM> Acquire(size_t capacity) {
+    size_t cls = CeilClass(capacity);
+    if (cls <= kMaxClass) {
+      auto& bucket = free_[cls - kMinClass];
+      if (!bucket.empty()) {
+        std::vector<ERL_NIF_TERM> buf = std::move(bucket.back());
+        bucket.pop_back();
+        Untrack(buf.capacity());
+        reuses.fetch_add(1, std::memory_order_relaxed);
+        return buf;
+      }
+    }
+
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    std::vector<ERL_NIF_TERM> buf;
+    buf.reserve(cls <= kMaxClass ? size_t(1) << cls : capacity);
+    return buf;
+  }
+
+  void Release(std::vector<ERL_NIF_TERM>&& buf) {
+    buf.clear();
+    size_t capacity = buf.capacity();
+    if (capacity < (size_t(1) << kMinClass)) {
+      return;
+    }
+
+    size_t cls = FloorClass(capacity);
+    size_t bytes = capacity * sizeof(ERL_NIF_TERM);
+    if (cls > kMaxClass || retained_ + bytes > kMaxRetainedBytes) {
+      return;  // freed when buf goes out of scope
+    }
+
+    auto& bucket = free_[cls - kMinClass];
+    if (bucket.size() < kPerClass) {
+      Track(capacity);
+      bucket.push_back(std::move(buf));
+    }
+  }
+
+private:
+  static size_t CeilClass(size_t n) {
+    size_t cls = kMinClass;
+    while ((size_t(1) << cls) < n) {
+      ++cls;
+    }
+    return cls;
+  }
+
+  static size_t FloorClass(size_t n) {
+    size_t cls = 0;
+    while ((n >> (cls + 1)) != 0) {
+      ++cls;
+    }
+    return cls;
+  }
+
+  void Track(size_t capacity) {
+    size_t bytes = capacity * sizeof(ERL_NIF_TERM);
+    retained_ += bytes;
+    retained_bytes.fetch_add(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+  }
+
+  void Untrack(size_t capacity) {
+    size_t bytes = capacity * sizeof(ERL_NIF_TERM);
+    retained_ -= bytes;
+    retained_bytes.fetch_sub(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+  }
+
+  std::array<std::vector<std::vector<ERL_NIF_TERM>>, kMaxClass - kMinClass + 1> free_;
+  size_t retained_ = 0;
+};
+
+// Scratch term vector borrowed from the calling thread's pool for one scope
+class ScratchTerms {
+public:
+  explicit ScratchTerms(size_t capacity)
+      : buf_(TermBufferPool::Local().Acquire(capacity)) {}
+  ~ScratchTerms() { TermBufferPool::Local().Release(std::move(buf_)); }
+
+  ScratchTerms(const ScratchTerms&) = delete;
+  ScratchTerms& operator=(const ScratchTerms&) = delete;
+
+  std::vector<ERL_NIF_TERM>& operator*() { return buf_; }
+  std::vector<ERL_NIF_TERM>* operator->() { return &buf_; }
+
+private:
+  std::vector<ERL_NIF_TERM> buf_;
+};
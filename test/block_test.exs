@@ -123,6 +123,107 @@ defmodule Natch.BlockTest do
     end
   end
 
+  describe "encode_native/2" do
+    defp serialized_block(columns, schema) do
+      Native.block_to_native(Block.build_block(columns, schema))
+    end
+
+    test "matches clickhouse-cpp serialization byte for byte" do
+      schema = [
+        id: :uint64,
+        small: :uint8,
+        delta: :int32,
+        tiny: :int8,
+        name: :string,
+        ratio: :float32,
+        amount: :float64,
+        flag: :bool,
+        day: :date,
+        created_at: :datetime,
+        updated_at: :datetime64,
+        uid: :uuid,
+        price: :decimal,
+        note: :nullable_string,
+        parent: {:nullable, :uint64},
+        tags: {:array, :string},
+        matrix: {:array, {:array, :int64}}
+      ]
+
+      columns = %{
+        id: [1, 18_446_744_073_709_551_615],
+        small: [0, 255],
+        delta: [-2_147_483_648, 7],
+        tiny: [-1, 127],
+        name: ["", "héllo"],
+        ratio: [1.5, 2],
+        amount: [-0.25, 1.0e300],
+        flag: [true, false],
+        day: [~D[2024-02-29], 19_000],
+        created_at: [~U[2024-10-29 10:00:00Z], ~N[2000-01-01 00:00:00]],
+        updated_at: [~U[2024-10-29 10:00:00.123456Z], 1_700_000_000_000_000],
+        uid: ["550e8400-e29b-41d4-a716-446655440000", <<1::128>>],
+        price: [Decimal.new("12.5"), 3],
+        note: [nil, "x"],
+        parent: [7, nil],
+        tags: [[], ["a", "bc"]],
+        matrix: [[[1], [], [2, 3]], []]
+      }
+
+      assert Block.encode_native(columns, schema) == serialized_block(columns, schema)
+    end
+
+    test "serializes other types through columns" do
+      schema = [
+        kind: {:enum8, [{"a", 1}, {"b", 2}]},
+        city: {:low_cardinality, :string},
+        pair: {:tuple, [:string, :uint64]},
+        attrs: {:map, :string, :uint64}
+      ]
+
+      columns = %{
+        kind: ["b", "a"],
+        city: ["x", "x"],
+        pair: [{"a", 1}, {"b", 2}],
+        attrs: [%{"k" => 1}, %{}]
+      }
+
+      assert Block.encode_native(columns, schema) == serialized_block(columns, schema)
+    end
+
+    test "round-trips through decode_native_cols/1" do
+      columns = %{id: [1, 2], name: ["Alice", nil], tags: [[1], [2, 3]]}
+      schema = [id: :uint32, name: {:nullable, :string}, tags: {:array, :int16}]
+
+      assert Natch.decode_native_cols(Block.encode_native(columns, schema)) == columns
+    end
+
+    test "rejects invalid values and ragged columns" do
+      assert_raise ArgumentError, ~r/Invalid value for UInt8 column: 256/, fn ->
+        Block.encode_native(%{id: [256]}, id: :uint8)
+      end
+
+      assert_raise ArgumentError, ~r/same number of values/, fn ->
+        Block.encode_native(%{id: [1, 2], name: ["a"]}, id: :uint64, name: :string)
+      end
+
+      assert_raise ArgumentError, ~r/Date value out of range/, fn ->
+        Block.encode_native(%{day: [~D[1969-12-31]]}, day: :date)
+      end
+
+      assert_raise ArgumentError, ~r/DateTime value out of range/, fn ->
+        Block.encode_native(%{at: [~U[2106-02-07 06:28:16Z]]}, at: :datetime)
+      end
+
+      assert_raise ArgumentError, ~r/column price: Decimal value out of range/, fn ->
+        Block.encode_native(%{price: [1.0e300]}, price: :decimal)
+      end
+
+      assert_raise ArgumentError, ~r/Decimal value out of range for Decimal/, fn ->
+        Native.column_encode_native("Decimal(9, 2)", [30_000_000.0])
+      end
+    end
+  end
+
   describe "INSERT operations" do
     test "can insert single row", %{conn: conn, table: table} do
       # Create table
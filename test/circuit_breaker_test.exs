@@ -0,0 +1,184 @@
+defmodule Natch.CircuitBreakerTest do
+  # Circuit state is shared per endpoint
+  use ExUnit.Case, async: false
+
+  alias Natch.CircuitBreaker
+
+  # Waits for casts sent to the breaker so far to be handled
+  defp sync, do: :sys.get_state(CircuitBreaker)
+
+  defp closed_port do
+    {:ok, listen} = :gen_tcp.listen(0, [])
+    {:ok, port} = :inet.port(listen)
+    :gen_tcp.close(listen)
+    port
+  end
+
+  defp await_status(endpoint, expected, attempts \\ 100) do
+    cond do
+      CircuitBreaker.status(endpoint) == expected ->
+        :ok
+
+      attempts == 0 ->
+        flunk("circuit never became #{expected}")
+
+      true ->
+        Process.sleep(10)
+        await_status(endpoint, expected, attempts - 1)
+    end
+  end
+
+  describe "connections" do
+    test "open circuit fails fast without connecting" do
+      Process.flag(:trap_exit, true)
+      port = closed_port()
+      breaker = [min_calls: 2, open_timeout: 60_000]
+      opts = [host: "127.0.0.1", port: port, circuit_breaker: breaker]
+
+      for _ <- 1..2 do
+        assert {:error, {%Natch.ConnectionError{reason: :connection_failed}, _}} =
+                 Natch.start_link(opts)
+      end
+
+      sync()
+      assert CircuitBreaker.status({"127.0.0.1", port}) == :open
+
+      assert {:error, {%Natch.ConnectionError{reason: :circuit_open}, _}} =
+               Natch.start_link(opts)
+
+      CircuitBreaker.reset({"127.0.0.1", port})
+    end
+
+    test "server errors do not count against the endpoint" do
+      endpoint = {"localhost", 9000}
+
+      {:ok, conn} =
+        Natch.start_link(host: "localhost", port: 9000, circuit_breaker: [min_calls: 1])
+
+      on_exit(fn -> CircuitBreaker.register(endpoint) end)
+
+      for _ <- 1..3 do
+        assert {:error, %{type: "server"}} = Natch.execute(conn, "INVALID SQL SYNTAX")
+      end
+
+      sync()
+      assert CircuitBreaker.status(endpoint) == :closed
+      assert :ok = Natch.ping(conn)
+    end
+
+    test "receive timeouts do not count against the endpoint" do
+      endpoint = {"localhost", 9000}
+
+      {:ok, conn} =
+        Natch.start_link(
+          host: "localhost",
+          port: 9000,
+          recv_timeout: 100,
+          circuit_breaker: [min_calls: 1]
+        )
+
+      on_exit(fn -> CircuitBreaker.register(endpoint) end)
+
+      assert {:error, _} = Natch.select_rows(conn, "SELECT sleep(1)")
+
+      sync()
+      assert CircuitBreaker.status(endpoint) == :closed
+    end
+
+    test "circuit_breaker: false skips registration" do
+      Process.flag(:trap_exit, true)
+      port = closed_port()
+
+      assert {:error, {%Natch.ConnectionError{reason: :connection_failed}, _}} =
+               Natch.start_link(host: "127.0.0.1", port: port, circuit_breaker: false)
+
+      assert CircuitBreaker.status({"127.0.0.1", port}) == nil
+    end
+  end
+
+  describe "state machine" do
+    test "stays closed below the failure threshold" do
+      endpoint = {"127.0.0.1", closed_port()}
+      :ok = CircuitBreaker.register(endpoint, min_calls: 4, failure_threshold: 0.5)
+
+      for outcome <- [:success, :success, :success, :failure, :success, :failure] do
+        CircuitBreaker.record(endpoint, outcome)
+      end
+
+      sync()
+      assert CircuitBreaker.status(endpoint) == :closed
+      assert CircuitBreaker.allow(endpoint) == :ok
+    end
+
+    test "probe moves an open circuit to half-open and a success closes it" do
+      {:ok, listen} = :gen_tcp.listen(0, [])
+      {:ok, port} = :inet.port(listen)
+      endpoint = {"127.0.0.1", port}
+      :ok = CircuitBreaker.register(endpoint, min_calls: 2, open_timeout: 10)
+
+      CircuitBreaker.record(endpoint, :failure)
+      CircuitBreaker.record(endpoint, :failure)
+      sync()
+      assert CircuitBreaker.allow(endpoint) == {:error, :circuit_open}
+
+      await_status(endpoint, :half_open)
+      assert CircuitBreaker.allow(endpoint) == :ok
+
+      CircuitBreaker.record(endpoint, :success)
+      sync()
+      assert CircuitBreaker.status(endpoint) == :closed
+      :gen_tcp.close(listen)
+    end
+
+    test "half-open admits a single probe" do
+      {:ok, listen} = :gen_tcp.listen(0, [])
+      {:ok, port} = :inet.port(listen)
+      endpoint = {"127.0.0.1", port}
+      :ok = CircuitBreaker.register(endpoint, min_calls: 1, open_timeout: 10)
+
+      CircuitBreaker.record(endpoint, :failure)
+      await_status(endpoint, :half_open)
+
+      assert CircuitBreaker.allow(endpoint) == :ok
+      assert CircuitBreaker.allow(endpoint) == {:error, :circuit_open}
+
+      # A probe that times out lets the next call probe
+      CircuitBreaker.record(endpoint, :timeout)
+      assert CircuitBreaker.status(endpoint) == :half_open
+      assert CircuitBreaker.allow(endpoint) == :ok
+      assert CircuitBreaker.allow(endpoint) == {:error, :circuit_open}
+
+      CircuitBreaker.record(endpoint, :success)
+      sync()
+      assert CircuitBreaker.status(endpoint) == :closed
+      assert CircuitBreaker.allow(endpoint) == :ok
+      :gen_tcp.close(listen)
+    end
+
+    test "timeouts do not count as failures" do
+      endpoint = {"127.0.0.1", closed_port()}
+      :ok = CircuitBreaker.register(endpoint, min_calls: 1)
+
+      for _ <- 1..3, do: CircuitBreaker.record(endpoint, :timeout)
+
+      sync()
+      assert CircuitBreaker.status(endpoint) == :closed
+    end
+
+    test "a failure while half-open reopens the circuit" do
+      {:ok, listen} = :gen_tcp.listen(0, [])
+      {:ok, port} = :inet.port(listen)
+      endpoint = {"127.0.0.1", port}
+      :ok = CircuitBreaker.register(endpoint, min_calls: 1, open_timeout: 10)
+
+      CircuitBreaker.record(endpoint, :failure)
+      await_status(endpoint, :half_open)
+      :gen_tcp.close(listen)
+
+      CircuitBreaker.record(endpoint, :failure)
+      sync()
+      assert CircuitBreaker.status(endpoint) == :open
+      CircuitBreaker.reset(endpoint)
+    end
+  end
+end
@@ -76,6 +76,19 @@ defmodule Natch.ColumnTest do
         Column.append_bulk(col, ["string"])
       end
     end
+
+    test "appends nothing when a value mid-list fails to decode" do
+      col = Column.new(:uint64)
+      :ok = Column.append_bulk(col, [1])
+
+      assert_raise ArgumentError, ~r/Invalid value for UInt64 column/, fn ->
+        Column.append_bulk(col, [2, 3, 18_446_744_073_709_551_616, 4])
+      end
+
+      assert Column.size(col) == 1
+      assert :ok = Column.append_bulk(col, [5])
+      assert Column.size(col) == 2
+    end
   end
 
   describe "Int64 column operations" do
@@ -198,6 +211,35 @@ defmodule Natch.ColumnTest do
       assert :ok = Column.append_bulk(col, [~U[1970-01-01 00:00:00Z]])
       assert Column.size(col) == 1
     end
+
+    test "can append NaiveDateTime values" do
+      col = Column.new(:datetime)
+      assert :ok = Column.append_bulk(col, [~N[2024-10-29 16:30:00], 1_730_220_600])
+      assert Column.size(col) == 2
+    end
+
+    test "raises on invalid datetime value without appending" do
+      col = Column.new(:datetime)
+
+      assert_raise ArgumentError, ~r/Invalid datetime value/, fn ->
+        Column.append_bulk(col, [~U[2024-10-29 16:30:00Z], "not a datetime"])
+      end
+
+      assert Column.size(col) == 0
+    end
+
+    test "raises on datetimes outside 1970..2106 without appending" do
+      col = Column.new(:datetime)
+
+      for value <- [~U[1969-12-31 23:59:59Z], ~N[2106-02-07 06:28:16], 4_294_967_296] do
+        assert_raise ArgumentError, ~r/DateTime value out of range/, fn ->
+          Column.append_bulk(col, [~U[2024-10-29 16:30:00Z], value])
+        end
+      end
+
+      assert :ok = Column.append_bulk(col, [~N[2106-02-07 06:28:15]])
+      assert Column.size(col) == 1
+    end
   end
 
   describe "Bool column operations" do
@@ -261,11 +303,38 @@ defmodule Natch.ColumnTest do
       assert Column.size(col) == 2
     end
 
+    test "accepts mix of Date structs and integers" do
+      col = Column.new(:date)
+      assert :ok = Column.append_bulk(col, [~D[2000-02-29], 19_000, ~D[1970-01-01]])
+      assert Column.size(col) == 3
+    end
+
+    test "raises on invalid date value" do
+      col = Column.new(:date)
+
+      assert_raise ArgumentError, ~r/Invalid date value/, fn ->
+        Column.append_bulk(col, [~N[2024-01-01 00:00:00]])
+      end
+    end
+
     test "can append epoch date (1970-01-01)" do
       col = Column.new(:date)
       assert :ok = Column.append_bulk(col, [~D[1970-01-01]])
       assert Column.size(col) == 1
     end
+
+    test "raises on dates outside 1970..2149 without appending" do
+      col = Column.new(:date)
+
+      for value <- [~D[1969-12-31], ~D[2149-06-07], 65_536] do
+        assert_raise ArgumentError, ~r/Date value out of range/, fn ->
+          Column.append_bulk(col, [~D[2024-01-01], value])
+        end
+      end
+
+      assert :ok = Column.append_bulk(col, [~D[2149-06-06]])
+      assert Column.size(col) == 1
+    end
   end
 
   describe "Float32 column operations" do
@@ -346,6 +415,23 @@ defmodule Natch.ColumnTest do
     end
   end
 
+  describe "UInt8 column operations" do
+    test "can create UInt8 column" do
+      col = Column.new(:uint8)
+      assert %Column{type: :uint8, clickhouse_type: "UInt8"} = col
+    end
+
+    test "appends values in range and raises outside it" do
+      col = Column.new(:uint8)
+      assert :ok = Column.append_bulk(col, [0, 255])
+      assert Column.size(col) == 2
+
+      assert_raise ArgumentError, ~r/0..255 for UInt8/, fn ->
+        Column.append_bulk(col, [256])
+      end
+    end
+  end
+
   describe "Int32 column operations" do
     test "can create Int32 column" do
       col = Column.new(:int32)
@@ -552,6 +638,12 @@ defmodule Natch.ColumnTest do
       assert Column.size(col) == 2
     end
 
+    test "can append NaiveDateTime values" do
+      col = Column.new(:datetime64)
+      :ok = Column.append_bulk(col, [~N[2024-01-01 10:00:00.123456], ~N[1969-12-31 23:59:59.5]])
+      assert Column.size(col) == 2
+    end
+
     test "raises on invalid datetime64 value" do
       col = Column.new(:datetime64)
 
@@ -619,6 +711,44 @@ defmodule Natch.ColumnTest do
       assert Column.size(col) == 2
     end
 
+    test "raises when Decimal has more fractional digits than the scale" do
+      col = Column.new(:decimal)
+
+      assert_raise ArgumentError, ~r/more than 9 fractional digits/, fn ->
+        Column.append_bulk(col, [Decimal.new("1.0000000001")])
+      end
+    end
+
+    test "raises when Decimal overflows Decimal64" do
+      col = Column.new(:decimal)
+
+      assert_raise ArgumentError, ~r/out of range/, fn ->
+        Column.append_bulk(col, [Decimal.new("100000000000")])
+      end
+    end
+
+    test "accepts trailing zeros beyond the scale" do
+      col = Column.new(:decimal)
+      :ok = Column.append_bulk(col, [Decimal.new("1.50000000000"), Decimal.new("0E-20")])
+      assert Column.size(col) == 2
+    end
+
+    test "accepts a coefficient beyond 64 bits when the exponent scales it down" do
+      col = Column.new(:decimal)
+      big = Integer.pow(10, 30)
+
+      :ok = Column.append_bulk(col, [Decimal.new(1, big * 15, -31), Decimal.new(-1, big, -29)])
+      assert Column.size(col) == 2
+
+      assert_raise ArgumentError, ~r/more than 9 fractional digits/, fn ->
+        Column.append_bulk(col, [Decimal.new(1, big + 1, -30)])
+      end
+
+      assert_raise ArgumentError, ~r/out of range/, fn ->
+        Column.append_bulk(col, [Decimal.new(1, big, 0)])
+      end
+    end
+
     test "raises on invalid decimal value" do
       col = Column.new(:decimal)
 
@@ -1048,6 +1178,67 @@ defmodule Natch.ColumnTest do
     end
   end
 
+  describe "Map column operations - append_bulk" do
+    test "appends Elixir maps to Map(String, UInt64)" do
+      col = Column.new({:map, :string, :uint64})
+      :ok = Column.append_bulk(col, [%{"k1" => 1, "k2" => 2}, %{}, %{"k3" => 3}])
+      assert Column.size(col) == 3
+    end
+
+    test "appends across multiple batches" do
+      col = Column.new({:map, :int32, :float64})
+      :ok = Column.append_bulk(col, [%{1 => 1.5, -2 => 2}])
+      :ok = Column.append_bulk(col, [%{3 => 3.25}, %{}])
+      assert Column.size(col) == 3
+    end
+
+    test "appends Map(UInt8, UInt8) values" do
+      col = Column.new({:map, :uint8, :uint8})
+      :ok = Column.append_bulk(col, [%{0 => 255, 7 => 1}, %{}])
+      assert Column.size(col) == 2
+
+      assert_raise ArgumentError, ~r/Invalid map value/, fn ->
+        Column.append_bulk(col, [%{1 => 256}])
+      end
+    end
+
+    test "appends Map(String, Bool) values" do
+      col = Column.new({:map, :string, :bool})
+      :ok = Column.append_bulk(col, [%{"active" => true, "admin" => false}])
+      assert Column.size(col) == 1
+    end
+
+    test "falls back to the columnar path for nested value types" do
+      col = Column.new({:map, :string, {:array, :uint64}})
+      :ok = Column.append_bulk(col, [%{"a" => [1, 2]}, %{"b" => []}])
+      assert Column.size(col) == 2
+    end
+
+    test "raises on key of the wrong type" do
+      col = Column.new({:map, :string, :uint64})
+
+      assert_raise ArgumentError, ~r/Invalid map key/, fn ->
+        Column.append_bulk(col, [%{1 => 1}])
+      end
+    end
+
+    test "raises on out of range value" do
+      col = Column.new({:map, :string, :uint16})
+
+      assert_raise ArgumentError, ~r/Invalid map value/, fn ->
+        Column.append_bulk(col, [%{"k" => 70_000}])
+      end
+    end
+
+    test "raises on non-map element" do
+      col = Column.new({:map, :string, :uint64})
+
+      assert_raise ArgumentError, ~r/Invalid map value/, fn ->
+        Column.append_bulk(col, [[{"k", 1}]])
+      end
+    end
+  end
+
   describe "LowCardinality column operations" do
     test "creates LowCardinality(String) column" do
       col = Column.new({:low_cardinality, :string})
@@ -1090,6 +1281,21 @@ defmodule Natch.ColumnTest do
       Column.append_bulk(col, ["a", "b", "d"])
       assert Column.size(col) == 6
     end
+
+    test "appends UTF-8 and empty strings to LowCardinality(String)" do
+      col = Column.new({:low_cardinality, :string})
+
+      Column.append_bulk(col, ["", "héllo", "世界", "", "héllo"])
+      assert Column.size(col) == 5
+    end
+
+    test "raises on non-string values for LowCardinality(String)" do
+      col = Column.new({:low_cardinality, :string})
+
+      assert_raise ArgumentError, ~r/All values must be strings/, fn ->
+        Column.append_bulk(col, ["a", 1])
+      end
+    end
   end
 
   describe "Enum8/Enum16 column operations" do
@@ -1144,5 +1350,133 @@ defmodule Natch.ColumnTest do
         Column.append_bulk(col, ["yes", "maybe"])
       end
     end
+
+    test "appends Enum8 values using atom names" do
+      col = Column.new({:enum8, [{"low", 1}, {"high", 2}]})
+      Column.append_bulk(col, [:low, :high, :high])
+      assert Column.size(col) == 3
+    end
+
+    test "appends mixed names and codes in one batch" do
+      col = Column.new({:enum16, [{"alpha", 100}, {"beta", 200}]})
+      Column.append_bulk(col, ["alpha", :beta, 100, 200])
+      assert Column.size(col) == 4
+    end
+
+    test "raises on undefined enum code" do
+      col = Column.new({:enum8, [{"yes", 1}, {"no", 0}]})
+
+      assert_raise ArgumentError, ~r/Unknown enum value: 5/, fn ->
+        Column.append_bulk(col, [1, 5])
+      end
+
+      # Nothing is appended when a batch fails validation
+      assert Column.size(col) == 0
+    end
+
+    test "raises on non-name enum values" do
+      col = Column.new({:enum8, [{"yes", 1}, {"no", 0}]})
+
+      assert_raise ArgumentError, ~r/must be strings, atoms or integers/, fn ->
+        Column.append_bulk(col, [1.5])
+      end
+    end
+  end
+
+  describe "LowCardinality and Enum round-trip" do
+    setup do
+      table = "test_#{System.unique_integer([:positive, :monotonic])}_#{:rand.uniform(999_999)}"
+      {:ok, conn} = Natch.start_link(host: "localhost", port: 9000)
+
+      on_exit(fn ->
+        if Process.alive?(conn) do
+          try do
+            Natch.execute(conn, "DROP TABLE IF EXISTS #{table}")
+          catch
+            :exit, _ -> :ok
+          end
+
+          Process.exit(conn, :normal)
+        end
+      end)
+
+      {:ok, conn: conn, table: table}
+    end
+
+    defp insert_block(conn, table, columns) do
+      block = Natch.Native.block_create()
+
+      for {name, col} <- columns do
+        Natch.Native.block_append_column(block, name, col.ref)
+      end
+
+      {:ok, client} = Natch.Connection.get_client(conn)
+      Natch.Native.client_insert(client, table, block)
+    end
+
+    test "LowCardinality(String) batches share one dictionary", %{conn: conn, table: table} do
+      :ok =
+        Natch.execute(conn, """
+        CREATE TABLE #{table} (id UInt64, tag LowCardinality(String)) ENGINE = Memory
+        """)
+
+      ids = Column.new(:uint64)
+      Column.append_bulk(ids, Enum.to_list(1..7))
+      tags = Column.new({:low_cardinality, :string})
+      Column.append_bulk(tags, ["b", "a", "b", ""])
+      Column.append_bulk(tags, ["héllo", "a", "b"])
+
+      :ok = insert_block(conn, table, [{"id", ids}, {"tag", tags}])
+
+      assert {:ok, cols} =
+               Natch.select_cols(conn, "SELECT id, tag FROM #{table} ORDER BY id")
+
+      assert cols.tag == ["b", "a", "b", "", "héllo", "a", "b"]
+
+      # Each distinct value has one dictionary slot, whatever the batch
+      assert {:ok, [%{keys: keys, indices: indices}]} =
+               Natch.select_rows(conn, """
+               SELECT groupArray(k) AS keys, groupArray(i) AS indices FROM (
+                 SELECT toString(tag) AS k, any(lowCardinalityIndices(tag)) AS i
+                 FROM #{table} GROUP BY k ORDER BY k
+               )
+               """)
+
+      assert keys == ["", "a", "b", "héllo"]
+      assert length(Enum.uniq(indices)) == 4
+    end
+
+    test "Enum8 and Enum16 names and codes", %{conn: conn, table: table} do
+      :ok =
+        Natch.execute(conn, """
+        CREATE TABLE #{table} (
+          id UInt64,
+          size Enum8('small' = 1, 'large' = -3),
+          color Enum16('red' = 1000, 'blue' = -2)
+        ) ENGINE = Memory
+        """)
+
+      ids = Column.new(:uint64)
+      Column.append_bulk(ids, [1, 2, 3, 4])
+      sizes = Column.new({:enum8, [{"small", 1}, {"large", -3}]})
+      Column.append_bulk(sizes, ["small", :large, -3, 1])
+      colors = Column.new({:enum16, [{"red", 1000}, {"blue", -2}]})
+      Column.append_bulk(colors, [1000, "blue", :red, -2])
+
+      :ok = insert_block(conn, table, [{"id", ids}, {"size", sizes}, {"color", colors}])
+
+      assert {:ok, rows} =
+               Natch.select_rows(conn, """
+               SELECT size, toInt8(size) AS size_code, color, toInt16(color) AS color_code
+               FROM #{table} ORDER BY id
+               """)
+
+      assert rows == [
+               %{size: "small", size_code: 1, color: "red", color_code: 1000},
+               %{size: "large", size_code: -3, color: "blue", color_code: -2},
+               %{size: "large", size_code: -3, color: "red", color_code: 1000},
+               %{size: "small", size_code: 1, color: "blue", color_code: -2}
+             ]
+    end
   end
 end
@@ -0,0 +1,136 @@
+defmodule Natch.CopyTest do
+  use ExUnit.Case, async: true
+
+  setup do
+    suffix = "#{System.unique_integer([:positive, :monotonic])}_#{:rand.uniform(999_999)}"
+    source = "test_copy_src_#{suffix}"
+    target = "test_copy_dst_#{suffix}"
+
+    {:ok, src} = Natch.start_link(host: "localhost", port: 9000)
+    {:ok, dst} = Natch.start_link(host: "localhost", port: 9000)
+
+    :ok =
+      Natch.execute(src, """
+      CREATE TABLE #{source} (id UInt32, total Nullable(Int64), name String) ENGINE = Memory
+      """)
+
+    on_exit(fn ->
+      for conn <- [src, dst], Process.alive?(conn) do
+        try do
+          Natch.execute(conn, "DROP TABLE IF EXISTS #{source}")
+          Natch.execute(conn, "DROP TABLE IF EXISTS #{target}")
+        catch
+          :exit, _ -> :ok
+        end
+
+        Process.exit(conn, :normal)
+      end
+    end)
+
+    {:ok, src: src, dst: dst, source: source, target: target}
+  end
+
+  test "copies every block", %{src: src, dst: dst, target: target} do
+    :ok = Natch.execute(dst, "CREATE TABLE #{target} (id UInt64, n UInt64) ENGINE = Memory")
+
+    sql = "SELECT number AS id, number * 2 AS n FROM system.numbers LIMIT 200000"
+
+    assert {:ok, %{rows: 200_000, blocks: blocks, inserts: 1}} =
+             Natch.copy(src, sql, dst, target, max_queued_blocks: 1)
+
+    assert blocks > 1
+
+    assert {:ok, [%{c: 200_000, s: sum}]} =
+             Natch.select_rows(dst, "SELECT count() AS c, sum(n) AS s FROM #{target}")
+
+    assert sum == 199_999 * 200_000
+  end
+
+  test "merges source blocks into larger INSERTs", %{src: src, dst: dst, target: target} do
+    :ok = Natch.execute(dst, "CREATE TABLE #{target} (id UInt64) ENGINE = Memory")
+
+    sql = """
+    SELECT number AS id FROM system.numbers LIMIT 200000 SETTINGS max_block_size = 10000
+    """
+
+    assert {:ok, %{rows: 200_000, blocks: blocks, inserts: inserts}} =
+             Natch.copy(src, sql, dst, target, min_insert_rows: 100_000)
+
+    assert blocks >= 20
+    assert inserts in 2..3
+
+    assert {:ok, [%{c: 200_000}]} =
+             Natch.select_rows(dst, "SELECT count() AS c FROM #{target}")
+  end
+
+  @schema [id: :uint32, total: {:nullable, :int64}, name: :string]
+
+  test "renames and casts columns", %{src: src, dst: dst, source: source, target: target} do
+    columns = %{id: [1, 2], total: [5, nil], name: ["a", "b"]}
+    :ok = Natch.insert_cols(src, source, columns, @schema)
+
+    :ok =
+      Natch.execute(dst, """
+      CREATE TABLE #{target} (id Int64, amount Nullable(Float64), label String) ENGINE = Memory
+      """)
+
+    assert {:ok, %{rows: 2}} =
+             Natch.copy(src, "SELECT * FROM #{source}", dst, target,
+               rename: [total: :amount, name: :label],
+               cast: [id: :int64, amount: "Nullable(Float64)"]
+             )
+
+    assert {:ok, rows} = Natch.select_rows(dst, "SELECT * FROM #{target} ORDER BY id")
+    assert rows == [%{id: 1, amount: 5.0, label: "a"}, %{id: 2, amount: nil, label: "b"}]
+  end
+
+  test "reports destination errors", %{src: src, dst: dst, source: source} do
+    :ok = Natch.insert_cols(src, source, %{id: [1], total: [1], name: ["a"]}, @schema)
+
+    assert {:error, _} = Natch.copy(src, "SELECT * FROM #{source}", dst, "missing_table")
+    assert {:ok, [%{x: 1}]} = Natch.select_rows(src, "SELECT 1 AS x")
+  end
+
+  test "rejects out-of-range casts and one connection", %{src: src, dst: dst, target: target} do
+    :ok = Natch.execute(dst, "CREATE TABLE #{target} (id UInt8) ENGINE = Memory")
+    sql = "SELECT toUInt32(number + 250) AS id FROM system.numbers LIMIT 10"
+
+    assert {:error, error} = Natch.copy(src, sql, dst, target, cast: [id: "UInt8"])
+    assert inspect(error) =~ "out of range"
+    assert {:ok, [%{x: 1}]} = Natch.select_rows(src, "SELECT 1 AS x")
+
+    assert_raise ArgumentError, fn -> Natch.copy(src, "SELECT 1", src, target) end
+  end
+
+  test "runs copies in opposite directions at once", %{src: src, dst: dst, target: target} do
+    for conn <- [src, dst] do
+      :ok = Natch.execute(conn, "CREATE TABLE #{target} (id UInt64) ENGINE = Memory")
+    end
+
+    sql = "SELECT number AS id FROM system.numbers LIMIT 100000"
+
+    tasks =
+      for {from, to} <- [{src, dst}, {dst, src}, {src, dst}, {dst, src}] do
+        Task.async(fn -> Natch.copy(from, sql, to, target, max_queued_blocks: 1) end)
+      end
+
+    assert Enum.all?(Task.await_many(tasks, 30_000), &match?({:ok, %{rows: 100_000}}, &1))
+
+    for conn <- [src, dst] do
+      assert {:ok, [%{c: 200_000}]} =
+               Natch.select_rows(conn, "SELECT count() AS c FROM #{target}")
+    end
+  end
+
+  test "tags errors with the side that raised them", %{src: src, dst: dst, target: target} do
+    :ok = Natch.execute(dst, "CREATE TABLE #{target} (id UInt64) ENGINE = Memory")
+
+    assert {:error, %{type: "server", details: %{"side" => "source"}}} =
+             Natch.copy(src, "SELECT * FROM missing_table", dst, target)
+
+    assert {:error, %{type: "server", details: %{"side" => "destination"}}} =
+             Natch.copy(src, "SELECT 1 AS id", dst, "missing_table")
+
+    assert {:ok, [%{x: 1}]} = Natch.select_rows(dst, "SELECT 1 AS x")
+  end
+end
@@ -0,0 +1,66 @@
+defmodule Natch.CpuDispatchTest do
+  # The kernel level is process-wide
+  use ExUnit.Case, async: false
+
+  @levels [:scalar, :sse4_2, :avx2, :avx512]
+
+  setup do
+    {:ok, conn} = Natch.start_link(host: "localhost", port: 9000)
+    %{level: level} = Natch.cpu_level()
+
+    on_exit(fn ->
+      :ok = Natch.put_cpu_level(level)
+      if Process.alive?(conn), do: Process.exit(conn, :normal)
+    end)
+
+    {:ok, conn: conn}
+  end
+
+  defp supported do
+    %{detected: detected} = Natch.cpu_level()
+    Enum.take_while(@levels, &(&1 != detected)) ++ [detected]
+  end
+
+  test "reports the active and detected levels" do
+    assert %{level: level, detected: detected} = Natch.cpu_level()
+    assert level in @levels and detected in @levels
+
+    :ok = Natch.put_cpu_level(:scalar)
+    assert %{level: :scalar, detected: ^detected} = Natch.cpu_level()
+  end
+
+  test "rejects levels the CPU lacks" do
+    case @levels -- supported() do
+      [] -> :ok
+      [level | _] -> assert_raise ArgumentError, fn -> Natch.put_cpu_level(level) end
+    end
+  end
+
+  test "filters identically at every level", %{conn: conn} do
+    # 1001 rows leaves a tail after every register width
+    sql = """
+    SELECT number AS id, toInt32(number % 7) - 3 AS score,
+           if(number % 5 = 0, NULL, number / 3) AS ratio
+    FROM system.numbers LIMIT 1001
+    """
+
+    filter = [{:score, :>=, 0}, {:ratio, :not_nil}, {:id, :!=, 500}, {:ratio, :<, 300.5}]
+
+    results =
+      for level <- supported() do
+        :ok = Natch.put_cpu_level(level)
+        {:ok, cols} = Natch.select_cols(conn, sql, [], filter: filter)
+        cols.id
+      end
+
+    expected =
+      for id <- 0..1000,
+          rem(id, 7) >= 3,
+          rem(id, 5) != 0,
+          id != 500,
+          id / 3 < 300.5,
+          do: id
+
+    assert Enum.all?(results, &(&1 == expected))
+  end
+end
@@ -0,0 +1,134 @@
+defmodule Natch.DedupTest do
+  use ExUnit.Case, async: true
+
+  alias Natch.Dedup
+
+  describe "filter/2" do
+    test "drops keys seen before and repeats within a batch" do
+      dedup = Dedup.new(keys: [:id], capacity: 1_000)
+
+      assert {%{id: [1, 2, 3], name: ["a", "b", "c"]}, 3} =
+               Dedup.filter(dedup, %{id: [1, 2, 3], name: ["a", "b", "c"]})
+
+      assert {%{id: [4, 5], name: ["d", "f"]}, 2} =
+               Dedup.filter(dedup, %{id: [2, 4, 4, 5], name: ["b", "d", "e", "f"]})
+
+      assert {%{id: [], name: []}, 0} = Dedup.filter(dedup, %{id: [1, 5], name: ["a", "f"]})
+
+      stats = Dedup.stats(dedup)
+      assert stats.checked_rows == 9
+      assert stats.dropped_rows == 4
+      assert stats.memory_bytes > 0
+    end
+
+    test "check remembers no key until commit" do
+      dedup = Dedup.new(keys: [:id])
+
+      assert {%{id: [1, 2]}, 2, pending} = Dedup.check(dedup, %{id: [1, 2, 1]})
+      assert {_, 2, _} = Dedup.check(dedup, %{id: [1, 2]})
+
+      # Keys of an insert still in flight count as seen
+      assert {%{id: [3]}, 1, _} = Dedup.check(dedup, %{id: [2, 3]}, pending)
+
+      :ok = Dedup.commit(dedup, pending)
+      assert {%{id: []}, 0, _} = Dedup.check(dedup, %{id: [1, 2]})
+    end
+
+    test "keys on the combination of columns" do
+      dedup = Dedup.new(keys: [:tenant, "id"])
+
+      columns = %{"id" => [1, 1, 2], tenant: ["a", "b", "a"]}
+      assert {_, 3} = Dedup.filter(dedup, columns)
+      assert {_, 1} = Dedup.filter(dedup, %{"id" => [1, 3], tenant: ["a", "a"]})
+    end
+
+    test "forgets keys after the window" do
+      dedup = Dedup.new(keys: [:id], window: 40)
+
+      assert {_, 1} = Dedup.filter(dedup, %{id: [1]})
+      assert {_, 0} = Dedup.filter(dedup, %{id: [1]})
+
+      Process.sleep(100)
+      assert {_, 1} = Dedup.filter(dedup, %{id: [1]})
+      assert Dedup.stats(dedup).rotations >= 1
+    end
+
+    test "stays near the configured false-positive rate" do
+      dedup = Dedup.new(keys: [:id], capacity: 10_000, false_positive_rate: 0.01)
+
+      {_, kept} = Dedup.filter(dedup, %{id: Enum.to_list(1..10_000)})
+      assert kept > 9_800
+
+      :ok = Dedup.reset(dedup)
+      assert {_, 1} = Dedup.filter(dedup, %{id: [1]})
+    end
+
+    test "caps memory when asked" do
+      dedup = Dedup.new(keys: [:id], capacity: 1_000_000, max_memory: 64 * 1024)
+      stats = Dedup.stats(dedup)
+
+      assert stats.memory_bytes <= 64 * 1024
+      assert stats.false_positive_rate > 0.001
+    end
+
+    test "rejects invalid options" do
+      assert_raise ArgumentError, fn -> Dedup.new(keys: []) end
+      assert_raise ArgumentError, fn -> Dedup.new(keys: [:id], false_positive_rate: 1.5) end
+      assert_raise ArgumentError, fn -> Dedup.filter(Dedup.new(keys: [:id]), %{name: ["a"]}) end
+    end
+  end
+
+  describe "inserts" do
+    setup do
+      table = "test_#{System.unique_integer([:positive, :monotonic])}_#{:rand.uniform(999_999)}"
+
+      {:ok, conn} = Natch.start_link(host: "localhost", port: 9000)
+      :ok = Natch.execute(conn, "CREATE TABLE #{table} (id UInt64, name String) ENGINE = Memory")
+
+      on_exit(fn ->
+        if Process.alive?(conn) do
+          try do
+            Natch.execute(conn, "DROP TABLE IF EXISTS #{table}")
+          catch
+            :exit, _ -> :ok
+          end
+
+          Process.exit(conn, :normal)
+        end
+      end)
+
+      {:ok, conn: conn, table: table}
+    end
+
+    @schema [id: :uint64, name: :string]
+
+    test "overlapping batches insert each row once", %{conn: conn, table: table} do
+      dedup = Dedup.new(keys: [:id])
+
+      :ok = Natch.insert_cols(conn, table, %{id: [1, 2], name: ["a", "b"]}, @schema, dedup: dedup)
+      :ok = Natch.insert_cols(conn, table, %{id: [2, 3], name: ["b", "c"]}, @schema, dedup: dedup)
+      :ok = Natch.insert_rows(conn, table, [%{id: 3, name: "c"}], @schema, dedup: dedup)
+
+      chunks = [%{id: [3, 4], name: ["c", "d"]}, %{id: [4], name: ["d"]}]
+      :ok = Natch.insert_stream(conn, table, chunks, @schema, dedup: dedup)
+
+      assert {:ok, rows} = Natch.select_rows(conn, "SELECT id FROM #{table} ORDER BY id")
+      assert Enum.map(rows, & &1.id) == [1, 2, 3, 4]
+    end
+
+    test "a failed insert can be retried with the same rows", %{conn: conn, table: table} do
+      dedup = Dedup.new(keys: [:id])
+      columns = %{id: [1, 2], name: ["a", "b"]}
+      missing = "no_such_table_for_dedup"
+
+      assert {:error, _} = Natch.insert_cols(conn, missing, columns, @schema, dedup: dedup)
+      assert {:error, _} = Natch.insert_stream(conn, missing, [columns], @schema, dedup: dedup)
+
+      :ok = Natch.insert_cols(conn, table, columns, @schema, dedup: dedup)
+      :ok = Natch.insert_cols(conn, table, columns, @schema, dedup: dedup)
+
+      assert {:ok, rows} = Natch.select_rows(conn, "SELECT id FROM #{table} ORDER BY id")
+      assert Enum.map(rows, & &1.id) == [1, 2]
+    end
+  end
+end
@@ -0,0 +1,125 @@
+defmodule Natch.HedgeTest do
+  # Hedge statistics are global
+  use ExUnit.Case, async: false
+
+  setup do
+    # Two connections to the same server stand in for two replicas
+    {:ok, replica_a} = Natch.start_link(host: "localhost", port: 9000)
+    {:ok, replica_b} = Natch.start_link(host: "localhost", port: 9000)
+    Natch.Hedge.reset_stats()
+
+    on_exit(fn ->
+      for conn <- [replica_a, replica_b], Process.alive?(conn) do
+        Process.exit(conn, :normal)
+      end
+    end)
+
+    {:ok, conns: [replica_a, replica_b]}
+  end
+
+  describe "hedged reads" do
+    test "fast primary answers without hedging", %{conns: conns} do
+      assert {:ok, rows} =
+               Natch.Hedge.select_rows(conns, "SELECT number FROM numbers(3)", [],
+                 hedge_after: 5_000
+               )
+
+      assert Enum.map(rows, & &1.number) == [0, 1, 2]
+      assert %{queries: 1, hedged: 0} = Natch.Hedge.stats()
+    end
+
+    test "slow primary is hedged and one response wins", %{conns: conns} do
+      assert {:ok, %{n: [42]}} =
+               Natch.Hedge.select_cols(conns, "SELECT toUInt64({x}) AS n", [x: 42],
+                 hedge_after: 0
+               )
+
+      stats = Natch.Hedge.stats()
+      assert stats.queries == 1
+      assert stats.hedged in [0, 1]
+      assert stats.hedge_wins + stats.primary_wins == stats.hedged
+    end
+
+    test "hedge answers when the primary fails after hedging", %{conns: [_, replica]} do
+      # Stands in for a replica that fails once the hedge is already running
+      primary =
+        spawn(fn ->
+          receive do
+            {:"$gen_call", from, _request} ->
+              Process.sleep(50)
+              GenServer.reply(from, {:error, :replica_down})
+          end
+        end)
+
+      assert {:ok, %{n: [42]}} =
+               Natch.Hedge.select_cols(
+                 [primary, replica],
+                 "SELECT toUInt64(42 + sleep(0.5)) AS n",
+                 [],
+                 hedge_after: 10
+               )
+
+      assert %{queries: 1, hedged: 1, hedge_wins: 1, primary_wins: 0} = Natch.Hedge.stats()
+      refute_received {:natch_first_block, _}
+    end
+
+    test "a hedge that beats a stuck primary still records a latency", %{conns: [_, replica]} do
+      # Stands in for a replica that never answers
+      primary = spawn(fn -> Process.sleep(:infinity) end)
+
+      for _ <- 1..20 do
+        assert {:ok, %{n: [1]}} =
+                 Natch.Hedge.select_cols([primary, replica], "SELECT 1 AS n", [], hedge_after: 10)
+      end
+
+      assert %{hedge_wins: 20, p95_ms: p95} = Natch.Hedge.stats()
+      assert p95 >= 10
+      Process.exit(primary, :kill)
+    end
+
+    test "both connections stay usable after a cancelled loser", %{conns: conns} do
+      for _ <- 1..5 do
+        assert {:ok, _} =
+                 Natch.Hedge.select_rows(conns, "SELECT number FROM numbers(100000)", [],
+                   hedge_after: 0
+                 )
+      end
+
+      for conn <- conns do
+        assert {:ok, [%{x: 1}]} = Natch.select_rows(conn, "SELECT 1 AS x")
+      end
+    end
+
+    test "rejects an invalid hedge delay", %{conns: conns} do
+      assert_raise ArgumentError, fn ->
+        Natch.Hedge.select_rows(conns, "SELECT 1", [], hedge_after: :soon)
+      end
+    end
+  end
+
+  describe "cancel tokens" do
+    test "a cancelled token stops the query", %{conns: [conn | _]} do
+      token = Natch.Native.cancel_token_create(make_ref())
+      :ok = Natch.Native.cancel_token_cancel(token)
+
+      assert {:error, _} =
+               Natch.select_rows(conn, "SELECT number FROM numbers(10)", [],
+                 cancel_token: token
+               )
+
+      assert {:ok, [%{x: 1}]} = Natch.select_rows(conn, "SELECT 1 AS x")
+    end
+
+    test "the first block with rows notifies the token owner", %{conns: [conn | _]} do
+      ref = make_ref()
+      token = Natch.Native.cancel_token_create(ref)
+
+      assert {:ok, _} =
+               Natch.select_rows(conn, "SELECT number FROM numbers(10)", [],
+                 cancel_token: token
+               )
+
+      assert_received {:natch_first_block, ^ref}
+    end
+  end
+end
@@ -0,0 +1,80 @@
+defmodule Natch.NativeDecodeTest do
+  use ExUnit.Case, async: true
+
+  # Native blocks built by hand: varint columns, varint rows, then per column
+  # name, type and data (all lengths here fit in one varint byte)
+  defp block(rows, columns) do
+    body =
+      for {name, type, data} <- columns, into: <<>> do
+        <<byte_size(name), name::binary, byte_size(type), type::binary, data::binary>>
+      end
+
+    <<length(columns), rows, body::binary>>
+  end
+
+  defp strings(values), do: for(v <- values, into: <<>>, do: <<byte_size(v), v::binary>>)
+
+  @block block(2, [
+           {"id", "UInt64", <<1::little-64, 2::little-64>>},
+           {"name", "String", strings(["a", "bc"])},
+           {"score", "Nullable(Int32)", <<0, 1, -5::little-signed-32, 0::32>>},
+           {"tags", "Array(UInt8)", <<1::little-64, 3::little-64, 7, 8, 9>>},
+           {"day", "Date", <<19_000::little-16, 19_001::little-16>>}
+         ])
+
+  test "decodes rows" do
+    assert Natch.decode_native_rows(@block) == [
+             %{id: 1, name: "a", score: -5, tags: [7], day: 19_000},
+             %{id: 2, name: "bc", score: nil, tags: [8, 9], day: 19_001}
+           ]
+  end
+
+  test "decodes columns across blocks" do
+    second = block(1, [{"id", "UInt64", <<3::little-64>>}, {"name", "String", strings(["d"])}])
+    first = block(1, [{"id", "UInt64", <<1::little-64>>}, {"name", "String", strings(["a"])}])
+
+    assert Natch.decode_native_cols(first <> second) == %{id: [1, 3], name: ["a", "d"]}
+  end
+
+  test "falls back to clickhouse-cpp for other types" do
+    data = block(2, [{"kind", "Enum8('x' = 1, 'y' = 2)", <<2, 1>>}])
+    assert Natch.decode_native_cols(data) == %{kind: ["y", "x"]}
+  end
+
+  test "falls back for Nullable(Enum8) with NULL slots holding 0" do
+    data = block(3, [{"kind", "Nullable(Enum8('x' = 1, 'y' = 2))", <<0, 1, 0, 1, 0, 2>>}])
+    assert Natch.decode_native_cols(data) == %{kind: ["x", nil, "y"]}
+  end
+
+  test "decodes empty input and empty blocks" do
+    assert Natch.decode_native_rows(<<>>) == []
+    assert Natch.decode_native_cols(block(0, [{"id", "UInt64", <<>>}])) == %{id: []}
+  end
+
+  test "raises on truncated data" do
+    assert_raise RuntimeError, ~r/truncated/, fn ->
+      Natch.decode_native_rows(binary_part(@block, 0, byte_size(@block) - 3))
+    end
+  end
+
+  defp varint(n) when n < 128, do: <<n>>
+  defp varint(n), do: <<1::1, rem(n, 128)::7, varint(div(n, 128))::binary>>
+
+  test "raises on counts the data cannot hold" do
+    # 2^61 UInt64 values would wrap to a zero byte count
+    huge = <<1, varint(Bitwise.bsl(1, 61))::binary, 2, "id", 6, "UInt64", 1::little-64>>
+
+    assert_raise RuntimeError, ~r/truncated/, fn -> Natch.decode_native_rows(huge) end
+
+    # An Array whose last offset claims 2^61 elements
+    offsets = <<Bitwise.bsl(1, 61)::little-64>>
+
+    assert_raise RuntimeError, ~r/truncated/, fn ->
+      Natch.decode_native_cols(block(1, [{"tags", "Array(UInt64)", offsets <> <<1::64>>}]))
+    end
+
+    assert_raise RuntimeError, ~r/truncated/, fn ->
+      Natch.decode_native_cols(<<varint(Bitwise.bsl(1, 40))::binary, 1>>)
+    end
+  end
+end
@@ -88,6 +88,45 @@ defmodule Natch.NestingIntegrationTest do
     end
   end
 
+  describe "Nullable runs roundtrip" do
+    test "sparse, all-null and no-null columns", %{conn: conn, table: table} do
+      Natch.execute(conn, """
+      CREATE TABLE #{table} (
+        id UInt64,
+        sparse Nullable(String),
+        empty Nullable(UInt64),
+        full Nullable(Float64)
+      ) ENGINE = Memory
+      """)
+
+      schema = [
+        id: :uint64,
+        sparse: {:nullable, :string},
+        empty: {:nullable, :uint64},
+        full: {:nullable, :float64}
+      ]
+
+      ids = Enum.to_list(1..100)
+      sparse = Enum.map(ids, fn id -> if rem(id, 20) == 0, do: "hit", else: nil end)
+
+      columns = %{
+        id: ids,
+        sparse: sparse,
+        empty: List.duplicate(nil, 100),
+        full: Enum.map(ids, &(&1 * 1.0))
+      }
+
+      assert :ok = Natch.insert_cols(conn, table, columns, schema)
+
+      assert {:ok, result} =
+               Natch.select_cols(conn, "SELECT * FROM #{table} ORDER BY id")
+
+      assert result.sparse == sparse
+      assert result.empty == List.duplicate(nil, 100)
+      assert result.full == Enum.map(ids, &(&1 * 1.0))
+    end
+  end
+
   describe "LowCardinality(Nullable(String)) roundtrip" do
     test "with interspersed nulls and duplicates", %{conn: conn, table: table} do
       Natch.execute(conn, """
@@ -371,6 +410,61 @@ defmodule Natch.NestingIntegrationTest do
     end
   end
 
+  describe "Nullable(Enum8) roundtrip" do
+    test "NULL slots are not decoded as enum members", %{conn: conn, table: table} do
+      # 0, the value a NULL slot holds, is not a member
+      :ok =
+        Natch.execute(conn, """
+        CREATE TABLE #{table} (
+          id UInt64,
+          size Nullable(Enum8('small' = 1, 'large' = 2))
+        ) ENGINE = Memory
+        """)
+
+      :ok =
+        Natch.execute(conn, """
+        INSERT INTO #{table} VALUES (1, 'small'), (2, NULL), (3, NULL), (4, 'large'), (5, NULL)
+        """)
+
+      sql = "SELECT * FROM #{table} ORDER BY id"
+      assert {:ok, rows} = Natch.select_rows(conn, sql)
+
+      assert rows == [
+               %{id: 1, size: "small"},
+               %{id: 2, size: nil},
+               %{id: 3, size: nil},
+               %{id: 4, size: "large"},
+               %{id: 5, size: nil}
+             ]
+
+      assert {:ok, %{size: ["small", nil, nil, "large", nil]}} = Natch.select_cols(conn, sql)
+      assert {:ok, [%{size: nil}]} = Natch.select_rows(conn, "#{sql} LIMIT 1 OFFSET 2")
+    end
+
+    test "filters NULL slots without decoding them", %{conn: conn, table: table} do
+      :ok =
+        Natch.execute(conn, """
+        CREATE TABLE #{table} (
+          id UInt64,
+          size Nullable(Enum8('small' = 1, 'large' = 2))
+        ) ENGINE = Memory
+        """)
+
+      :ok = Natch.execute(conn, "INSERT INTO #{table} VALUES (1, 'small'), (2, NULL), (3, 'large')")
+
+      sql = "SELECT id, size FROM #{table} ORDER BY id"
+      ids = fn filter ->
+        {:ok, cols} = Natch.select_cols(conn, sql, [], filter: filter)
+        cols.id
+      end
+
+      assert ids.([{:size, :==, "large"}]) == [3]
+      assert ids.([{:size, :!=, "large"}]) == [1]
+      assert ids.([{:size, :is_nil}]) == [2]
+      assert ids.([{:id, :>=, 2}]) == [2, 3]
+    end
+  end
+
   describe "Array(Enum8) roundtrip" do
     test "enums in arrays", %{conn: conn, table: table} do
       Natch.execute(conn, """
@@ -0,0 +1,77 @@
+defmodule Natch.Pool.LimiterTest do
+  use ExUnit.Case, async: true
+
+  alias Natch.Pool.Limiter
+
+  test "starts at the pool size" do
+    assert Limiter.new(8, []) |> Limiter.limit() == 8
+    assert Limiter.new(8, initial: 2) |> Limiter.limit() == 2
+  end
+
+  test "overload errors cut the limit multiplicatively, once per window" do
+    limiter = Limiter.new(10, backoff: 0.5)
+
+    limiter = Limiter.update(limiter, {:server_error, 202}, 1_000, 10)
+    assert Limiter.limit(limiter) == 5
+    assert limiter.decreases == 1
+
+    # Queries admitted under the old limit don't cut it again
+    limiter = Limiter.update(limiter, {:server_error, 202}, 1_000, 9)
+    assert Limiter.limit(limiter) == 5
+
+    limiter = Enum.reduce(1..4, limiter, fn _, acc -> Limiter.update(acc, :ok, 1_000, 1) end)
+    limiter = Limiter.update(limiter, {:server_error, 202}, 1_000, 5)
+    assert Limiter.limit(limiter) == 2
+    assert limiter.decreases == 2
+  end
+
+  test "never drops below the minimum" do
+    limiter =
+      Enum.reduce(1..200, Limiter.new(10, min: 3), fn _, acc ->
+        Limiter.update(acc, {:server_error, 202}, 1_000, 10)
+      end)
+
+    assert Limiter.limit(limiter) == 3
+  end
+
+  test "other errors leave the limit alone" do
+    limiter = Limiter.new(10, initial: 4)
+
+    assert Limiter.update(limiter, {:server_error, 60}, 1_000, 4) == limiter
+    assert Limiter.update(limiter, :error, 1_000, 4) == limiter
+  end
+
+  test "successes at the limit raise it additively up to the maximum" do
+    limiter = Limiter.new(4, initial: 2)
+
+    # About one step per limit's worth of completions
+    limiter = Enum.reduce(1..3, limiter, fn _, acc -> Limiter.update(acc, :ok, 1_000, 2) end)
+    assert Limiter.limit(limiter) == 3
+
+    limiter =
+      Enum.reduce(1..100, limiter, fn _, acc -> Limiter.update(acc, :ok, 1_000, 4) end)
+
+    assert Limiter.limit(limiter) == 4
+  end
+
+  test "successes below the limit don't raise it" do
+    limiter = Limiter.new(10, initial: 4)
+    limiter = Limiter.update(limiter, :ok, 1_000, 1)
+    assert limiter.limit == 4.0
+  end
+
+  test "a latency spike cuts the limit once" do
+    limiter =
+      Enum.reduce(1..20, Limiter.new(10, backoff: 0.5), fn _, acc ->
+        Limiter.update(acc, :ok, 1_000, 1)
+      end)
+
+    assert Limiter.limit(limiter) == 10
+
+    limiter =
+      Enum.reduce(1..5, limiter, fn _, acc -> Limiter.update(acc, :ok, 50_000, 1) end)
+
+    assert limiter.decreases == 1
+    assert Limiter.limit(limiter) == 5
+  end
+end
@@ -0,0 +1,193 @@
+defmodule Natch.PoolTest do
+  use ExUnit.Case, async: true
+
+  defp start_pool(opts) do
+    start_supervised!({Natch.Pool, Keyword.put(opts, :connection, host: "localhost", port: 9000)})
+  end
+
+  # Check out a connection and hold it until told to release
+  defp hold(pool, opts) do
+    test = self()
+
+    pid =
+      spawn_link(fn ->
+        Natch.Pool.run(
+          pool,
+          fn _conn ->
+            send(test, {:holding, self()})
+
+            receive do
+              :release -> :ok
+            end
+          end,
+          opts
+        )
+      end)
+
+    assert_receive {:holding, ^pid}
+    pid
+  end
+
+  defp wait_for_depth(pool, class, depth) do
+    if Natch.Pool.metrics(pool).queue_depth[class] < depth do
+      Process.sleep(5)
+      wait_for_depth(pool, class, depth)
+    end
+  end
+
+  test "runs queries on pooled connections" do
+    pool = start_pool(size: 2)
+
+    assert {:ok, [%{x: 1}]} = Natch.Pool.select_rows(pool, "SELECT {x} AS x", x: 1)
+    assert {:ok, %{n: [0, 1]}} = Natch.Pool.select_cols(pool, "SELECT number AS n FROM numbers(2)")
+
+    assert %{size: 2, idle: 2, busy: 0} = Natch.Pool.metrics(pool)
+  end
+
+  test "caps connections per tenant" do
+    pool = start_pool(size: 2, tenant_limit: 1)
+    holder = hold(pool, tenant: :a)
+
+    # Tenant :a is at its cap even though a connection is idle
+    assert {:error, :queue_timeout} =
+             Natch.Pool.run(pool, fn _ -> :ran end, tenant: :a, queue_timeout: 50)
+
+    assert :ran = Natch.Pool.run(pool, fn _ -> :ran end, tenant: :b)
+
+    metrics = Natch.Pool.metrics(pool)
+    assert metrics.running == %{a: 1}
+    assert metrics.queue_timeouts == 1
+
+    send(holder, :release)
+  end
+
+  test "interactive work overtakes queued background work" do
+    pool = start_pool(size: 1)
+    holder = hold(pool, priority: :default)
+    test = self()
+
+    for {priority, n} <- [background: 1, background: 2, background: 3, interactive: 4] do
+      spawn_link(fn ->
+        Natch.Pool.run(pool, fn _ -> send(test, {:served, n}) end, priority: priority)
+      end)
+
+      wait_for_depth(pool, priority, if(priority == :background, do: n, else: 1))
+    end
+
+    send(holder, :release)
+
+    served =
+      for _ <- 1..4 do
+        assert_receive {:served, n}
+        n
+      end
+
+    assert served == [4, 1, 2, 3]
+
+    wait_ms = Natch.Pool.metrics(pool).wait_ms
+    assert wait_ms.background.count == 3
+    assert wait_ms.interactive.count == 1
+  end
+
+  test "reclaims connections from callers that die" do
+    pool = start_pool(size: 1)
+    holder = hold(pool, [])
+
+    Process.unlink(holder)
+    Process.exit(holder, :kill)
+
+    assert :ran = Natch.Pool.run(pool, fn _ -> :ran end, queue_timeout: 1_000)
+  end
+
+  test "sheds checkouts once the queue is full" do
+    pool = start_pool(size: 1, max_queue: 1)
+    holder = hold(pool, [])
+
+    spawn_link(fn -> Natch.Pool.run(pool, fn _ -> :ran end) end)
+    wait_for_depth(pool, :default, 1)
+
+    assert {:error, :overloaded} = Natch.Pool.run(pool, fn _ -> :ran end)
+    assert %{shed: 1} = Natch.Pool.metrics(pool)
+
+    send(holder, :release)
+  end
+
+  test "adaptive pools report their in-flight limit" do
+    pool = start_pool(size: 4, adaptive: [initial: 2])
+
+    assert %{limit: 2} = Natch.Pool.metrics(pool)
+    assert {:ok, _} = Natch.Pool.select_rows(pool, "SELECT 1 AS x")
+    assert %{limit: 2, limit_decreases: 0} = Natch.Pool.metrics(pool)
+  end
+
+  test "rejects unknown priority classes" do
+    pool = start_pool(size: 1)
+
+    assert {:error, {:unknown_priority, :urgent}} =
+             Natch.Pool.run(pool, fn _ -> :ran end, priority: :urgent)
+  end
+
+  describe "sessions" do
+    test "temporary tables live for the session and are dropped after it" do
+      pool = start_pool(size: 1)
+
+      assert {:ok, [%{n: 3}]} =
+               Natch.Pool.session(pool, fn conn ->
+                 :ok = Natch.execute(conn, "CREATE TEMPORARY TABLE session_ids (id UInt64)")
+                 :ok = Natch.insert_cols(conn, "session_ids", %{id: [1, 2, 3]}, id: :uint64)
+                 Natch.select_rows(conn, "SELECT count() AS n FROM session_ids")
+               end)
+
+      # The only connection comes back reset
+      assert {:error, %{type: "server"}} =
+               Natch.Pool.select_rows(pool, "SELECT count() FROM session_ids")
+    end
+
+    test "checkout pins one connection until checkin" do
+      pool = start_pool(size: 2)
+
+      {:ok, session} = Natch.Pool.checkout(pool)
+      :ok = Natch.execute(session.conn, "SET max_block_size = 1234")
+
+      assert {:ok, [%{v: 1234}]} =
+               Natch.select_rows(session.conn, "SELECT getSetting('max_block_size') AS v")
+
+      assert %{sessions: 1, busy: 1} = Natch.Pool.metrics(pool)
+      :ok = Natch.Pool.checkin(session)
+      assert {:ok, _} = Natch.Pool.select_rows(pool, "SELECT 1 AS x")
+    end
+
+    test "sessions do not count against the in-flight limit" do
+      pool = start_pool(size: 3, adaptive: [initial: 1])
+      {:ok, first} = Natch.Pool.checkout(pool)
+      {:ok, second} = Natch.Pool.checkout(pool)
+
+      assert {:ok, [%{x: 1}]} =
+               Natch.Pool.select_rows(pool, "SELECT 1 AS x", [], queue_timeout: 1_000)
+
+      :ok = Natch.Pool.checkin(first)
+      :ok = Natch.Pool.checkin(second)
+    end
+
+    test "transfer hands a session to another process" do
+      pool = start_pool(size: 1)
+      {:ok, session} = Natch.Pool.checkout(pool)
+      test = self()
+
+      owner =
+        spawn(fn ->
+          receive do
+            {:session, session} ->
+              send(test, {:used, Natch.select_rows(session.conn, "SELECT 1 AS x")})
+          end
+        end)
+
+      {:ok, transferred} = Natch.Pool.transfer(session, owner)
+      send(owner, {:session, transferred})
+      assert_receive {:used, {:ok, [%{x: 1}]}}
+
+      # The new owner exits without checking in; the pool reclaims the connection
+      assert {:ok, [%{x: 2}]} = Natch.Pool.select_rows(pool, "SELECT 2 AS x")
+    end
+  end
+end
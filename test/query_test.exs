@@ -352,6 +352,397 @@ defmodule Natch.QueryTest do
     end
   end
 
+  describe "String interning" do
+    setup %{conn: conn, table: table} do
+      Natch.execute(conn, """
+      CREATE TABLE #{table} (id UInt64, path String, tags Array(String)) ENGINE = Memory
+      """)
+
+      paths = Enum.map(1..2000, fn id -> "/page/#{rem(id, 3)}" end)
+      tags = Enum.map(1..2000, fn id -> ["t#{rem(id, 2)}", "t#{rem(id, 5)}"] end)
+
+      :ok =
+        Natch.insert_cols(conn, table, %{id: Enum.to_list(1..2000), path: paths, tags: tags},
+          id: :uint64,
+          path: :string,
+          tags: {:array, :string}
+        )
+
+      {:ok, paths: paths, tags: tags}
+    end
+
+    test "interned results match plain decoding", %{conn: conn, table: table} = ctx do
+      sql = "SELECT path, tags FROM #{table} ORDER BY id"
+
+      assert {:ok, plain} = Natch.select_cols(conn, sql)
+      assert {:ok, interned} = Natch.select_cols(conn, sql, [], intern_strings: true)
+
+      assert interned == plain
+      assert interned.path == ctx.paths
+      assert interned.tags == ctx.tags
+    end
+
+    test "falls back when cardinality exceeds the threshold", %{conn: conn, table: table} do
+      sql = "SELECT toString(id) AS s FROM #{table} ORDER BY id"
+
+      assert {:ok, rows} = Natch.select_rows(conn, sql, [], intern_strings: true)
+      assert Enum.map(rows, & &1.s) == Enum.map(1..2000, &Integer.to_string/1)
+    end
+
+    test "rejects invalid options", %{conn: conn, table: table} do
+      assert_raise ArgumentError, fn ->
+        Natch.select_rows(conn, "SELECT * FROM #{table}", [], intern_strings: :yes)
+      end
+
+      assert_raise ArgumentError, fn ->
+        Natch.select_rows(conn, "SELECT * FROM #{table}", [], unknown: true)
+      end
+    end
+  end
+
+  describe "Decode stats" do
+    test "reports per-type decode costs for a query", %{conn: conn, table: table} do
+      Natch.execute(conn, """
+      CREATE TABLE #{table} (id UInt64, attrs Map(String, String)) ENGINE = Memory
+      """)
+
+      :ok =
+        Natch.insert_cols(
+          conn,
+          table,
+          %{id: [1, 2], attrs: [%{"a" => "x"}, %{"b" => "y", "c" => "z"}]},
+          id: :uint64,
+          attrs: {:map, :string, :string}
+        )
+
+      assert {:ok, cols, %{decode_stats: stats}} =
+               Natch.select_cols(conn, "SELECT * FROM #{table}", [], decode_stats: true)
+
+      assert cols.id |> Enum.sort() == [1, 2]
+      assert %{values: 2, binary_bytes: 0} = stats["UInt64"]
+      assert %{values: 2} = stats["Map"]
+      assert %{values: 6, binary_bytes: 6} = stats["String"]
+      assert stats["String"].nanoseconds >= 0
+
+      global = Natch.decode_stats()
+      assert global["Map"].values >= 2
+    end
+  end
+
+  describe "Client-side filtering" do
+    setup %{conn: conn, table: table} do
+      Natch.execute(conn, """
+      CREATE TABLE #{table} (
+        id UInt64,
+        score Int32,
+        name String,
+        note Nullable(String),
+        day Date
+      ) ENGINE = Memory
+      """)
+
+      :ok =
+        Natch.insert_cols(
+          conn,
+          table,
+          %{
+            id: [1, 2, 3, 4, 5],
+            score: [-5, 10, 20, 30, 40],
+            name: ["a", "b", "c", "d", "e"],
+            note: ["x", nil, "y", nil, "z"],
+            day: [~D[2024-01-01], ~D[2024-01-02], ~D[2024-01-03], ~D[2024-01-04], ~D[2024-01-05]]
+          },
+          id: :uint64,
+          score: :int32,
+          name: :string,
+          note: {:nullable, :string},
+          day: :date
+        )
+
+      :ok
+    end
+
+    test "keeps only rows matching every predicate", %{conn: conn, table: table} do
+      sql = "SELECT id, name, note FROM #{table} ORDER BY id"
+
+      filter = [{:id, :>, 1}, {:note, :not_nil}]
+      assert {:ok, rows} = Natch.select_rows(conn, sql, [], filter: filter)
+      assert rows == [%{id: 3, name: "c", note: "y"}, %{id: 5, name: "e", note: "z"}]
+
+      filter = [{:name, :in, ["b", "d", "q"]}]
+      assert {:ok, cols} = Natch.select_cols(conn, sql, [], filter: filter)
+      assert cols == %{id: [2, 4], name: ["b", "d"], note: [nil, nil]}
+    end
+
+    test "compares NULL, dates and out-of-range operands", %{conn: conn, table: table} do
+      # Filters apply to the result, so every filtered column is selected
+      sql = "SELECT id, score, note, day FROM #{table} ORDER BY id"
+      ids = fn filter ->
+        {:ok, cols} = Natch.select_cols(conn, sql, [], filter: filter)
+        cols.id
+      end
+
+      assert ids.([{:note, :is_nil}]) == [2, 4]
+      assert ids.([{:note, :!=, "x"}]) == [3, 5]
+      assert ids.([{:day, :>=, ~D[2024-01-04]}]) == [4, 5]
+      assert ids.([{:score, :<, 0}]) == [1]
+      assert ids.([{:score, :<, 10_000_000_000}]) == [1, 2, 3, 4, 5]
+      assert ids.([{:id, :not_in, [2, 3, -1]}, {:score, :>, 0.5}]) == [4, 5]
+      assert ids.([{:id, :==, 99}]) == []
+
+      # Integral floats up to UInt64's max compare exactly, not as out of range
+      big = fn filter ->
+        sql = "SELECT arrayJoin([1, 18100000000000000000, 18446744073709551615]) AS big"
+        {:ok, cols} = Natch.select_cols(conn, sql, [], filter: filter)
+        cols.big
+      end
+
+      assert big.([{:big, :==, 1.81e19}]) == [18_100_000_000_000_000_000]
+      assert big.([{:big, :>, 1.81e19}]) == [18_446_744_073_709_551_615]
+      assert big.([{:big, :<, 1.81e19}]) == [1]
+    end
+
+    test "scales DateTime operands to the column's unit", %{conn: conn, table: table} do
+      times = "#{table}_times"
+
+      :ok =
+        Natch.execute(conn, """
+        CREATE TABLE #{times} (id UInt64, at DateTime64(3, 'UTC'), sec DateTime('UTC'))
+        ENGINE = Memory
+        """)
+
+      :ok =
+        Natch.execute(conn, """
+        INSERT INTO #{times} SELECT number + 1,
+          toDateTime64(1704067200 + number / 2, 3, 'UTC'),
+          toDateTime(1704067200 + intDiv(number, 2), 'UTC')
+        FROM numbers(3)
+        """)
+
+      sql = "SELECT id, at, sec FROM #{times} ORDER BY id"
+      ids = fn filter ->
+        {:ok, cols} = Natch.select_cols(conn, sql, [], filter: filter)
+        cols.id
+      end
+
+      try do
+        assert ids.([{:at, :>=, ~U[2024-01-01 00:00:00.500Z]}]) == [2, 3]
+        assert ids.([{:at, :==, ~U[2024-01-01 00:00:00.500Z]}]) == [2]
+        assert ids.([{:at, :<, ~U[2024-01-01 00:00:00.000250Z]}]) == [1]
+        assert ids.([{:at, :==, ~N[2024-01-01 00:00:01]}]) == [3]
+        assert ids.([{:sec, :>, ~U[2024-01-01 00:00:00.5Z]}]) == [3]
+        assert ids.([{:sec, :in, [~U[2024-01-01 00:00:00Z]]}]) == [1, 2]
+      after
+        Natch.execute(conn, "DROP TABLE IF EXISTS #{times}")
+      end
+    end
+
+    test "decodes only the selected rows of nested types", %{conn: conn} do
+      sql = """
+      SELECT number AS id, [number, number * 2] AS a, (number, toString(number)) AS t,
+             map(toString(number), number) AS m, toLowCardinality(toString(number % 3)) AS lc,
+             toString(number % 2) AS s
+      FROM system.numbers LIMIT 10000
+      """
+
+      for intern <- [false, true] do
+        opts = [filter: [{:id, :>=, 9_998}], intern_strings: intern, decode_stats: true]
+        assert {:ok, rows, %{decode_stats: stats}} = Natch.select_rows(conn, sql, [], opts)
+
+        assert Enum.map(rows, & &1.id) == [9998, 9999]
+
+        for %{id: id} = row <- rows do
+          key = Integer.to_string(id)
+          assert %{t: {^id, ^key}, m: %{^key => ^id}} = row
+          assert row.a == [id, id * 2]
+          assert row.lc == Integer.to_string(rem(id, 3))
+          assert row.s == Integer.to_string(rem(id, 2))
+        end
+
+        for type <- ["Array", "Tuple", "Map", "LowCardinality"] do
+          assert %{values: 2} = stats[type]
+        end
+
+        # s, the tuple's strings and the map keys
+        assert %{values: 6} = stats["String"]
+      end
+    end
+
+    test "rejects invalid predicates", %{conn: conn, table: table} do
+      assert_raise ArgumentError, fn ->
+        Natch.select_rows(conn, "SELECT * FROM #{table}", [], filter: [{:id, :like, 1}])
+      end
+
+      assert_raise ArgumentError, fn ->
+        Natch.select_rows(conn, "SELECT * FROM #{table}", [], filter: [{:note, :==, nil}])
+      end
+    end
+  end
+
+  describe "Sampling" do
+    @numbers "SELECT number AS n FROM system.numbers LIMIT 100000"
+
+    test "every nth row across blocks", %{conn: conn} do
+      assert {:ok, cols} = Natch.select_cols(conn, @numbers, [], sample: {:every, 1000})
+      assert cols.n == Enum.to_list(0..99_999//1000)
+
+      assert {:ok, rows} = Natch.select_rows(conn, @numbers, [], sample: {:every, 25_000})
+      assert rows == [%{n: 0}, %{n: 25_000}, %{n: 50_000}, %{n: 75_000}]
+    end
+
+    test "reservoir keeps k distinct rows in result order", %{conn: conn} do
+      assert {:ok, cols} = Natch.select_cols(conn, @numbers, [], sample: {:reservoir, 500})
+      assert length(cols.n) == 500
+      assert cols.n == Enum.sort(cols.n)
+      assert cols.n == Enum.uniq(cols.n)
+      # A uniform sample reaches well into the result
+      assert List.last(cols.n) > 50_000
+
+      assert {:ok, rows} = Natch.select_rows(conn, @numbers, [], sample: {:reservoir, 10, 7})
+      assert {:ok, ^rows} = Natch.select_rows(conn, @numbers, [], sample: {:reservoir, 10, 7})
+    end
+
+    test "reservoir keeps each sampled row's columns together", %{conn: conn} do
+      # String is copied by value, Array(UInt64) through a slice; a small k
+      # over many rows replaces slots often enough to compact the columns
+      sql = """
+      SELECT number AS n, toString(number) AS s, [number, number + 1] AS a
+      FROM system.numbers LIMIT 100000
+      """
+
+      assert {:ok, rows} = Natch.select_rows(conn, sql, [], sample: {:reservoir, 5, 3})
+      assert length(rows) == 5
+
+      for %{n: n, s: s, a: a} <- rows do
+        assert s == Integer.to_string(n)
+        assert a == [n, n + 1]
+      end
+    end
+
+    test "every nth row decodes only the sampled LowCardinality and Array rows", %{conn: conn} do
+      sql = """
+      SELECT number AS n, toLowCardinality(toString(number % 7)) AS lc, [number, number + 1] AS a
+      FROM system.numbers LIMIT 100000
+      """
+
+      opts = [sample: {:every, 1000}, decode_stats: true]
+      assert {:ok, cols, %{decode_stats: stats}} = Natch.select_cols(conn, sql, [], opts)
+      assert cols.n == Enum.to_list(0..99_999//1000)
+      assert cols.lc == Enum.map(cols.n, &Integer.to_string(rem(&1, 7)))
+      assert cols.a == Enum.map(cols.n, &[&1, &1 + 1])
+
+      assert %{values: 100} = stats["LowCardinality"]
+      assert %{values: 100} = stats["Array"]
+    end
+
+    test "reservoir larger than the result returns every row", %{conn: conn} do
+      sql = "SELECT number AS n FROM system.numbers LIMIT 5"
+      assert {:ok, cols} = Natch.select_cols(conn, sql, [], sample: {:reservoir, 10})
+      assert cols.n == [0, 1, 2, 3, 4]
+    end
+
+    test "samples rows that pass the filter", %{conn: conn} do
+      opts = [filter: [{:n, :>=, 99_000}], sample: {:every, 100}]
+      assert {:ok, cols} = Natch.select_cols(conn, @numbers, [], opts)
+      assert cols.n == Enum.to_list(99_000..99_999//100)
+    end
+
+    test "rejects invalid samples", %{conn: conn} do
+      assert_raise ArgumentError, fn ->
+        Natch.select_rows(conn, @numbers, [], sample: {:every, 0})
+      end
+    end
+  end
+
+  describe "Native passthrough" do
+    test "select_native blocks insert back unchanged", %{conn: conn, table: table} do
+      :ok =
+        Natch.execute(conn, """
+        CREATE TABLE #{table} (id UInt64, name String, tags Array(String)) ENGINE = Memory
+        """)
+
+      sql = """
+      SELECT number AS id, toString(number) AS name, [toString(number % 3)] AS tags
+      FROM system.numbers LIMIT 100000
+      """
+
+      assert {:ok, blocks} = Natch.select_native(conn, sql)
+      assert length(blocks) > 1
+      assert Enum.all?(blocks, &is_binary/1)
+
+      :ok = Natch.insert_native(conn, table, blocks)
+
+      assert {:ok, expected} = Natch.select_cols(conn, sql)
+      assert {:ok, copied} = Natch.select_cols(conn, "SELECT * FROM #{table} ORDER BY id")
+      assert copied == expected
+
+      assert Natch.decode_native_cols(IO.iodata_to_binary(blocks)) == expected
+    end
+
+    test "parameterized select_native", %{conn: conn} do
+      query =
+        Natch.Query.new("SELECT number AS n FROM system.numbers WHERE number < {limit:UInt64}")
+        |> Natch.Query.bind(:limit, 3)
+
+      assert {:ok, blocks} = Natch.select_native(conn, query)
+      assert Natch.decode_native_rows(Enum.join(blocks)) == [%{n: 0}, %{n: 1}, %{n: 2}]
+    end
+
+    test "an empty result keeps its header", %{conn: conn, table: table} do
+      sql = "SELECT number AS n, toString(number) AS s FROM system.numbers LIMIT 0"
+
+      assert {:ok, [header]} = Natch.select_native(conn, sql)
+      assert Natch.decode_native_cols(header) == %{n: [], s: []}
+      assert Natch.decode_native_rows(header) == []
+
+      :ok = Natch.execute(conn, "CREATE TABLE #{table} (n UInt64, s String) ENGINE = Memory")
+      assert :ok = Natch.insert_native(conn, table, [header])
+    end
+
+    test "rejects malformed blocks", %{conn: conn, table: table} do
+      :ok = Natch.execute(conn, "CREATE TABLE #{table} (id UInt64) ENGINE = Memory")
+      assert {:error, _} = Natch.insert_native(conn, table, [<<1, 1, 2, "id", 6, "UInt64">>])
+      assert_raise ArgumentError, fn -> Natch.select_native(conn, "SELECT 1", filter: []) end
+    end
+  end
+
+  describe "Streaming inserts" do
+    test "inserts every chunk of a stream", %{conn: conn, table: table} do
+      Natch.execute(conn, "CREATE TABLE #{table} (id UInt64, name String) ENGINE = Memory")
+
+      schema = [id: :uint64, name: :string]
+
+      chunks =
+        1..2_500
+        |> Stream.chunk_every(1_000)
+        |> Stream.map(fn ids -> %{id: ids, name: Enum.map(ids, &"row_#{&1}")} end)
+
+      assert :ok = Natch.insert_stream(conn, table, chunks, schema)
+
+      {:ok, [row]} =
+        Natch.select_rows(conn, "SELECT count() AS n, sum(id) AS total FROM #{table}")
+
+      assert row.n == 2_500
+      assert row.total == Enum.sum(1..2_500)
+    end
+
+    test "stops at the first invalid chunk", %{conn: conn, table: table} do
+      Natch.execute(conn, "CREATE TABLE #{table} (id UInt64) ENGINE = Memory")
+
+      chunks = [%{id: [1, 2]}, %{id: [-1]}, %{id: [3]}]
+
+      assert {:error, _} = Natch.insert_stream(conn, table, chunks, id: :uint64)
+
+      {:ok, rows} = Natch.select_rows(conn, "SELECT id FROM #{table} ORDER BY id")
+      assert Enum.map(rows, & &1.id) == [1, 2]
+    end
+
+    test "returns :ok for an empty stream", %{conn: conn, table: table} do
+      Natch.execute(conn, "CREATE TABLE #{table} (id UInt64) ENGINE = Memory")
+      assert :ok = Natch.insert_stream(conn, table, [], id: :uint64)
+    end
+  end
+
   describe "New column types integration" do
     test "can insert and query Bool values", %{conn: conn, table: table} do
       Natch.execute(conn, """
@@ -610,6 +1001,43 @@ defmodule Natch.QueryTest do
       assert result |> Enum.at(2) |> Map.get(:timestamp) == DateTime.to_unix(dt3, :microsecond)
     end
 
+    test "can insert NaiveDateTime and Date values", %{conn: conn, table: table} do
+      Natch.execute(conn, """
+      CREATE TABLE #{table} (
+        id UInt64,
+        created DateTime,
+        timestamp DateTime64(6),
+        day Date
+      ) ENGINE = Memory
+      """)
+
+      schema = [id: :uint64, created: :datetime, timestamp: :datetime64, day: :date]
+
+      columns = %{
+        id: [1, 2],
+        created: [~N[2024-03-01 12:00:00], ~N[1999-12-31 23:59:59]],
+        timestamp: [~N[2024-03-01 12:00:00.000001], ~N[2000-02-29 00:00:00.5]],
+        day: [~D[2024-03-01], ~D[2000-02-29]]
+      }
+
+      assert :ok = Natch.insert_cols(conn, table, columns, schema)
+
+      {:ok, result} =
+        Natch.select_rows(
+          conn,
+          "SELECT id, toUnixTimestamp(created) AS created, timestamp, toString(day) AS day FROM #{table} ORDER BY id"
+        )
+
+      [row1, row2] = result
+
+      assert row1.created == DateTime.to_unix(~U[2024-03-01 12:00:00Z])
+      assert row2.created == DateTime.to_unix(~U[1999-12-31 23:59:59Z])
+      assert row1.timestamp == DateTime.to_unix(~U[2024-03-01 12:00:00.000001Z], :microsecond)
+      assert row2.timestamp == DateTime.to_unix(~U[2000-02-29 00:00:00.5Z], :microsecond)
+      assert row1.day == "2024-03-01"
+      assert row2.day == "2000-02-29"
+    end
+
     test "can insert and query Decimal values", %{conn: conn, table: table} do
       Natch.execute(conn, """
       CREATE TABLE #{table} (
@@ -0,0 +1,151 @@
+defmodule Natch.SpoolTest do
+  use ExUnit.Case, async: true
+
+  alias Natch.Spool
+
+  @moduletag :tmp_dir
+
+  setup %{tmp_dir: tmp_dir} do
+    table = "test_#{System.unique_integer([:positive, :monotonic])}_#{:rand.uniform(999_999)}"
+
+    {:ok, conn} = Natch.start_link(host: "localhost", port: 9000)
+    :ok = Natch.execute(conn, "CREATE TABLE #{table} (id UInt64, name String) ENGINE = Memory")
+
+    on_exit(fn ->
+      if Process.alive?(conn) do
+        try do
+          Natch.execute(conn, "DROP TABLE IF EXISTS #{table}")
+        catch
+          :exit, _ -> :ok
+        end
+
+        Process.exit(conn, :normal)
+      end
+    end)
+
+    {:ok, conn: conn, table: table, path: Path.join(tmp_dir, "insert.spool")}
+  end
+
+  @schema [id: :uint64, name: :string]
+
+  test "drains inserted blocks to ClickHouse", %{conn: conn, table: table, path: path} do
+    {:ok, spool} = Spool.open(path, host: "localhost", port: 9000)
+
+    :ok = Spool.insert(spool, table, %{id: [1, 2], name: ["a", "b"]}, @schema)
+    :ok = Spool.insert(spool, table, %{id: [3], name: ["c"]}, @schema)
+    assert :ok = Spool.flush(spool)
+
+    assert {:ok, rows} = Natch.select_rows(conn, "SELECT id, name FROM #{table} ORDER BY id")
+    assert rows == [%{id: 1, name: "a"}, %{id: 2, name: "b"}, %{id: 3, name: "c"}]
+
+    stats = Spool.stats(spool)
+    assert stats.appended_records == 2
+    assert stats.drained_records == 2
+    assert stats.drained_batches in [1, 2]
+    assert stats.pending_bytes == 0
+    Spool.close(spool)
+  end
+
+  test "keeps blocks while the server is down and replays them on reopen",
+       %{conn: conn, table: table, path: path} do
+    {:ok, listen} = :gen_tcp.listen(0, [])
+    {:ok, down_port} = :inet.port(listen)
+    :gen_tcp.close(listen)
+
+    {:ok, spool} = Spool.open(path, host: "127.0.0.1", port: down_port, connect_timeout: 100)
+    :ok = Spool.insert(spool, table, %{id: [7], name: ["kept"]}, @schema)
+    assert {:error, :timeout} = Spool.flush(spool, 300)
+    assert Spool.stats(spool).retries > 0
+    :ok = Spool.close(spool)
+
+    {:ok, spool} = Spool.open(path, host: "localhost", port: 9000)
+    assert Spool.stats(spool).recovered_records == 1
+    assert :ok = Spool.flush(spool)
+
+    assert {:ok, [%{id: 7, name: "kept"}]} = Natch.select_rows(conn, "SELECT * FROM #{table}")
+    Spool.close(spool)
+  end
+
+  test "returns :spool_full instead of growing", %{table: table, path: path} do
+    {:ok, spool} = Spool.open(path, host: "127.0.0.1", port: 1, capacity: 4096)
+    names = List.duplicate(String.duplicate("x", 100), 10)
+    columns = %{id: Enum.to_list(1..10), name: names}
+
+    results = for _ <- 1..10, do: Spool.insert(spool, table, columns, @schema)
+
+    assert :ok in results
+    assert {:error, :spool_full} in results
+    Spool.close(spool)
+  end
+
+  test "drops blocks the server rejects", %{path: path} do
+    {:ok, spool} = Spool.open(path, host: "localhost", port: 9000)
+    :ok = Spool.insert(spool, "no_such_table_for_spool", %{id: [1], name: ["a"]}, @schema)
+
+    assert :ok = Spool.flush(spool)
+    stats = Spool.stats(spool)
+    assert stats.rejected_records == 1
+    assert stats.last_error =~ "no_such_table_for_spool"
+    Spool.close(spool)
+  end
+
+  test "drops only the rejected block of a merged batch", %{conn: conn, path: path} do
+    table = "test_spool_check_#{System.unique_integer([:positive])}"
+
+    :ok =
+      Natch.execute(conn, """
+      CREATE TABLE #{table} (id UInt64, name String, CONSTRAINT small CHECK id < 100)
+      ENGINE = Memory
+      """)
+
+    on_exit(fn ->
+      {:ok, cleanup} = Natch.start_link(host: "localhost", port: 9000)
+      Natch.execute(cleanup, "DROP TABLE IF EXISTS #{table}")
+      GenServer.stop(cleanup)
+    end)
+
+    # A long linger merges the three blocks into one INSERT
+    {:ok, spool} = Spool.open(path, host: "localhost", port: 9000, linger: 500)
+    :ok = Spool.insert(spool, table, %{id: [1, 2], name: ["a", "b"]}, @schema)
+    :ok = Spool.insert(spool, table, %{id: [500], name: ["too big"]}, @schema)
+    :ok = Spool.insert(spool, table, %{id: [3], name: ["c"]}, @schema)
+    assert :ok = Spool.flush(spool)
+
+    assert {:ok, rows} = Natch.select_rows(conn, "SELECT id FROM #{table} ORDER BY id")
+    assert Enum.map(rows, & &1.id) == [1, 2, 3]
+
+    stats = Spool.stats(spool)
+    assert stats.rejected_records == 1
+    assert stats.drained_records == 2
+    Spool.close(spool)
+  end
+
+  test "a spool dropped without close releases the file", %{table: table, path: path} do
+    {:ok, listen} = :gen_tcp.listen(0, [])
+    {:ok, down_port} = :inet.port(listen)
+    :gen_tcp.close(listen)
+
+    task =
+      Task.async(fn ->
+        {:ok, spool} = Spool.open(path, host: "127.0.0.1", port: down_port, connect_timeout: 100)
+        :ok = Spool.insert(spool, table, %{id: [1], name: ["a"]}, @schema)
+      end)
+
+    # The task exits holding the only reference, so the spool is dropped
+    :ok = Task.await(task)
+
+    # The detached drain thread lets go of the file after its current attempt
+    assert Enum.any?(1..50, fn _ ->
+             try do
+               {:ok, spool} = Spool.open(path, host: "127.0.0.1", port: down_port)
+               assert Spool.stats(spool).recovered_records == 1
+               Spool.close(spool)
+               true
+             rescue
+               Natch.ValidationError ->
+                 Process.sleep(50)
+                 false
+             end
+           end)
+  end
+end